@@ -80,6 +80,20 @@ INCLUDE (CheckIncludeFileCXX)
 include(TestCXXAcceptsFlag)
 CHECK_INCLUDE_FILE_CXX("tr1/array" HAVE_TR1_ARRAY)
 CHECK_INCLUDE_FILE_CXX("malloc.h" HAVE_MALLOC_H)
+CHECK_INCLUDE_FILE_CXX("linux/perf_event.h" HAVE_PERF_EVENT)
+CHECK_INCLUDE_FILE_CXX("sys/mman.h" HAVE_SYS_MMAN_H)
+if(HAVE_SYS_MMAN_H)
+  # shm_open lives in librt before glibc 2.34
+  include(CheckLibraryExists)
+  CHECK_LIBRARY_EXISTS(rt shm_open "" HAVE_LIBRT)
+  if(HAVE_LIBRT)
+    dune_register_package_flags(LIBRARIES rt)
+  endif(HAVE_LIBRT)
+endif(HAVE_SYS_MMAN_H)
+CHECK_INCLUDE_FILE_CXX("dlfcn.h" HAVE_DLFCN_H)
+if(HAVE_DLFCN_H)
+  dune_register_package_flags(LIBRARIES ${CMAKE_DL_LIBS})
+endif(HAVE_DLFCN_H)
 
 
 CHECK_CXX_SOURCE_COMPILES("
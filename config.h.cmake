@@ -45,6 +45,18 @@
 
 #cmakedefine HAVE_MAP_EMPLACE 1
 
+/* Define to 1 if linux/perf_event.h was found, used in dune/stuff/common/perf_counters.cc */
+#cmakedefine HAVE_PERF_EVENT 1
+
+/* Define to 1 if sys/mman.h was found, used in dune/stuff/common/{mapped_binary_cache,shared_memory}.cc */
+#cmakedefine HAVE_SYS_MMAN_H 1
+
+/* Define to 1 if dlfcn.h was found, used in dune/stuff/functions/expression/bytecode.cc */
+#cmakedefine HAVE_DLFCN_H 1
+
+/* the default compiler of Functions::ExpressionBytecode::compile_native() */
+#define DUNE_STUFF_EXPRESSION_JIT_CXX "${CMAKE_CXX_COMPILER}"
+
 #define DS_MAX_MIC_THREADS ${DS_MAX_MIC_THREADS}
 
 #define DS_OVERRIDE ; static_assert(false, "Use override instead (21.10.2014)!");
@@ -0,0 +1,236 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#include "config.h"
+
+#include "mapped_binary_cache.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#if HAVE_SYS_MMAN_H
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <boost/filesystem.hpp>
+
+#include <dune/common/exceptions.hh>
+
+namespace Dune {
+namespace Stuff {
+namespace Common {
+namespace {
+
+const char cache_magic[8] = {'D', 'S', 'B', 'I', 'N', '0', '0', '1'};
+
+//! the values follow right after the header, which keeps them aligned
+struct CacheHeader
+{
+  char magic[8];
+  std::uint64_t value_size;
+  std::uint64_t size;
+  //! size and modification time of the ASCII file the cache was created from
+  std::uint64_t source_size;
+  std::int64_t source_time;
+  char padding[24];
+};
+
+static_assert(sizeof(CacheHeader) == 64, "");
+
+size_t value_size(const MappedBinaryCache::Precision precision)
+{
+  return (precision == MappedBinaryCache::Precision::float32) ? sizeof(float) : sizeof(double);
+}
+
+CacheHeader source_header(const std::string& filename, const MappedBinaryCache::Precision precision)
+{
+  CacheHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, cache_magic, sizeof(cache_magic));
+  header.value_size = value_size(precision);
+  boost::system::error_code error;
+  header.source_size = boost::filesystem::file_size(filename, error);
+  if (error)
+    header.source_size = 0;
+  header.source_time = boost::filesystem::last_write_time(filename, error);
+  if (error)
+    header.source_time = 0;
+  return header;
+} // ... source_header(...)
+
+//! if the ASCII file is gone (source.source_size == 0), any cache of the right precision is valid
+bool valid(const CacheHeader& header, const CacheHeader& source, const std::uintmax_t file_size)
+{
+  return std::memcmp(header.magic, cache_magic, sizeof(cache_magic)) == 0 && header.value_size == source.value_size
+         && file_size == sizeof(CacheHeader) + header.size * header.value_size
+         && (source.source_size == 0
+             || (header.source_size == source.source_size && header.source_time == source.source_time));
+}
+
+bool valid_cache(const std::string& cache, const CacheHeader& source)
+{
+  boost::system::error_code error;
+  const auto file_size = boost::filesystem::file_size(cache, error);
+  if (error)
+    return false;
+  std::ifstream file(cache, std::ios::binary);
+  CacheHeader header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    return false;
+  return valid(header, source, file_size);
+}
+
+//! strtod on the whole file is much faster than operator>>
+template <class T>
+std::vector<T> parse(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  if (!file)
+    DUNE_THROW(IOError, "could not open '" << filename << "'!");
+  const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  std::vector<T> values;
+  const char* position = content.c_str();
+  char* end            = nullptr;
+  for (double value = std::strtod(position, &end); end != position; value = std::strtod(position, &end)) {
+    values.push_back(T(value));
+    position = end;
+  }
+  return values;
+} // ... parse(...)
+
+template <class T>
+bool write(const std::vector<T>& values, CacheHeader header, const std::string& cache)
+{
+  header.size = values.size();
+  // several processes might convert at once, so only the final rename may touch cache
+  boost::system::error_code error;
+  const auto tmp = boost::filesystem::unique_path(cache + ".%%%%-%%%%-%%%%");
+  {
+    std::ofstream file(tmp.string(), std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    if (!file) {
+      file.close();
+      boost::filesystem::remove(tmp, error);
+      return false;
+    }
+  }
+  boost::filesystem::rename(tmp, cache, error);
+  if (error) {
+    boost::filesystem::remove(tmp, error);
+    return false;
+  }
+  return true;
+} // ... write(...)
+
+} // namespace
+
+MappedBinaryCache::MappedBinaryCache(const std::string& filename, const Precision precision)
+  : precision_(precision)
+  , size_(0)
+  , values_(nullptr)
+  , mapping_(nullptr)
+  , mapping_size_(0)
+{
+  if (convert(filename, precision_) && map(cache_filename(filename, precision_)))
+    return;
+  // no cache, keep the values in memory
+  if (precision_ == Precision::float32) {
+    float_buffer_ = parse<float>(filename);
+    size_         = float_buffer_.size();
+    values_       = float_buffer_.data();
+  } else {
+    double_buffer_ = parse<double>(filename);
+    size_          = double_buffer_.size();
+    values_        = double_buffer_.data();
+  }
+} // MappedBinaryCache(...)
+
+MappedBinaryCache::~MappedBinaryCache()
+{
+#if HAVE_SYS_MMAN_H
+  if (mapping_)
+    ::munmap(mapping_, mapping_size_);
+#endif
+}
+
+bool MappedBinaryCache::convert(const std::string& filename, const Precision precision)
+{
+  const std::string cache  = cache_filename(filename, precision);
+  const CacheHeader source = source_header(filename, precision);
+  if (valid_cache(cache, source))
+    return true;
+  if (source.source_size == 0)
+    return false;
+  if (precision == Precision::float32)
+    return write(parse<float>(filename), source, cache);
+  else
+    return write(parse<double>(filename), source, cache);
+} // ... convert(...)
+
+std::string MappedBinaryCache::cache_filename(const std::string& filename, const Precision precision)
+{
+  return filename + ((precision == Precision::float32) ? ".f32.bin" : ".f64.bin");
+}
+
+bool MappedBinaryCache::map(const std::string& cache)
+{
+#if HAVE_SYS_MMAN_H
+  const int fd = ::open(cache.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat status;
+  void* mapping = MAP_FAILED;
+  if (::fstat(fd, &status) == 0 && size_t(status.st_size) >= sizeof(CacheHeader))
+    mapping = ::mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED)
+    return false;
+  // check again, the cache might have been replaced in between
+  CacheHeader source;
+  std::memcpy(source.magic, cache_magic, sizeof(cache_magic));
+  source.value_size  = value_size(precision_);
+  source.source_size = 0;
+  const auto& header = *static_cast<const CacheHeader*>(mapping);
+  if (!valid(header, source, status.st_size)) {
+    ::munmap(mapping, status.st_size);
+    return false;
+  }
+  mapping_      = mapping;
+  mapping_size_ = status.st_size;
+  size_         = header.size;
+  values_       = static_cast<const char*>(mapping) + sizeof(CacheHeader);
+  return true;
+#else // HAVE_SYS_MMAN_H
+  // at least skip the parsing
+  std::ifstream file(cache, std::ios::binary);
+  CacheHeader header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    return false;
+  if (precision_ == Precision::float32) {
+    float_buffer_.resize(header.size);
+    file.read(reinterpret_cast<char*>(float_buffer_.data()), header.size * sizeof(float));
+    values_ = float_buffer_.data();
+  } else {
+    double_buffer_.resize(header.size);
+    file.read(reinterpret_cast<char*>(double_buffer_.data()), header.size * sizeof(double));
+    values_ = double_buffer_.data();
+  }
+  size_ = header.size;
+  return bool(file);
+#endif // HAVE_SYS_MMAN_H
+} // ... map(...)
+
+} // namespace Common
+} // namespace Stuff
+} // namespace Dune
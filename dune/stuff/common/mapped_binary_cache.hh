@@ -0,0 +1,90 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#ifndef DUNE_STUFF_COMMON_MAPPED_BINARY_CACHE_HH
+#define DUNE_STUFF_COMMON_MAPPED_BINARY_CACHE_HH
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace Dune {
+namespace Stuff {
+namespace Common {
+
+/** \brief read-only access to the numbers of a (large) ASCII data file, through a binary cache file beside it
+ *
+ *  The first use converts the whitespace separated numbers of the ASCII file into cache_filename(), later uses only
+ *  map that file into memory (via mmap, if HAVE_SYS_MMAN_H), so nothing is parsed again and the pages are shared by all
+ *  processes and threads reading the same data. The cache is rebuilt if the size or modification time of the ASCII
+ *  file changes and used on its own if the ASCII file is gone. If the cache cannot be written, the data is parsed into
+ *  memory instead.
+ **/
+class MappedBinaryCache : public boost::noncopyable
+{
+public:
+  enum class Precision
+  {
+    float32,
+    float64
+  };
+
+  //! \throws Dune::IOError if neither the ASCII file nor its cache can be read
+  explicit MappedBinaryCache(const std::string& filename, const Precision precision = Precision::float64);
+
+  ~MappedBinaryCache();
+
+  //! writes the cache of filename, if it is missing or outdated, \return whether a valid cache exists afterwards
+  static bool convert(const std::string& filename, const Precision precision = Precision::float64);
+
+  //! filename + ".f32.bin" or filename + ".f64.bin"
+  static std::string cache_filename(const std::string& filename, const Precision precision);
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  Precision precision() const
+  {
+    return precision_;
+  }
+
+  //! whether the values are memory-mapped, as opposed to held in memory
+  bool mapped() const
+  {
+    return mapping_ != nullptr;
+  }
+
+  double operator[](const size_t ii) const
+  {
+    assert(ii < size_);
+    return (precision_ == Precision::float32) ? static_cast<const float*>(values_)[ii]
+                                              : static_cast<const double*>(values_)[ii];
+  }
+
+private:
+  bool map(const std::string& cache);
+
+  const Precision precision_;
+  size_t size_;
+  //! points into mapping_ or buffer_
+  const void* values_;
+  void* mapping_;
+  size_t mapping_size_;
+  std::vector<float> float_buffer_;
+  std::vector<double> double_buffer_;
+}; // class MappedBinaryCache
+
+} // namespace Common
+} // namespace Stuff
+} // namespace Dune
+
+#endif // DUNE_STUFF_COMMON_MAPPED_BINARY_CACHE_HH
@@ -103,6 +103,14 @@ public:
     return accumulate(ValueType(0), std::plus<ValueType>());
   }
 
+  //! calls functor on the value of each thread, must not be called concurrently to any other access
+  template <class FunctorType>
+  void for_each(FunctorType functor)
+  {
+    for (auto& value : values_)
+      functor(*value);
+  }
+
 private:
   ContainerType values_;
 };
@@ -184,6 +192,14 @@ public:
     return accumulate(ValueType(), std::plus<ValueType>());
   }
 
+  //! calls functor on the value of each thread which accessed it, must not be called concurrently to any other access
+  template <class FunctorType>
+  void for_each(FunctorType functor)
+  {
+    for (auto& value : *values_)
+      functor(*value);
+  }
+
 private:
   mutable std::unique_ptr<ContainerType> values_;
 };
@@ -0,0 +1,134 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#include "config.h"
+
+#include "perf_counters.hh"
+
+#if HAVE_PERF_EVENT
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include <dune/common/exceptions.hh>
+
+namespace Dune {
+namespace Stuff {
+namespace Common {
+
+#if HAVE_PERF_EVENT
+namespace {
+
+int open_event(const uint64_t config, const int group_fd)
+{
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size           = sizeof(attr);
+  attr.type           = PERF_TYPE_HARDWARE;
+  attr.config         = config;
+  attr.read_format    = PERF_FORMAT_GROUP;
+  attr.disabled       = (group_fd == -1);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+  // pid 0 and cpu -1: the calling thread, on any cpu
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+} // namespace
+
+PerfCounters::PerfCounters()
+{
+  const std::array<uint64_t, num_events> configs = {{PERF_COUNT_HW_CPU_CYCLES,
+                                                     PERF_COUNT_HW_INSTRUCTIONS,
+                                                     PERF_COUNT_HW_CACHE_MISSES,
+                                                     PERF_COUNT_HW_BRANCH_MISSES}};
+  fds_.fill(-1);
+  fds_[cycles] = open_event(configs[cycles], -1);
+  if (fds_[cycles] < 0)
+    return;
+  for (size_t event = 1; event < num_events; ++event)
+    fds_[event] = open_event(configs[event], fds_[cycles]);
+  ioctl(fds_[cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(fds_[cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounters::~PerfCounters()
+{
+  for (auto fd : fds_)
+    if (fd >= 0)
+      close(fd);
+}
+
+bool PerfCounters::available() const
+{
+  return fds_[cycles] >= 0;
+}
+
+PerfCounters::ValueType PerfCounters::read() const
+{
+  ValueType ret;
+  ret.fill(0);
+  if (!available())
+    return ret;
+  // PERF_FORMAT_GROUP: number of events, followed by their values in the order they were opened
+  std::array<uint64_t, num_events + 1> buffer;
+  const auto bytes = ::read(fds_[cycles], buffer.data(), sizeof(buffer));
+  if (bytes < ssize_t(sizeof(uint64_t)))
+    return ret;
+  size_t value = 1;
+  for (size_t event = 0; event < num_events && value <= buffer[0]; ++event)
+    if (fds_[event] >= 0)
+      ret[event] = buffer[value++];
+  return ret;
+} // ... read(...)
+
+#else // HAVE_PERF_EVENT
+
+PerfCounters::PerfCounters()
+{
+  fds_.fill(-1);
+}
+
+PerfCounters::~PerfCounters()
+{
+}
+
+bool PerfCounters::available() const
+{
+  return false;
+}
+
+PerfCounters::ValueType PerfCounters::read() const
+{
+  ValueType ret;
+  ret.fill(0);
+  return ret;
+}
+
+#endif // HAVE_PERF_EVENT
+
+std::string PerfCounters::name(const size_t event)
+{
+  switch (event) {
+    case cycles:
+      return "cycles";
+    case instructions:
+      return "instructions";
+    case llc_misses:
+      return "llc_misses";
+    case branch_misses:
+      return "branch_misses";
+  }
+  DUNE_THROW(Dune::RangeError, "there is no event " << event);
+} // ... name(...)
+
+} // namespace Common
+} // namespace Stuff
+} // namespace Dune
@@ -0,0 +1,61 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#ifndef DUNE_STUFF_COMMON_PERF_COUNTERS_HH
+#define DUNE_STUFF_COMMON_PERF_COUNTERS_HH
+
+#include <array>
+#include <string>
+#include <cstdint>
+
+#include <boost/noncopyable.hpp>
+
+namespace Dune {
+namespace Stuff {
+namespace Common {
+
+/** \brief hardware performance counters of the calling thread, via Linux' perf_event_open
+ *
+ *  All counters are opened as one group, so read() is a single syscall. Events the cpu (or the kernel's
+ *  perf_event_paranoid setting) does not allow simply stay 0, if not even cycles can be counted available() is false.
+ *  Without HAVE_PERF_EVENT nothing is ever available.
+ *  \note the counters only count the thread that constructed the object
+ **/
+class PerfCounters : public boost::noncopyable
+{
+public:
+  enum Event
+  {
+    cycles,
+    instructions,
+    llc_misses,
+    branch_misses,
+    num_events
+  };
+
+  typedef std::array<uint64_t, num_events> ValueType;
+
+  PerfCounters();
+  ~PerfCounters();
+
+  bool available() const;
+
+  //! counts since construction, all zero if not available()
+  ValueType read() const;
+
+  static std::string name(const size_t event);
+
+private:
+  //! file descriptors, -1 if the event could not be opened, the first one is the group leader
+  std::array<int, num_events> fds_;
+}; // class PerfCounters
+
+} // namespace Common
+} // namespace Stuff
+} // namespace Dune
+
+#endif // DUNE_STUFF_COMMON_PERF_COUNTERS_HH
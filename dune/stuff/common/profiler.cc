@@ -38,6 +38,7 @@
 #include <dune/stuff/common/filesystem.hh>
 #include <dune/stuff/common/parallel/threadmanager.hh>
 
+#include <algorithm>
 #include <map>
 #include <string>
 
@@ -69,14 +70,210 @@ void TimingData::stop()
   timer_->stop();
 }
 
-TimingData::DeltaType TimingData::delta() const
+namespace {
+
+TimingData::DeltaType to_delta(const boost::timer::cpu_times& elapsed)
 {
-  const auto scale   = 1.0 / double(boost::timer::nanosecond_type(1e6));
-  const auto elapsed = timer_->elapsed();
+  const auto scale = 1.0 / double(boost::timer::nanosecond_type(1e6));
   const auto cast = [=](double var) { return static_cast<typename TimingData::DeltaType::value_type>(var); };
   return {{cast(elapsed.wall * scale), cast(elapsed.user * scale), cast(elapsed.system * scale)}};
 }
 
+std::string json_escaped(const std::string& str)
+{
+  std::string ret;
+  for (const char c : str) {
+    if (c == '"' || c == '\\')
+      ret += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20)
+      ret += c;
+  }
+  return ret;
+}
+
+void add_to(TimingData::DeltaType& target, const TimingData::DeltaType& delta)
+{
+  for (auto i : valueRange(delta.size()))
+    target[i] += delta[i];
+}
+
+TimingData::DeltaType difference(const TimingData::DeltaType& lhs, const TimingData::DeltaType& rhs)
+{
+  TimingData::DeltaType ret(lhs);
+  for (auto i : valueRange(ret.size()))
+    ret[i] -= rhs[i];
+  return ret;
+}
+
+bool any(const PerfCounters::ValueType& counters)
+{
+  return std::any_of(counters.begin(), counters.end(), [](uint64_t count) { return count > 0; });
+}
+
+void add_to(PerfCounters::ValueType& target, const PerfCounters::ValueType& counters)
+{
+  for (auto i : valueRange(counters.size()))
+    target[i] += counters[i];
+}
+
+} // namespace
+
+TimingData::DeltaType TimingData::delta() const
+{
+  return to_delta(timer_->elapsed());
+}
+
+Profiler::ThreadSlot::ThreadSlot()
+  : name(nullptr)
+  , touched(false)
+  , running(false)
+  , elapsed({{0, 0, 0}})
+  , folded({{0, 0, 0}})
+  , trace_begin(0)
+  , counting(false)
+{
+  counters_begin.fill(0);
+  counters.fill(0);
+}
+
+Profiler::ThreadData::ThreadData()
+  : trace_count(0)
+  , registered(false)
+{
+}
+
+size_t Profiler::sectionId(const std::string& section_name)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = section_ids_.find(section_name);
+  if (it != section_ids_.end())
+    return it->second;
+  section_names_.push_back(section_name);
+  return section_ids_[section_name] = section_names_.size() - 1;
+}
+
+Profiler::ThreadSlot& Profiler::slot(ThreadData& thread_data, const size_t section_id)
+{
+  ThreadSlots& slots = thread_data.slots;
+  if (section_id >= slots.size()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (section_id >= section_names_.size())
+      DUNE_THROW(Dune::RangeError, "unknown section id " << section_id << "\n");
+    if (!thread_data.registered) {
+      all_thread_data_.push_back(&thread_data);
+      thread_data.registered = true;
+    }
+    const auto old_size = slots.size();
+    slots.resize(section_names_.size());
+    for (auto ii : valueRange(old_size, slots.size()))
+      slots[ii].name = &section_names_[ii];
+  }
+  return slots[section_id];
+} // ... slot(...)
+
+TimingData::DeltaType Profiler::stop(ThreadData& thread_data, ThreadSlot& thread_slot, const size_t section_id)
+{
+  thread_slot.timer.stop();
+  if (thread_slot.counting) {
+    const auto counters = thread_data.perf_counters->read();
+    for (auto i : valueRange(counters.size()))
+      thread_slot.counters[i] += counters[i] - thread_slot.counters_begin[i];
+    thread_slot.counting = false;
+  }
+  DSC_LIKWID_END_SECTION((*thread_slot.name))
+  thread_slot.running = false;
+  const auto delta = to_delta(thread_slot.timer.elapsed());
+  add_to(thread_slot.elapsed, difference(delta, thread_slot.folded));
+  const auto capacity = trace_capacity_.load(std::memory_order_relaxed);
+  if (capacity > 0) {
+    if (thread_data.trace.size() != capacity) {
+      thread_data.trace.resize(capacity);
+      thread_data.trace_count = 0;
+    }
+    thread_data.trace[thread_data.trace_count++ % capacity] = {section_id, thread_slot.trace_begin, traceTime()};
+  }
+  return delta;
+} // ... stop(...)
+
+TimingData::TimeType Profiler::traceTime() const
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace_epoch_).count();
+}
+
+std::vector<Profiler::TraceEvent> Profiler::traceEvents(const ThreadData& thread_data) const
+{
+  const auto& trace = thread_data.trace;
+  if (trace.empty() || thread_data.trace_count <= trace.size())
+    return std::vector<TraceEvent>(trace.begin(), trace.begin() + std::min(thread_data.trace_count, trace.size()));
+  // the ring buffer wrapped around, the oldest event is the next one to be overwritten
+  const auto oldest = trace.begin() + thread_data.trace_count % trace.size();
+  std::vector<TraceEvent> ret(oldest, trace.end());
+  ret.insert(ret.end(), trace.begin(), oldest);
+  return ret;
+} // ... traceEvents(...)
+
+void Profiler::fold()
+{
+  if (current_run_number_ >= datamaps_.size())
+    datamaps_.resize(current_run_number_ + 1);
+  if (current_run_number_ >= countermaps_.size())
+    countermaps_.resize(current_run_number_ + 1);
+  Datamap& current_data        = datamaps_[current_run_number_];
+  Countermap& current_counters = countermaps_[current_run_number_];
+  for (auto&& thread_data : all_thread_data_) {
+    for (auto&& thread_slot : thread_data->slots) {
+      if (any(thread_slot.counters)) {
+        add_to(current_counters[*thread_slot.name], thread_slot.counters);
+        thread_slot.counters.fill(0);
+      }
+      if (!thread_slot.touched)
+        continue;
+      auto& section = current_data.emplace(*thread_slot.name, TimingData::DeltaType{{0, 0, 0}}).first->second;
+      add_to(section, thread_slot.elapsed);
+      thread_slot.elapsed = {{0, 0, 0}};
+      if (thread_slot.running) {
+        const auto current = to_delta(thread_slot.timer.elapsed());
+        add_to(section, difference(current, thread_slot.folded));
+        thread_slot.folded = current;
+      }
+      thread_slot.touched = thread_slot.running;
+    }
+  }
+} // ... fold(...)
+
+Profiler::DatamapVector Profiler::mergedDatamaps() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  DatamapVector ret(datamaps_);
+  if (current_run_number_ >= ret.size())
+    ret.resize(current_run_number_ + 1);
+  Datamap& current_data = ret[current_run_number_];
+  for (auto&& thread_data : all_thread_data_) {
+    for (auto&& thread_slot : thread_data->slots) {
+      if (!thread_slot.touched)
+        continue;
+      auto& section = current_data.emplace(*thread_slot.name, TimingData::DeltaType{{0, 0, 0}}).first->second;
+      add_to(section, thread_slot.elapsed);
+      if (thread_slot.running)
+        add_to(section, difference(to_delta(thread_slot.timer.elapsed()), thread_slot.folded));
+    }
+  }
+  return ret;
+} // ... mergedDatamaps(...)
+
+Profiler::CountermapVector Profiler::mergedCountermaps() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  CountermapVector ret(countermaps_);
+  if (current_run_number_ >= ret.size())
+    ret.resize(current_run_number_ + 1);
+  for (auto&& thread_data : all_thread_data_)
+    for (auto&& thread_slot : thread_data->slots)
+      if (any(thread_slot.counters))
+        add_to(ret[current_run_number_][*thread_slot.name], thread_slot.counters);
+  return ret;
+} // ... mergedCountermaps(...)
+
 void Profiler::resetTiming(const std::string section_name)
 {
   try {
@@ -84,51 +281,73 @@ void Profiler::resetTiming(const std::string section_name)
   } catch (Dune::RangeError) {
     // ok, timer simply wasn't running
   }
+  std::lock_guard<std::mutex> lock(mutex_);
+  fold();
   Datamap& current_data      = datamaps_[current_run_number_];
   current_data[section_name] = {{0, 0, 0}};
 }
 
 void Profiler::startTiming(const std::string section_name)
 {
-  std::lock_guard<std::mutex> lock(mutex_);
-  if (current_run_number_ >= datamaps_.size()) {
-    datamaps_.push_back(Datamap());
-  }
-
-  const KnownTimersMap::iterator section = known_timers_map_.find(section_name);
-  if (section != known_timers_map_.end()) {
-    if (section->second.first) // timer currently running
-      return;
+  startTiming(sectionId(section_name));
+} // StartTiming
 
-    section->second.first  = true; // set active, start with new
-    section->second.second = TimingData(section_name);
-  } else {
-    // init new section
-    known_timers_map_[section_name] = std::make_pair(true, TimingData(section_name));
+void Profiler::startTiming(const size_t section_id)
+{
+  ThreadData& thread_data = *thread_data_;
+  ThreadSlot& thread_slot = slot(thread_data, section_id);
+  if (thread_slot.running) // timer currently running
+    return;
+  thread_slot.running = true;
+  thread_slot.touched = true;
+  thread_slot.folded  = {{0, 0, 0}};
+  if (trace_capacity_.load(std::memory_order_relaxed) > 0)
+    thread_slot.trace_begin = traceTime();
+  DSC_LIKWID_BEGIN_SECTION((*thread_slot.name))
+  if (count_events_.load(std::memory_order_relaxed)) {
+    if (!thread_data.perf_counters)
+      thread_data.perf_counters = std::make_shared<PerfCounters>();
+    thread_slot.counting = thread_data.perf_counters->available();
+    if (thread_slot.counting)
+      thread_slot.counters_begin = thread_data.perf_counters->read();
   }
-  DSC_LIKWID_BEGIN_SECTION(section_name)
+  thread_slot.timer.start();
 } // StartTiming
 
 long Profiler::stopTiming(const std::string section_name)
 {
-  DSC_LIKWID_END_SECTION(section_name)
-  assert(current_run_number_ < datamaps_.size());
-  if (known_timers_map_.find(section_name) == known_timers_map_.end())
-    DUNE_THROW(Dune::RangeError, "trying to stop timer " << section_name << " that wasn't started\n");
+  size_t section_id = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = section_ids_.find(section_name);
+    if (it == section_ids_.end())
+      DUNE_THROW(Dune::RangeError, "trying to stop timer " << section_name << " that wasn't started\n");
+    section_id = it->second;
+  }
+  return stopTiming(section_id);
+} // StopTiming
+
+long Profiler::stopTiming(const size_t section_id)
+{
+  ThreadData& thread_data = *thread_data_;
+  ThreadSlot& thread_slot = slot(thread_data, section_id);
+  if (!thread_slot.running) // not started in this thread
+    return 0;
+  return stop(thread_data, thread_slot, section_id)[0];
+} // StopTiming
 
-  known_timers_map_[section_name].first = false; // marks as not running
-  TimingData& timing = *(known_timers_map_[section_name].second);
-  timing.stop();
-  const auto delta      = timing.delta();
+void Profiler::addTiming(const std::string section_name, const TimingData::DeltaType& delta)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (current_run_number_ >= datamaps_.size()) {
+    datamaps_.push_back(Datamap());
+  }
   Datamap& current_data = datamaps_[current_run_number_];
   if (current_data.find(section_name) == current_data.end())
     current_data[section_name] = delta;
-  else {
-    for (auto i : valueRange(delta.size()))
-      current_data[section_name][i] += delta[i];
-  }
-  return delta[0];
-} // StopTiming
+  else
+    add_to(current_data[section_name], delta);
+} // AddTiming
 
 long Profiler::getTiming(const std::string section_name) const
 {
@@ -137,32 +356,71 @@ long Profiler::getTiming(const std::string section_name) const
 
 TimingData::DeltaType Profiler::get_delta(const std::string section_name) const
 {
-  assert(current_run_number_ < datamaps_.size());
   return getTimingIdx(section_name, current_run_number_);
 }
 
 TimingData::DeltaType Profiler::getTimingIdx(const std::string section_name, const size_t run_number) const
 {
-  assert(run_number < datamaps_.size());
-  const Datamap& data             = datamaps_[run_number];
-  Datamap::const_iterator section = data.find(section_name);
-  if (section == data.end()) {
-    // timer might still be running
-    const auto& timer_it = known_timers_map_.find(section_name);
-    if (timer_it == known_timers_map_.end())
-      DUNE_THROW(Dune::InvalidStateException, "no timer found: " + section_name);
-    return timer_it->second.second->delta();
+  const auto data                 = mergedDatamaps();
+  assert(run_number < data.size());
+  Datamap::const_iterator section = data[run_number].find(section_name);
+  if (section == data[run_number].end())
+    DUNE_THROW(Dune::InvalidStateException, "no timer found: " + section_name);
+  return section->second;
+}
+
+bool Profiler::setHardwareCounters(const bool enable)
+{
+  count_events_.store(enable);
+  if (!enable)
+    return false;
+  ThreadData& thread_data = *thread_data_;
+  if (!thread_data.perf_counters)
+    thread_data.perf_counters = std::make_shared<PerfCounters>();
+  return thread_data.perf_counters->available();
+} // ... setHardwareCounters(...)
+
+PerfCounters::ValueType Profiler::getCounters(const std::string section_name) const
+{
+  const auto counters = mergedCountermaps();
+  const auto section  = counters[current_run_number_].find(section_name);
+  if (section == counters[current_run_number_].end()) {
+    PerfCounters::ValueType zeros;
+    zeros.fill(0);
+    return zeros;
   }
   return section->second;
+} // ... getCounters(...)
+
+void Profiler::setDofs(const std::string section_name, const size_t dofs)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  section_dofs_[section_name] = dofs;
 }
 
+void Profiler::addItems(const std::string section_name, const size_t items)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (current_run_number_ >= itemmaps_.size())
+    itemmaps_.resize(current_run_number_ + 1);
+  itemmaps_[current_run_number_][section_name] += items;
+}
+
+size_t Profiler::getItems(const std::string section_name) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (current_run_number_ >= itemmaps_.size())
+    return 0;
+  const auto section = itemmaps_[current_run_number_].find(section_name);
+  return section == itemmaps_[current_run_number_].end() ? 0 : section->second;
+} // ... getItems(...)
+
 void Profiler::stopAll()
 {
-  for (auto&& section : known_timers_map_) {
-    try {
-      stopTiming(section.first);
-    } catch (Dune::RangeError) {
-    }
+  ThreadData& thread_data = *thread_data_;
+  for (auto section_id : valueRange(thread_data.slots.size())) {
+    if (thread_data.slots[section_id].running)
+      stop(thread_data, thread_data.slots[section_id], section_id);
   }
 } // GetTiming
 
@@ -170,8 +428,21 @@ void Profiler::reset(const size_t numRuns)
 {
   if (!(numRuns > 0))
     DUNE_THROW(Dune::RangeError, "preparing the profiler for 0 runs is moronic");
+  std::lock_guard<std::mutex> lock(mutex_);
+  // discard everything not yet folded, running timers only count from now on
+  for (auto&& thread_data : all_thread_data_) {
+    for (auto&& thread_slot : thread_data->slots) {
+      thread_slot.elapsed = {{0, 0, 0}};
+      thread_slot.counters.fill(0);
+      if (thread_slot.running)
+        thread_slot.folded = to_delta(thread_slot.timer.elapsed());
+      thread_slot.touched = thread_slot.running;
+    }
+  }
   datamaps_.clear();
   datamaps_           = DatamapVector(numRuns, Datamap());
+  countermaps_        = CountermapVector(numRuns, Countermap());
+  itemmaps_           = std::vector<Itemmap>(numRuns, Itemmap());
   current_run_number_ = 0;
 } // Reset
 
@@ -182,9 +453,12 @@ void Profiler::addCount(const size_t num)
 
 void Profiler::nextRun()
 {
+  std::lock_guard<std::mutex> lock(mutex_);
+  fold();
   // set all known timers to "stopped"
-  for (auto& timer_it : known_timers_map_)
-    timer_it.second.first = false;
+  for (auto&& thread_data : all_thread_data_)
+    for (auto&& thread_slot : thread_data->slots)
+      thread_slot.running = thread_slot.touched = false;
   current_run_number_++;
 }
 
@@ -209,11 +483,11 @@ void Profiler::outputAveraged(const int refineLevel, const long numDofs, const d
 
   boost::filesystem::ofstream csv(filename);
 
+  const auto datamaps = mergedDatamaps();
   std::map<std::string, long> averages_map;
-  for (const auto& datamap : datamaps_) {
+  for (const auto& datamap : datamaps) {
     for (const auto& timing : datamap) {
-      //! this used to be GetTiming( it->second ), which is only valid thru an implicit and wrong conversion..
-      averages_map[timing.first] += getTiming(timing.first);
+      averages_map[timing.first] += timing.second[0];
     }
   }
 
@@ -229,7 +503,7 @@ void Profiler::outputAveraged(const int refineLevel, const long numDofs, const d
   for (const auto& avg_item : averages_map) {
     long clock_count = avg_item.second;
     clock_count = long(comm.sum(clock_count) / double(scale_factor * numProce));
-    csv << clock_count / double(datamaps_.size()) << csv_sep_;
+    csv << clock_count / double(datamaps.size()) << csv_sep_;
   }
   csv << "=I$2/I2" << csv_sep_ << "=SUM(E$2:G$2)/SUM(E2:G2)" << std::endl;
   csv.close();
@@ -259,30 +533,54 @@ void Profiler::outputTimings(const std::string csv) const
 
 void Profiler::outputTimingsAll(std::ostream& out) const
 {
-  if (datamaps_.size() < 1)
+  const auto datamaps = mergedDatamaps();
+  if (datamaps.size() < 1)
     return;
+  const auto countermaps   = mergedCountermaps();
+  const bool with_counters = std::any_of(
+      countermaps.begin(), countermaps.end(), [](const Countermap& countermap) { return !countermap.empty(); });
+  std::map<std::string, size_t> section_dofs;
+  std::vector<Itemmap> itemmaps;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    section_dofs = section_dofs_;
+    itemmaps     = itemmaps_;
+  }
+  const bool with_items =
+      std::any_of(itemmaps.begin(), itemmaps.end(), [](const Itemmap& itemmap) { return !itemmap.empty(); });
+  // assuming 64 byte cache lines
+  const double cache_line_bytes = 64;
   // csv header:
   const auto& comm = Dune::MPIHelper::getCollectiveCommunication();
 
   std::stringstream stash;
 
   stash << "run" << csv_sep_ << "threads" << csv_sep_ << "ranks";
-  for (const auto& section : datamaps_[0]) {
+  for (const auto& section : datamaps[0]) {
     stash << csv_sep_ << section.first << "_avg_mix" << csv_sep_ << section.first << "_max_mix" << csv_sep_
           << section.first << "_avg_usr" << csv_sep_ << section.first << "_max_usr" << csv_sep_ << section.first
           << "_avg_wall" << csv_sep_ << section.first << "_max_wall" << csv_sep_ << section.first << "_avg_sys"
           << csv_sep_ << section.first << "_max_sys";
+    if (with_counters) {
+      for (auto event : valueRange(size_t(PerfCounters::num_events)))
+        stash << csv_sep_ << section.first << "_" << PerfCounters::name(event);
+      stash << csv_sep_ << section.first << "_ipc" << csv_sep_ << section.first << "_llc_bytes_per_dof";
+    }
+    if (with_items)
+      stash << csv_sep_ << section.first << "_items_per_sec";
   }
   int i             = 0;
   const auto weight = 1 / double(comm.size());
-  for (const auto& datamap : datamaps_) {
+  for (const auto& datamap : datamaps) {
+    const auto& run_countermap = size_t(i) < countermaps.size() ? countermaps[i] : Countermap();
+    const auto& run_itemmap    = size_t(i) < itemmaps.size() ? itemmaps[i] : Itemmap();
     stash << std::endl << i++ << csv_sep_ << DS::threadManager().max_threads() << csv_sep_ << comm.size();
     for (const auto& section : datamap) {
       const auto timings  = section.second;
-      auto wall           = timings[1];
-      auto usr            = timings[2];
-      auto sys            = timings[3];
-      auto mix            = timings[0];
+      auto wall           = timings[0];
+      auto usr            = timings[1];
+      auto sys            = timings[2];
+      auto mix            = usr + sys;
       const auto wall_sum = comm.sum(wall);
       const auto wall_max = comm.max(wall);
       const auto usr_sum  = comm.sum(usr);
@@ -294,6 +592,27 @@ void Profiler::outputTimingsAll(std::ostream& out) const
       stash << csv_sep_ << mix_sum * weight << csv_sep_ << mix_max << csv_sep_ << usr_sum * weight << csv_sep_
             << usr_max << csv_sep_ << wall_sum * weight << csv_sep_ << wall_max << csv_sep_ << sys_sum * weight
             << csv_sep_ << sys_max;
+      if (with_counters) {
+        const auto run_counters = run_countermap.find(section.first);
+        std::array<double, PerfCounters::num_events> counts;
+        for (auto event : valueRange(counts.size()))
+          counts[event] = comm.sum(run_counters == run_countermap.end() ? 0. : double(run_counters->second[event]));
+        for (auto count : counts)
+          stash << csv_sep_ << count;
+        const auto dofs = section_dofs.find(section.first);
+        stash << csv_sep_ << (counts[PerfCounters::cycles] > 0
+                                  ? counts[PerfCounters::instructions] / counts[PerfCounters::cycles]
+                                  : 0.)
+              << csv_sep_ << (dofs != section_dofs.end() && dofs->second > 0
+                                  ? counts[PerfCounters::llc_misses] * cache_line_bytes / comm.sum(double(dofs->second))
+                                  : 0.);
+      }
+      if (with_items) {
+        // the wall times are in milliseconds
+        const auto items = run_itemmap.find(section.first);
+        const double run_items = comm.sum(items == run_itemmap.end() ? 0. : double(items->second));
+        stash << csv_sep_ << (wall_max > 0 ? 1000. * run_items / wall_max : 0.);
+      }
     }
   }
   stash << std::endl;
@@ -303,15 +622,16 @@ void Profiler::outputTimingsAll(std::ostream& out) const
 
 void Profiler::outputTimings(std::ostream& out) const
 {
-  if (datamaps_.size() < 1)
+  const auto datamaps = mergedDatamaps();
+  if (datamaps.size() < 1)
     return;
   // csv header:
   out << "run";
-  for (const auto& section : datamaps_[0]) {
+  for (const auto& section : datamaps[0]) {
     out << csv_sep_ << section.first;
   }
   size_t i = 0;
-  for (const auto& datamap : datamaps_) {
+  for (const auto& datamap : datamaps) {
     out << std::endl << i;
     for (const auto& section : datamap) {
       out << csv_sep_ << section.second[0];
@@ -320,8 +640,89 @@ void Profiler::outputTimings(std::ostream& out) const
   }
 }
 
+void Profiler::setTraceCapacity(const size_t events_per_thread)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto&& thread_data : all_thread_data_) {
+    thread_data->trace.clear();
+    thread_data->trace_count = 0;
+  }
+  trace_epoch_ = std::chrono::steady_clock::now();
+  trace_capacity_.store(events_per_thread);
+} // ... setTraceCapacity(...)
+
+void Profiler::outputTrace(const std::string filename) const
+{
+  const auto& comm = Dune::MPIHelper::getCollectiveCommunication();
+  boost::filesystem::path dir(output_dir_);
+  boost::filesystem::ofstream out(dir / (boost::format("%s_p%08d.json") % filename % comm.rank()).str());
+  outputTrace(out);
+}
+
+void Profiler::outputTrace(std::ostream& out) const
+{
+  const auto& comm = Dune::MPIHelper::getCollectiveCommunication();
+  std::lock_guard<std::mutex> lock(mutex_);
+  // the trace format expects microseconds, keep the full nanosecond resolution regardless of the stream's precision
+  const auto microseconds = [](const TimingData::TimeType nanoseconds) {
+    return (boost::format("%d.%03d") % (nanoseconds / 1000) % (nanoseconds % 1000)).str();
+  };
+  out << "{\"traceEvents\":[";
+  std::string sep = "\n";
+  for (auto tid : valueRange(all_thread_data_.size())) {
+    for (const auto& event : traceEvents(*all_thread_data_[tid])) {
+      out << sep << "{\"name\":\"" << json_escaped(section_names_[event.section_id]) << "\",\"ph\":\"X\",\"ts\":"
+          << microseconds(event.begin) << ",\"dur\":" << microseconds(event.end - event.begin)
+          << ",\"pid\":" << comm.rank() << ",\"tid\":" << tid << "}";
+      sep = ",\n";
+    }
+  }
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+} // ... outputTrace(...)
+
+void Profiler::outputFlamegraph(const std::string filename) const
+{
+  const auto& comm = Dune::MPIHelper::getCollectiveCommunication();
+  boost::filesystem::path dir(output_dir_);
+  boost::filesystem::ofstream out(dir / (boost::format("%s_p%08d.folded") % filename % comm.rank()).str());
+  outputFlamegraph(out);
+}
+
+void Profiler::outputFlamegraph(std::ostream& out) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  // collapsed stack -> self time in nanoseconds
+  std::map<std::string, TimingData::TimeType> self_times;
+  for (auto&& thread_data : all_thread_data_) {
+    // parents enclose their children, so sorting by begin (and longest first) yields a pre-order of the call tree
+    auto events = traceEvents(*thread_data);
+    std::sort(events.begin(), events.end(), [](const TraceEvent& lhs, const TraceEvent& rhs) {
+      return lhs.begin < rhs.begin || (lhs.begin == rhs.begin && lhs.end > rhs.end);
+    });
+    std::vector<std::pair<const TraceEvent*, std::string>> stack;
+    for (const auto& event : events) {
+      while (!stack.empty() && stack.back().first->end < event.end)
+        stack.pop_back();
+      auto name = section_names_[event.section_id];
+      std::replace(name.begin(), name.end(), ';', ':');
+      const auto path = stack.empty() ? name : stack.back().second + ";" + name;
+      const auto duration = event.end - event.begin;
+      self_times[path] += duration;
+      if (!stack.empty())
+        self_times[stack.back().second] -= duration;
+      stack.emplace_back(&event, path);
+    }
+  }
+  for (const auto& item : self_times)
+    out << item.first << " " << std::max(item.second, TimingData::TimeType(0)) / 1000 << "\n";
+} // ... outputFlamegraph(...)
+
 Profiler::Profiler()
-  : csv_sep_(",")
+  : current_run_number_(0)
+  , trace_capacity_(0)
+  , trace_epoch_(std::chrono::steady_clock::now())
+  , count_events_(false)
+  , csv_sep_(",")
 {
   DSC_LIKWID_INIT;
   reset(1);
@@ -335,13 +736,14 @@ Profiler::~Profiler()
 
 OutputScopedTiming::OutputScopedTiming(const std::string& section_name, std::ostream& out)
   : ScopedTiming(section_name)
+  , section_name_(section_name)
   , out_(out)
 {
 }
 
 OutputScopedTiming::~OutputScopedTiming()
 {
-  const auto duration = profiler().stopTiming(section_name_);
+  const auto duration = profiler().stopTiming(section_id_);
   out_ << "Executing " << section_name_ << " took " << duration / 1000.f << "s\n";
 }
 
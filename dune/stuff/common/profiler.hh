@@ -16,11 +16,15 @@
 
 #include <string>
 #include <map>
+#include <deque>
+#include <array>
 #include <vector>
 #include <ctime>
 #include <memory>
 #include <iostream>
 #include <mutex>
+#include <atomic>
+#include <chrono>
 
 #include <boost/noncopyable.hpp>
 #include <boost/timer/timer.hpp>
@@ -29,6 +33,7 @@
 
 #include <dune/stuff/common/parallel/threadmanager.hh>
 #include <dune/stuff/common/parallel/threadstorage.hh>
+#include <dune/stuff/common/perf_counters.hh>
 
 namespace Dune {
 namespace Stuff {
@@ -69,6 +74,12 @@ class ScopedTiming;
   *program
    * instances.\n
    *  - Provides csv-conform output of process-averaged runtimes.
+   *  - Section names are interned into ids (see sectionId()), timings are kept per thread and section w/o any locking.
+   *    The per thread timings are merged when they are queried or output, which should thus not happen while other
+   *    threads are timing.
+   *  - Optionally (see setTraceCapacity()) records start and stop time of every section in a per thread ring buffer,
+   *    which can be output as a Chrome trace (outputTrace()) or as collapsed call stacks (outputFlamegraph()).
+   *  - Optionally (see setHardwareCounters()) counts cpu events per section, which are output in outputTimingsAll().
    **/
 class Profiler
 {
@@ -78,31 +89,128 @@ private:
   Profiler();
   ~Profiler();
 
-  typedef std::map<std::string, std::pair<bool, PerThreadValue<TimingData>>> KnownTimersMap;
   //! section name -> seconds
   typedef std::map<std::string, TimingData::DeltaType> Datamap;
   //! "Run idx" -> Datamap = section name -> seconds
   typedef std::vector<Datamap> DatamapVector;
+  //! section name -> hardware event counts
+  typedef std::map<std::string, PerfCounters::ValueType> Countermap;
+  typedef std::vector<Countermap> CountermapVector;
+  //! section name -> number of processed items
+  typedef std::map<std::string, size_t> Itemmap;
+
+  //! the timing of one section in one thread
+  struct ThreadSlot
+  {
+    ThreadSlot();
+
+    const std::string* name;
+    //! started since the last fold into datamaps_
+    bool touched;
+    bool running;
+    boost::timer::cpu_timer timer;
+    //! accumulated, but not yet folded into datamaps_
+    TimingData::DeltaType elapsed;
+    //! part of the current interval of a running timer that was already folded into datamaps_
+    TimingData::DeltaType folded;
+    //! start of the current interval in nanoseconds since trace_epoch_, only set if tracing
+    TimingData::TimeType trace_begin;
+    //! whether the current interval is counted by the hardware counters
+    bool counting;
+    PerfCounters::ValueType counters_begin;
+    //! accumulated, but not yet folded into countermaps_
+    PerfCounters::ValueType counters;
+  };
+  typedef std::vector<ThreadSlot> ThreadSlots;
+
+  //! one finished section, in nanoseconds since trace_epoch_
+  struct TraceEvent
+  {
+    size_t section_id;
+    TimingData::TimeType begin;
+    TimingData::TimeType end;
+  };
+
+  //! everything the profiler keeps per thread
+  struct ThreadData
+  {
+    ThreadData();
+
+    ThreadSlots slots;
+    //! ring buffer of the last trace_capacity_ events
+    std::vector<TraceEvent> trace;
+    //! number of events recorded since the last setTraceCapacity()
+    size_t trace_count;
+    bool registered;
+    //! created on the first start of a section after setHardwareCounters(true)
+    std::shared_ptr<PerfCounters> perf_counters;
+  };
 
   //! get runtime of section in run run_number in milliseconds
   TimingData::DeltaType getTimingIdx(const std::string section_name, const size_t run_number) const;
 
+  //! the slot of the calling thread, only locks if the thread sees section_id for the first time
+  ThreadSlot& slot(ThreadData& thread_data, const size_t section_id);
+
+  //! stops a running slot of the calling thread and records it in the trace, \return the interval
+  TimingData::DeltaType stop(ThreadData& thread_data, ThreadSlot& thread_slot, const size_t section_id);
+
+  TimingData::TimeType traceTime() const;
+
+  //! the recorded events of thread_data, oldest first
+  std::vector<TraceEvent> traceEvents(const ThreadData& thread_data) const;
+
+  //! moves the timings of all threads into the current run of datamaps_, mutex_ has to be locked
+  void fold();
+
+  //! datamaps_ including the timings of all threads not yet folded
+  DatamapVector mergedDatamaps() const;
+
+  //! countermaps_ including the counts of all threads not yet folded
+  CountermapVector mergedCountermaps() const;
+
 public:
   void stopAll();
 
+  //! interns section_name, the returned id may be used instead of the name in all subsequent calls
+  size_t sectionId(const std::string& section_name);
+
   //! set this to begin a named section
   void startTiming(const std::string section_name);
+  void startTiming(const size_t section_id);
 
   //! stop named section's counter
   long stopTiming(const std::string section_name);
+  long stopTiming(const size_t section_id);
 
-  //! set elapsed time back to 0 for section_name
+  //! set elapsed time back to 0 for section_name, stops the timer of the calling thread
   void resetTiming(const std::string section_name);
 
+  //! add a time measured elsewhere to section_name (in the current run), delta as in TimingData::delta()
+  void addTiming(const std::string section_name, const TimingData::DeltaType& delta);
+
   //! get runtime of section in current run in milliseconds
   long getTiming(const std::string section_name) const;
   TimingData::DeltaType get_delta(const std::string section_name) const;
 
+  /** count cycles, instructions, last level cache and branch misses of all sections started from now on (if the
+   *  system allows it, see PerfCounters)
+   *  \return whether the counters are available for the calling thread
+   **/
+  bool setHardwareCounters(const bool enable);
+
+  //! the hardware event counts of section in the current run, all zero if none were counted
+  PerfCounters::ValueType getCounters(const std::string section_name) const;
+
+  //! number of DoFs section_name works on, to output the memory traffic per DoF
+  void setDofs(const std::string section_name, const size_t dofs);
+
+  //! add to the number of items (e.g. entities) section_name processed in the current run, to output the throughput
+  void addItems(const std::string section_name, const size_t items);
+
+  //! number of items section_name processed in the current run, see addItems()
+  size_t getItems(const std::string section_name) const;
+
   /** output to currently pre-defined (csv) file, does not output individual run results, but average over all recorded
    * results
      **/
@@ -111,6 +219,8 @@ public:
   //! file-output the named sections only
   void outputTimings(const std::string filename) const;
   void outputTimings(std::ostream& out = std::cout) const;
+  //! \note adds event counts, instructions per cycle and llc bytes per DoF if hardware counters were used, and the
+  //!       items per second (of the maximal wall time) if items were added
   void outputTimingsAll(std::ostream& out = std::cout) const;
 
   /** call this with correct numRuns <b> before </b> starting any profiling
@@ -128,6 +238,19 @@ public:
 
   void setOutputdir(const std::string dir);
 
+  /** record up to events_per_thread (most recent) sections per thread for outputTrace() and outputFlamegraph(),
+   *  0 (the default) disables tracing. Discards all events recorded so far.
+   **/
+  void setTraceCapacity(const size_t events_per_thread);
+
+  //! Chrome trace event format (json), to be loaded in chrome://tracing or https://ui.perfetto.dev
+  void outputTrace(const std::string filename) const;
+  void outputTrace(std::ostream& out) const;
+
+  //! collapsed stacks with self times in microseconds, as expected by flamegraph.pl
+  void outputFlamegraph(const std::string filename) const;
+  void outputFlamegraph(std::ostream& out) const;
+
 private:
   DatamapVector datamaps_;
   size_t current_run_number_;
@@ -136,9 +259,21 @@ private:
   // debug counter, only outputted in debug mode
   std::map<size_t, size_t> counters_;
 
-  KnownTimersMap known_timers_map_;
+  //! interned section names, a deque to keep the references in the ThreadSlots valid
+  std::deque<std::string> section_names_;
+  std::map<std::string, size_t> section_ids_;
+  PerThreadValue<ThreadData> thread_data_;
+  //! the ThreadData of all threads that ever timed something, in order of their first timing
+  std::vector<ThreadData*> all_thread_data_;
+  std::atomic<size_t> trace_capacity_;
+  std::chrono::steady_clock::time_point trace_epoch_;
+  CountermapVector countermaps_;
+  std::atomic<bool> count_events_;
+  std::map<std::string, size_t> section_dofs_;
+  std::vector<Itemmap> itemmaps_;
   const std::string csv_sep_;
-  std::mutex mutex_;
+  //! guards the section names and datamaps_, not used by start- and stopTiming once a section is known to a thread
+  mutable std::mutex mutex_;
 
   static Profiler& instance()
   {
@@ -156,18 +291,24 @@ inline Profiler& profiler()
 class ScopedTiming : public boost::noncopyable
 {
 protected:
-  const std::string section_name_;
+  const size_t section_id_;
 
 public:
   inline ScopedTiming(const std::string& section_name)
-    : section_name_(section_name)
+    : ScopedTiming(profiler().sectionId(section_name))
   {
-    profiler().startTiming(section_name_);
+  }
+
+  //! does not lock the profiler, once the calling thread knows section_id
+  inline ScopedTiming(const size_t section_id)
+    : section_id_(section_id)
+  {
+    profiler().startTiming(section_id_);
   }
 
   inline ~ScopedTiming()
   {
-    profiler().stopTiming(section_name_);
+    profiler().stopTiming(section_id_);
   }
 };
 
@@ -178,6 +319,7 @@ struct OutputScopedTiming : public ScopedTiming
   ~OutputScopedTiming();
 
 protected:
+  const std::string section_name_;
   std::ostream& out_;
 };
 
@@ -189,8 +331,13 @@ protected:
 
 #if DUNE_STUFF_DO_PROFILE
 #define DUNE_STUFF_PROFILE_SCOPE(section_name) Dune::Stuff::Common::ScopedTiming DSC_UNUSED(timer)(section_name)
+//! \note section_name is evaluated (and interned) once per scope and has to be the same for all executions
+#define DUNE_STUFF_PROFILE_SCOPE_STATIC(section_name)                                                                  \
+  static const size_t dune_stuff_profile_scope_id = DSC_PROFILER.sectionId(section_name);                             \
+  Dune::Stuff::Common::ScopedTiming DSC_UNUSED(timer)(dune_stuff_profile_scope_id)
 #else
 #define DUNE_STUFF_PROFILE_SCOPE(section_name)
+#define DUNE_STUFF_PROFILE_SCOPE_STATIC(section_name)
 #endif
 
 #endif // DUNE_STUFF_PROFILER_HH_INCLUDED
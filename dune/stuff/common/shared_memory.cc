@@ -0,0 +1,348 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#include "config.h"
+
+#include "shared_memory.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#if HAVE_SYS_MMAN_H
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <boost/filesystem.hpp>
+
+namespace Dune {
+namespace Stuff {
+namespace Common {
+namespace {
+
+std::mutex& registry_mutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+//! the segments of this process, by key
+std::map<std::string, std::weak_ptr<const SharedMemorySegment>>& registry()
+{
+  static std::map<std::string, std::weak_ptr<const SharedMemorySegment>> segments;
+  return segments;
+}
+
+//! FNV-1a, which unlike std::hash is the same for every build
+std::uint64_t stable_hash(const std::string& str)
+{
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const unsigned char cc : str) {
+    hash ^= cc;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+#if HAVE_SYS_MMAN_H
+
+enum SegmentState : std::uint32_t
+{
+  filling = 0,
+  ready   = 1,
+  failed  = 2
+};
+
+/**
+ * The segment holds the header, the key (to rule out hash collisions) and, starting at the next page boundary, the
+ * data. The memory is zero-initialized by ftruncate, which is a valid state of the (lock-free) atomics.
+ */
+struct SegmentHeader
+{
+  std::atomic<std::uint32_t> state;
+  std::atomic<std::int64_t> users;
+  //! the pid of the process filling the segment, to detect segments abandoned by a killed creator
+  std::atomic<std::int64_t> creator;
+  std::uint64_t size;
+  std::uint64_t key_size;
+};
+
+//! the creator gets this long to fill the segment, afterwards the other processes use private memory
+const std::chrono::seconds fill_timeout(60);
+
+//! the creator claims the segment (sizes it and stores its pid) right after creating it, or was killed before
+const std::chrono::seconds claim_timeout(1);
+
+std::string segment_name(const std::string& key)
+{
+  std::ostringstream name;
+  name << "/dune-stuff-" << ::getuid() << "-" << std::hex << stable_hash(key);
+  return name.str();
+}
+
+size_t data_offset(const std::string& key)
+{
+  const size_t page_size = ::sysconf(_SC_PAGESIZE);
+  return ((sizeof(SegmentHeader) + key.size() + page_size - 1) / page_size) * page_size;
+}
+
+void pause_briefly()
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+unsigned long long inode_of(const int fd)
+{
+  struct stat status;
+  return ::fstat(fd, &status) == 0 ? status.st_ino : 0;
+}
+
+//! removes the segment called name, unless the name belongs to another segment than the one given by inode by now
+void unlink_if_same(const std::string& name, const unsigned long long inode)
+{
+  const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    return;
+  const bool same = inode_of(fd) == inode;
+  ::close(fd);
+  if (same)
+    ::shm_unlink(name.c_str());
+} // ... unlink_if_same(...)
+
+bool is_dead(const std::int64_t pid)
+{
+  return pid > 0 && ::kill(pid_t(pid), 0) != 0 && errno == ESRCH;
+}
+
+#else // HAVE_SYS_MMAN_H
+
+std::string segment_name(const std::string& key)
+{
+  std::ostringstream name;
+  name << "dune-stuff-" << std::hex << stable_hash(key);
+  return name.str();
+}
+
+#endif // HAVE_SYS_MMAN_H
+
+} // namespace
+
+std::shared_ptr<const SharedMemorySegment> SharedMemorySegment::attach(const std::string& key, const size_t bytes,
+                                                                       const FillType& fill)
+{
+  {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    const auto segment = registry()[key].lock();
+    if (segment && segment->size() == bytes)
+      return segment;
+  }
+  // filling or waiting for the segment may take long, which must not block the other keys
+  const std::shared_ptr<const SharedMemorySegment> segment(new SharedMemorySegment(key, bytes, fill));
+  std::lock_guard<std::mutex> lock(registry_mutex());
+  auto& known = registry()[key];
+  // another thread might have attached to the same key meanwhile
+  const auto other = known.lock();
+  if (other && other->size() == bytes)
+    return other;
+  known = segment;
+  return segment;
+} // ... attach(...)
+
+std::string SharedMemorySegment::file_key(const std::string& filename)
+{
+  boost::system::error_code error;
+  const auto path = boost::filesystem::canonical(filename, error);
+  if (error)
+    return filename;
+  const auto size = boost::filesystem::file_size(path, error);
+  const auto time = boost::filesystem::last_write_time(path, error);
+  if (error)
+    return path.string();
+  std::ostringstream key;
+  key << path.string() << ":" << size << ":" << time;
+  return key.str();
+} // ... file_key(...)
+
+SharedMemorySegment::SharedMemorySegment(const std::string& key, const size_t bytes, const FillType& fill)
+  : name_(segment_name(key))
+  , size_(bytes)
+  , data_(nullptr)
+  , mapping_(nullptr)
+  , mapping_size_(0)
+  , inode_(0)
+{
+#if HAVE_SYS_MMAN_H
+  // the segment might be removed (by its last user or as abandoned) between our attempts to create and to open it
+  for (size_t attempt = 0; attempt < 3; ++attempt) {
+    if (create(key, fill))
+      return;
+    const auto result = open(key);
+    if (result == OpenResult::attached)
+      return;
+    if (result == OpenResult::give_up)
+      break;
+  }
+#endif
+  buffer_.reset(new char[std::max(size_, size_t(1))]());
+  data_ = buffer_.get();
+  fill(buffer_.get());
+} // SharedMemorySegment(...)
+
+SharedMemorySegment::~SharedMemorySegment()
+{
+#if HAVE_SYS_MMAN_H
+  if (mapping_) {
+    // if another process attaches in between, it keeps its mapping, but later processes create a new segment
+    if (static_cast<SegmentHeader*>(mapping_)->users.fetch_sub(1) == 1)
+      unlink_if_same(name_, inode_);
+    ::munmap(mapping_, mapping_size_);
+  }
+#endif
+}
+
+bool SharedMemorySegment::create(const std::string& key, const FillType& fill)
+{
+#if HAVE_SYS_MMAN_H
+  const int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fd < 0)
+    return false;
+  const unsigned long long inode = inode_of(fd);
+  const size_t offset = data_offset(key);
+  const size_t total  = offset + size_;
+  void* mapping = MAP_FAILED;
+  if (::ftruncate(fd, total) == 0)
+    mapping = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping != MAP_FAILED) {
+    static_cast<SegmentHeader*>(mapping)->creator.store(::getpid());
+    // reserve the memory, so a full /dev/shm does not show up as SIGBUS while filling
+    if (::posix_fallocate(fd, 0, total) != 0) {
+      ::munmap(mapping, total);
+      mapping = MAP_FAILED;
+    }
+  }
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    unlink_if_same(name_, inode);
+    return false;
+  }
+  auto& header    = *static_cast<SegmentHeader*>(mapping);
+  header.size     = size_;
+  header.key_size = key.size();
+  std::memcpy(static_cast<char*>(mapping) + sizeof(SegmentHeader), key.data(), key.size());
+  header.users.store(1);
+  char* data = static_cast<char*>(mapping) + offset;
+  try {
+    fill(data);
+  } catch (...) {
+    header.state.store(failed, std::memory_order_release);
+    unlink_if_same(name_, inode);
+    ::munmap(mapping, total);
+    throw;
+  }
+  if (size_ > 0)
+    ::mprotect(data, size_, PROT_READ);
+  header.state.store(ready, std::memory_order_release);
+  mapping_      = mapping;
+  mapping_size_ = total;
+  inode_        = inode;
+  data_         = data;
+  return true;
+#else // HAVE_SYS_MMAN_H
+  return false;
+#endif // HAVE_SYS_MMAN_H
+} // ... create(...)
+
+SharedMemorySegment::OpenResult SharedMemorySegment::open(const std::string& key)
+{
+#if HAVE_SYS_MMAN_H
+  const int fd = ::shm_open(name_.c_str(), O_RDWR, 0);
+  if (fd < 0)
+    return OpenResult::retry;
+  const unsigned long long inode = inode_of(fd);
+  const size_t offset = data_offset(key);
+  const size_t total  = offset + size_;
+  const auto start    = std::chrono::steady_clock::now();
+  const auto waited   = [&](const std::chrono::seconds timeout) {
+    return std::chrono::steady_clock::now() > start + timeout;
+  };
+  // the creator might not have sized the segment yet, or was killed before doing so
+  struct stat status;
+  status.st_size = 0;
+  while (::fstat(fd, &status) == 0 && status.st_size == 0 && !waited(claim_timeout))
+    pause_briefly();
+  if (status.st_size == 0) {
+    ::close(fd);
+    unlink_if_same(name_, inode);
+    return OpenResult::retry;
+  }
+  void* mapping = MAP_FAILED;
+  if (size_t(status.st_size) == total)
+    mapping = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED)
+    return OpenResult::give_up;
+  auto& header = *static_cast<SegmentHeader*>(mapping);
+  // wait for the creator to fill the segment, unless it was killed
+  while (header.state.load(std::memory_order_acquire) == filling) {
+    const auto creator = header.creator.load();
+    if ((creator == 0 && waited(claim_timeout)) || is_dead(creator)) {
+      ::munmap(mapping, total);
+      unlink_if_same(name_, inode);
+      return OpenResult::retry;
+    }
+    if (waited(fill_timeout)) {
+      ::munmap(mapping, total);
+      return OpenResult::give_up;
+    }
+    pause_briefly();
+  }
+  // a failed creator removes the segment itself
+  if (header.state.load(std::memory_order_acquire) != ready) {
+    ::munmap(mapping, total);
+    return OpenResult::retry;
+  }
+  if (header.size != size_ || header.key_size != key.size()
+      || std::memcmp(static_cast<char*>(mapping) + sizeof(SegmentHeader), key.data(), key.size()) != 0) {
+    ::munmap(mapping, total);
+    return OpenResult::give_up;
+  }
+  // only join while there are users, the last one removes the segment (or was killed before doing so)
+  auto users = header.users.load();
+  do {
+    if (users <= 0) {
+      ::munmap(mapping, total);
+      unlink_if_same(name_, inode);
+      return OpenResult::retry;
+    }
+  } while (!header.users.compare_exchange_weak(users, users + 1));
+  char* data = static_cast<char*>(mapping) + offset;
+  if (size_ > 0)
+    ::mprotect(data, size_, PROT_READ);
+  mapping_      = mapping;
+  mapping_size_ = total;
+  inode_        = inode;
+  data_         = data;
+  return OpenResult::attached;
+#else // HAVE_SYS_MMAN_H
+  return OpenResult::give_up;
+#endif // HAVE_SYS_MMAN_H
+} // ... open(...)
+
+} // namespace Common
+} // namespace Stuff
+} // namespace Dune
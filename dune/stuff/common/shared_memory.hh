@@ -0,0 +1,122 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#ifndef DUNE_STUFF_COMMON_SHARED_MEMORY_HH
+#define DUNE_STUFF_COMMON_SHARED_MEMORY_HH
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+
+#include <boost/noncopyable.hpp>
+
+namespace Dune {
+namespace Stuff {
+namespace Common {
+
+/** \brief A read-only block of memory, shared by all users of the same key within a process and across processes.
+ *
+ *  The first user of a key creates the segment (as POSIX shared memory, if HAVE_SYS_MMAN_H) and fills it, all other
+ *  users (e.g. the other MPI ranks on the same node) wait for it to be filled and attach to it. The data is mapped
+ *  read-only for everyone once it is filled. The last process to detach removes the segment. If the segment cannot be
+ *  created or attached, each process fills its own copy in private memory instead.
+ *
+ *  \note The key has to identify the data completely, e.g. the name, size and modification time of a data file (see
+ *        file_key()) and all parameters used to compute the values from it.
+ *  \note A segment whose creator was killed while filling it is removed by the next process attaching to the key (the
+ *        creator is identified by its pid, so all users have to share a pid namespace). Filled segments of processes
+ *        which were killed remain in /dev/shm (named dune-stuff-*) and are reused, until removed by hand.
+ **/
+class SharedMemorySegment : public boost::noncopyable
+{
+public:
+  typedef std::function<void(void*)> FillType;
+
+  /**
+   * \param fill is called with bytes of zero-initialized memory if the segment does not exist yet, exceptions are
+   *        propagated to the caller
+   */
+  static std::shared_ptr<const SharedMemorySegment> attach(const std::string& key, const size_t bytes,
+                                                           const FillType& fill);
+
+  //! canonical path, size and modification time of filename, which change whenever the file does
+  static std::string file_key(const std::string& filename);
+
+  ~SharedMemorySegment();
+
+  const void* data() const
+  {
+    return data_;
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  //! whether the segment is shared with other processes, as opposed to held in private memory
+  bool shared() const
+  {
+    return mapping_ != nullptr;
+  }
+
+private:
+  SharedMemorySegment(const std::string& key, const size_t bytes, const FillType& fill);
+
+  bool create(const std::string& key, const FillType& fill);
+
+  enum class OpenResult
+  {
+    attached,
+    //! the segment vanished or was abandoned, create it (again)
+    retry,
+    //! the segment does not fit or was not filled in time, use private memory
+    give_up
+  };
+
+  OpenResult open(const std::string& key);
+
+  const std::string name_;
+  const size_t size_;
+  const void* data_;
+  void* mapping_;
+  size_t mapping_size_;
+  //! identifies our segment, the name might be reused for another one once we are its last user
+  unsigned long long inode_;
+  std::unique_ptr<char[]> buffer_;
+}; // class SharedMemorySegment
+
+/**
+ * \brief count values of type T in a SharedMemorySegment, filled by fill if the key is not present yet
+ * \note T has to be trivially destructible (like FieldVector or FieldMatrix), since it lives in memory that is
+ *       shared between processes
+ */
+template <class T>
+std::shared_ptr<const T> make_shared_array(const std::string& key, const size_t count,
+                                           const std::function<void(T*)>& fill)
+{
+  static_assert(std::is_trivially_destructible<T>::value, "T cannot be stored in shared memory!");
+  const auto segment = SharedMemorySegment::attach(
+      key + "\n" + typeid(T).name() + "\n" + std::to_string(count), count * sizeof(T), [&](void* data) {
+        T* values = static_cast<T*>(data);
+        for (size_t ii = 0; ii < count; ++ii)
+          new (values + ii) T();
+        fill(values);
+      });
+  // the aliasing constructor keeps the segment alive as long as the values are used
+  return std::shared_ptr<const T>(segment, static_cast<const T*>(segment->data()));
+} // ... make_shared_array(...)
+
+} // namespace Common
+} // namespace Stuff
+} // namespace Dune
+
+#endif // DUNE_STUFF_COMMON_SHARED_MEMORY_HH
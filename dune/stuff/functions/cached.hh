@@ -0,0 +1,221 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#ifndef DUNE_STUFF_FUNCTIONS_CACHED_HH
+#define DUNE_STUFF_FUNCTIONS_CACHED_HH
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/stuff/common/debug.hh>
+#include <dune/stuff/common/memory.hh>
+#include <dune/stuff/common/ranges.hh>
+
+#include "interfaces.hh"
+
+namespace Dune {
+namespace Stuff {
+namespace Functions {
+
+#if HAVE_DUNE_GRID
+
+/**
+ * \brief Caches the values of a (piecewise) constant function for all entities of a grid view.
+ *
+ *        Functions like Checkerboard or Spe10::Model1 locate each entity anew and return a freshly allocated local
+ *        function on every call of local_function(). EntityCached evaluates the wrapped function once on each entity
+ *        of grid_view whose local function has order 0 and stores the values in a flat array, indexed by the index set
+ *        of grid_view. Repeated assemblies can then read value() without any virtual calls or allocations, while
+ *        local_function() still works as usual (forwarding to the wrapped function on entities of higher order).
+ * \note  The values are computed on construction, call update() after the wrapped function or the grid changed.
+ */
+template <class GridViewImp, class FunctionImp>
+class EntityCached
+    : public LocalizableFunctionInterface<typename FunctionImp::EntityType, typename FunctionImp::DomainFieldType,
+                                          FunctionImp::dimDomain, typename FunctionImp::RangeFieldType,
+                                          FunctionImp::dimRange, FunctionImp::dimRangeCols>
+{
+  typedef LocalizableFunctionInterface<typename FunctionImp::EntityType, typename FunctionImp::DomainFieldType,
+                                       FunctionImp::dimDomain, typename FunctionImp::RangeFieldType,
+                                       FunctionImp::dimRange, FunctionImp::dimRangeCols> BaseType;
+  typedef EntityCached<GridViewImp, FunctionImp> ThisType;
+  typedef Common::ConstStorageProvider<FunctionImp> FunctionStorageType;
+
+  class Localfunction : public BaseType::LocalfunctionType
+  {
+    typedef typename BaseType::LocalfunctionType LocalfunctionBaseType;
+
+  public:
+    typedef typename LocalfunctionBaseType::EntityType EntityType;
+    typedef typename LocalfunctionBaseType::DomainFieldType DomainFieldType;
+    static const size_t dimDomain = LocalfunctionBaseType::dimDomain;
+    typedef typename LocalfunctionBaseType::DomainType DomainType;
+    typedef typename LocalfunctionBaseType::RangeFieldType RangeFieldType;
+    typedef typename LocalfunctionBaseType::RangeType RangeType;
+    typedef typename LocalfunctionBaseType::JacobianRangeType JacobianRangeType;
+
+    Localfunction(const EntityType& ent, const RangeType& value)
+      : LocalfunctionBaseType(ent)
+      , value_(value)
+    {
+    }
+
+    Localfunction(const Localfunction& /*other*/) = delete;
+
+    Localfunction& operator=(const Localfunction& /*other*/) = delete;
+
+    virtual size_t order() const override final
+    {
+      return 0;
+    }
+
+    virtual void evaluate(const DomainType& UNUSED_UNLESS_DEBUG(xx), RangeType& ret) const override final
+    {
+      assert(this->is_a_valid_point(xx));
+      ret = value_;
+    }
+
+    virtual void evaluate(const Dune::QuadratureRule<DomainFieldType, dimDomain>& quadrature,
+                          std::vector<RangeType>& ret) const override final
+    {
+      assert(ret.size() >= quadrature.size());
+      std::fill(ret.begin(), ret.begin() + quadrature.size(), value_);
+    }
+
+    virtual void jacobian(const DomainType& UNUSED_UNLESS_DEBUG(xx), JacobianRangeType& ret) const override final
+    {
+      assert(this->is_a_valid_point(xx));
+      jacobian_helper(ret, internal::ChooseVariant<BaseType::dimRangeCols>());
+    }
+
+  private:
+    template <size_t rC>
+    void jacobian_helper(JacobianRangeType& ret, internal::ChooseVariant<rC>) const
+    {
+      for (auto& col_jacobian : ret)
+        col_jacobian *= RangeFieldType(0);
+    }
+
+    void jacobian_helper(JacobianRangeType& ret, internal::ChooseVariant<1>) const
+    {
+      ret *= RangeFieldType(0);
+    }
+
+    const RangeType& value_;
+  }; // class Localfunction
+
+public:
+  typedef GridViewImp GridViewType;
+  typedef FunctionImp FunctionType;
+  typedef typename BaseType::EntityType EntityType;
+  typedef typename BaseType::LocalfunctionType LocalfunctionType;
+  typedef typename BaseType::DomainFieldType DomainFieldType;
+  static const size_t dimDomain = BaseType::dimDomain;
+  typedef typename BaseType::RangeType RangeType;
+
+  static std::string static_id()
+  {
+    return BaseType::static_id() + ".entity_cached";
+  }
+
+  EntityCached(const GridViewType& grid_view, const FunctionType& func, const std::string nm = "")
+    : grid_view_(grid_view)
+    , func_(Common::make_unique<FunctionStorageType>(func))
+    , name_(nm.empty() ? "cached '" + func.name() + "'" : nm)
+  {
+    update();
+  }
+
+  EntityCached(const GridViewType& grid_view, const std::shared_ptr<const FunctionType> func, const std::string nm = "")
+    : grid_view_(grid_view)
+    , func_(Common::make_unique<FunctionStorageType>(func))
+    , name_(nm.empty() ? "cached '" + func->name() + "'" : nm)
+  {
+    update();
+  }
+
+  EntityCached(const ThisType& other) = delete;
+  EntityCached(ThisType&& source) = default;
+
+  ThisType& operator=(const ThisType& other) = delete;
+  ThisType& operator=(ThisType&& source) = delete;
+
+  //! evaluates the wrapped function on all entities of the grid view again
+  void update()
+  {
+    const auto& index_set = grid_view_.indexSet();
+    values_.assign(index_set.size(0), RangeType(0));
+    cached_.assign(index_set.size(0), false);
+    for (const auto& entity : DSC::entityRange(grid_view_)) {
+      const auto local_func = func_->access().local_function(entity);
+      if (local_func->order() > 0)
+        continue;
+      const size_t index = index_set.index(entity);
+      local_func->evaluate(ReferenceElements<DomainFieldType, dimDomain>::general(entity.type()).position(0, 0),
+                           values_[index]);
+      cached_[index] = true;
+    }
+  } // ... update(...)
+
+  //! whether the value of the function on entity (of the grid view) is cached
+  bool cached(const EntityType& entity) const
+  {
+    return cached_[grid_view_.indexSet().index(entity)];
+  }
+
+  /**
+   * \brief the value of the function on entity (of the grid view)
+   * \attention only valid if cached(entity)
+   */
+  const RangeType& value(const EntityType& entity) const
+  {
+    const size_t index = grid_view_.indexSet().index(entity);
+    assert(cached_[index]);
+    return values_[index];
+  }
+
+  virtual std::unique_ptr<LocalfunctionType> local_function(const EntityType& entity) const override final
+  {
+    const auto& index_set = grid_view_.indexSet();
+    if (index_set.contains(entity)) {
+      const size_t index = index_set.index(entity);
+      if (cached_[index])
+        return Common::make_unique<Localfunction>(entity, values_[index]);
+    }
+    return func_->access().local_function(entity);
+  } // ... local_function(...)
+
+  virtual std::string type() const override final
+  {
+    return static_id() + " of '" + func_->access().type() + "'";
+  }
+
+  virtual std::string name() const override final
+  {
+    return name_;
+  }
+
+private:
+  const GridViewType grid_view_;
+  std::unique_ptr<const FunctionStorageType> func_;
+  const std::string name_;
+  //! by index of the entity in grid_view_
+  std::vector<RangeType> values_;
+  std::vector<bool> cached_;
+}; // class EntityCached
+
+#endif // HAVE_DUNE_GRID
+
+} // namespace Functions
+} // namespace Stuff
+} // namespace Dune
+
+#endif // DUNE_STUFF_FUNCTIONS_CACHED_HH
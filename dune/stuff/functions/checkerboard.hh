@@ -11,6 +11,7 @@
 #ifndef DUNE_STUFF_FUNCTION_CHECKERBOARD_HH
 #define DUNE_STUFF_FUNCTION_CHECKERBOARD_HH
 
+#include <array>
 #include <vector>
 #include <cmath>
 #include <memory>
@@ -50,9 +51,10 @@ class Checkerboard
     typedef typename BaseType::RangeType RangeType;
     typedef typename BaseType::JacobianRangeType JacobianRangeType;
 
-    Localfunction(const EntityType& ent, const RangeType value)
+    Localfunction(const ThisType& checkerboard, const EntityType& ent)
       : BaseType(ent)
-      , value_(value)
+      , checkerboard_(checkerboard)
+      , value_(checkerboard_.find_value(ent))
     {
     }
 
@@ -77,6 +79,13 @@ class Checkerboard
       jacobian_helper(ret, internal::ChooseVariant<rangeDimCols>());
     }
 
+    virtual bool bind(const EntityType& ent) override final
+    {
+      this->set_entity(ent);
+      value_ = checkerboard_.find_value(ent);
+      return true;
+    }
+
   private:
     template <size_t rC>
     void jacobian_helper(JacobianRangeType& ret, internal::ChooseVariant<rC>) const
@@ -90,7 +99,9 @@ class Checkerboard
     {
       ret *= RangeFieldType(0);
     }
-    const RangeType value_;
+
+    const ThisType& checkerboard_;
+    RangeType value_;
   }; // class Localfunction
 
 public:
@@ -158,10 +169,24 @@ public:
                const Common::FieldVector<DomainFieldType, dimDomain>& upperRight,
                const Common::FieldVector<size_t, dimDomain>& numElements, const std::vector<RangeType>& values,
                const std::string nm = static_id())
+    : Checkerboard(lowerLeft, upperRight, numElements, share(values), values.size(), nm)
+  {
+  }
+
+  /**
+   * \brief Uses the given values without copying them, e.g. values in a Common::SharedMemorySegment, which all
+   *        functions and processes using the same coefficient field attach to (see Common::make_shared_array()).
+   * \param num_values the number of values, has to be at least the number of elements
+   */
+  Checkerboard(const Common::FieldVector<DomainFieldType, dimDomain>& lowerLeft,
+               const Common::FieldVector<DomainFieldType, dimDomain>& upperRight,
+               const Common::FieldVector<size_t, dimDomain>& numElements, std::shared_ptr<const RangeType> values,
+               const size_t num_values, const std::string nm = static_id())
     : lowerLeft_(new Common::FieldVector<DomainFieldType, dimDomain>(lowerLeft))
     , upperRight_(new Common::FieldVector<DomainFieldType, dimDomain>(upperRight))
     , numElements_(new Common::FieldVector<size_t, dimDomain>(numElements))
-    , values_(new std::vector<RangeType>(values))
+    , values_(values)
+    , num_values_(num_values)
     , name_(nm)
   {
     // checks
@@ -174,9 +199,9 @@ public:
         DUNE_THROW(Dune::RangeError, "lowerLeft has to be elementwise smaller than upperRight!");
       totalSubdomains *= ne;
     }
-    if (values_->size() < totalSubdomains)
+    if (num_values_ < totalSubdomains)
       DUNE_THROW(Dune::RangeError,
-                 "values too small (is " << values_->size() << ", should be " << totalSubdomains << ")");
+                 "values too small (is " << num_values_ << ", should be " << totalSubdomains << ")");
   } // Checkerboard(...)
 
   Checkerboard(const ThisType& other) = default;
@@ -196,10 +221,17 @@ public:
   }
 
   virtual std::unique_ptr<LocalfunctionType> local_function(const EntityType& entity) const override
+  {
+    return std::unique_ptr<Localfunction>(new Localfunction(*this, entity));
+  }
+
+private:
+  //! the value of the subdomain the center of entity belongs to
+  const RangeType& find_value(const EntityType& entity) const
   {
     // decide on the subdomain the center of the entity belongs to
     const auto center = entity.geometry().center();
-    std::vector<size_t> whichPartition(dimDomain, 0);
+    std::array<size_t, dimDomain> whichPartition;
     const auto& ll = *lowerLeft_;
     const auto& ur = *upperRight_;
     const auto& ne = *numElements_;
@@ -217,14 +249,21 @@ public:
     else
       subdomain = whichPartition[0] + whichPartition[1] * ne[0] + whichPartition[2] * ne[1] * ne[0];
     // return the component that belongs to the subdomain
-    return std::unique_ptr<Localfunction>(new Localfunction(entity, (*values_)[subdomain]));
-  } // ... local_function(...)
+    return values_.get()[subdomain];
+  } // ... find_value(...)
+
+  static std::shared_ptr<const RangeType> share(const std::vector<RangeType>& values)
+  {
+    const auto copy = std::make_shared<const std::vector<RangeType>>(values);
+    return std::shared_ptr<const RangeType>(copy, copy->data());
+  }
 
-private:
   std::shared_ptr<const Common::FieldVector<DomainFieldType, dimDomain>> lowerLeft_;
   std::shared_ptr<const Common::FieldVector<DomainFieldType, dimDomain>> upperRight_;
   std::shared_ptr<const Common::FieldVector<size_t, dimDomain>> numElements_;
-  std::shared_ptr<const std::vector<RangeType>> values_;
+  //! points to num_values_ values
+  std::shared_ptr<const RangeType> values_;
+  size_t num_values_;
   std::string name_;
 }; // class Checkerboard
 
@@ -254,8 +254,10 @@ public:
 
   CombinedLocalFunction(const LeftType& left, const RightType& right, const EntityType& ent)
     : BaseType(ent)
-    , left_local_(left.local_function(this->entity()))
-    , right_local_(right.local_function(this->entity()))
+    , left_(left)
+    , right_(right)
+    , left_local_(left_.local_function(this->entity()))
+    , right_local_(right_.local_function(this->entity()))
     , tmp_range_(0.0)
     , tmp_jacobian_(0.0)
   {
@@ -276,9 +278,22 @@ public:
     Select::jacobian(*left_local_, *right_local_, xx, ret, tmp_jacobian_);
   }
 
+  //! rebinds both local functions, or replaces those which cannot be rebound
+  virtual bool bind(const EntityType& ent) override final
+  {
+    this->set_entity(ent);
+    if (!left_local_->bind(ent))
+      left_local_ = left_.local_function(ent);
+    if (!right_local_->bind(ent))
+      right_local_ = right_.local_function(ent);
+    return true;
+  } // ... bind(...)
+
 private:
-  const std::unique_ptr<const typename LeftType::LocalfunctionType> left_local_;
-  const std::unique_ptr<const typename RightType::LocalfunctionType> right_local_;
+  const LeftType& left_;
+  const RightType& right_;
+  std::unique_ptr<typename LeftType::LocalfunctionType> left_local_;
+  std::unique_ptr<typename RightType::LocalfunctionType> right_local_;
   mutable RangeType tmp_range_;
   mutable JacobianRangeType tmp_jacobian_;
 }; // class CombinedLocalFunction
@@ -155,7 +155,8 @@ public:
 
   DerivedLocalFunction(const FunctionType& func, const EntityType& ent)
     : BaseType(ent)
-    , func_local_(func.local_function(this->entity()))
+    , func_(func)
+    , func_local_(func_.local_function(this->entity()))
   {
   }
 
@@ -174,8 +175,17 @@ public:
     Select::jacobian(*func_local_, xx, ret);
   }
 
+  virtual bool bind(const EntityType& ent) override final
+  {
+    this->set_entity(ent);
+    if (!func_local_->bind(ent))
+      func_local_ = func_.local_function(ent);
+    return true;
+  }
+
 private:
-  const std::unique_ptr<const typename FunctionType::LocalfunctionType> func_local_;
+  const FunctionType& func_;
+  std::unique_ptr<typename FunctionType::LocalfunctionType> func_local_;
 }; // class DerivedLocalFunction
 
 template <class FunctionType, Derivative derivative>
@@ -22,6 +22,7 @@
 #include <dune/stuff/common/parallel/threadstorage.hh>
 
 #include "expression/base.hh"
+#include "expression/bytecode.hh"
 #include "interfaces.hh"
 #include "default.hh"
 
@@ -39,7 +40,8 @@ class Expression
   typedef Expression<EntityImp, DomainFieldImp, domainDim, RangeFieldImp, rangeDim, rangeDimCols> ThisType;
   typedef MathExpressionBase<DomainFieldImp, domainDim, RangeFieldImp, rangeDim * rangeDimCols>
       MathExpressionFunctionType;
-  typedef MathExpressionBase<DomainFieldImp, domainDim, RangeFieldImp, domainDim> MathExpressionGradientType;
+  typedef MathExpressionBase<DomainFieldImp, domainDim, RangeFieldImp, rangeDim * rangeDimCols * domainDim>
+      MathExpressionGradientType;
 
 public:
   using typename BaseType::EntityType;
@@ -64,7 +66,9 @@ public:
     config["variable"]   = "x";
     config["expression"] = "[x[0] sin(x[0]) exp(x[0]); x[0] sin(x[0]) exp(x[0]); x[0] sin(x[0]) exp(x[0])]";
     config["order"]      = "3";
-    config["name"] = static_id();
+    config["name"]    = static_id();
+    config["backend"] = "mathexpr";
+    config["jit"]     = "false";
     if (sub_name.empty())
       return config;
     else {
@@ -104,11 +108,20 @@ public:
       get_gradient(cfg, gradient_as_vectors, "gradient.0");
     }
     // create
-    return Common::make_unique<ThisType>(cfg.get("variable", default_cfg.get<std::string>("variable")),
-                                         expression_as_vectors,
-                                         cfg.get("order", default_cfg.get<size_t>("order")),
-                                         cfg.get("name", default_cfg.get<std::string>("name")),
-                                         gradient_as_vectors);
+    auto function = Common::make_unique<ThisType>(cfg.get("variable", default_cfg.get<std::string>("variable")),
+                                                  expression_as_vectors,
+                                                  cfg.get("order", default_cfg.get<size_t>("order")),
+                                                  cfg.get("name", default_cfg.get<std::string>("name")),
+                                                  gradient_as_vectors);
+    const auto backend = cfg.get("backend", default_cfg.get<std::string>("backend"));
+    if (backend == "bytecode")
+      function->compile_bytecode();
+    else if (backend != "mathexpr")
+      DUNE_THROW(Exceptions::configuration_error,
+                 "Unknown backend '" << backend << "' given, has to be one of 'mathexpr' and 'bytecode'!");
+    if (cfg.get("jit", default_cfg.get<bool>("jit")))
+      function->compile_native();
+    return function;
   } // ... create(...)
 
   /**
@@ -135,8 +148,9 @@ public:
       }
     }
     // build function and gradient
-    build_function(variable, expressions);
-    build_gradients(variable, gradient_expressions);
+    build_function(expressions);
+    build_gradients(gradient_expressions);
+    parse(variable);
   }
 
   /**
@@ -148,16 +162,23 @@ public:
   Expression(const std::string variable, const std::vector<std::string> expressions,
              const size_t ord = default_config().get<size_t>("order"), const std::string nm = static_id(),
              const std::vector<std::vector<std::string>> gradient_expressions = std::vector<std::vector<std::string>>())
-    : function_(new MathExpressionFunctionType(variable, expressions))
-    , order_(ord)
+    : order_(ord)
     , name_(nm)
   {
     static_assert(dimRangeCols == 1, "This constructor does not make sense for dimRangeCols > 1!");
+    if (expressions.size() < dimRange)
+      DUNE_THROW(InvalidStateException,
+                 "expressions too short (is " << expressions.size() << ", should be " << dimRange << ")!");
+    ExpressionStringVectorType expressions_vec;
+    for (size_t rr = 0; rr < dimRange; ++rr)
+      expressions_vec.emplace_back(1, expressions[rr]);
     GradientStringVectorType gradient_expressions_vec;
     if (gradient_expressions.size() > 0) {
       gradient_expressions_vec.emplace_back(gradient_expressions);
     }
-    build_gradients(variable, gradient_expressions_vec);
+    build_function(expressions_vec);
+    build_gradients(gradient_expressions_vec);
+    parse(variable);
   }
 
   /**
@@ -179,8 +200,9 @@ public:
     : order_(ord)
     , name_(nm)
   {
-    build_function(variable, expressions);
-    build_gradients(variable, gradient_expressions);
+    build_function(expressions);
+    build_gradients(gradient_expressions);
+    parse(variable);
   }
 
   Expression(const ThisType& other) = default;
@@ -188,14 +210,50 @@ public:
   ThisType& operator=(const ThisType& other)
   {
     if (this != &other) {
-      function_  = other.function_;
-      order_     = other.order_;
-      name_      = other.name_;
-      gradients_ = other.gradients_;
+      variable_             = other.variable_;
+      expressions_          = other.expressions_;
+      gradient_expressions_ = other.gradient_expressions_;
+      order_                = other.order_;
+      name_                 = other.name_;
+      function_             = other.function_;
+      gradient_             = other.gradient_;
+      bytecode_             = nullptr;
+      if (other.bytecode_)
+        set_bytecode(other.bytecode_);
     }
     return *this;
   }
 
+  /**
+   * \brief Evaluates the function and its gradients with an ExpressionBytecode from now on (instead of mathexpr),
+   *        which also derives the gradients symbolically if none were given.
+   * \attention Must not be called while the function is evaluated concurrently.
+   * \note The bytecode evaluates in double, while mathexpr evaluates in long double, so the results may differ by
+   *       rounding.
+   */
+  void compile_bytecode()
+  {
+    if (!bytecode_)
+      set_bytecode(create_bytecode());
+  }
+
+  /**
+   * \brief Evaluates the function and its gradients with native code from now on, see
+   *        ExpressionBytecode::compile_native() and compile_bytecode().
+   * \attention Must not be called while the function is evaluated concurrently.
+   * \return false if native code is not available, the current backend is used further on then
+   */
+  bool compile_native()
+  {
+    if (bytecode_ && bytecode_->is_native())
+      return true;
+    auto bytecode = bytecode_ ? std::make_shared<ExpressionBytecode>(*bytecode_) : create_bytecode();
+    if (!bytecode->compile_native())
+      return false;
+    set_bytecode(bytecode);
+    return true;
+  } // ... compile_native(...)
+
   virtual std::string type() const override final
   {
     return BaseType::static_id() + ".expression";
@@ -214,8 +272,108 @@ public:
   virtual void evaluate(const DomainType& xx, RangeType& ret) const override
   {
     evaluate_helper(xx, ret, internal::ChooseVariant<dimRangeCols>());
-#ifndef NDEBUG
-#ifndef DUNE_STUFF_FUNCTIONS_EXPRESSION_DISABLE_CHECKS
+    check_value(xx, ret);
+  } // ... evaluate(...)
+
+  //! evaluates all points in one pass of the bytecode (if used), see ExpressionBytecode::evaluate_batch()
+  virtual void evaluate(const std::vector<DomainType>& xx, std::vector<RangeType>& ret) const override
+  {
+    assert(ret.size() >= xx.size());
+    if (!bytecode_) {
+      for (size_t ii = 0; ii < xx.size(); ++ii)
+        evaluate(xx[ii], ret[ii]);
+      return;
+    }
+    evaluate_batch_helper(xx, ret, internal::ChooseVariant<dimRangeCols>());
+    for (size_t ii = 0; ii < xx.size(); ++ii)
+      check_value(xx[ii], ret[ii]);
+  } // ... evaluate(...)
+
+  virtual bool supports_batch() const override
+  {
+    return bool(bytecode_);
+  }
+
+  /**
+   * \note If no gradient expressions were given, the gradients are only available with the bytecode, which derives
+   *       them symbolically from the expressions (see compile_bytecode()).
+   */
+  virtual void jacobian(const DomainType& xx, JacobianRangeType& ret) const override
+  {
+    if (bytecode_)
+      bytecode_->evaluate(xx, dimDomain, *registers_, *tmp_jacobian_, 1);
+    else if (gradient_)
+      gradient_->evaluate(xx, *tmp_jacobian_);
+    else
+      DUNE_THROW(NotImplemented, "This function does not provide any gradients!");
+    jacobian_helper(ret, internal::ChooseVariant<dimRangeCols>());
+  } // ... jacobian(...)
+
+private:
+  // fill the rows of the dimRange x dimRangeCols matrix (aka vector< vector< string > > expression) in a vector of
+  // length dimRange*dimRangeCols, e.g. [3 4; 1 2] becomes [3 4 1 2]
+  void build_function(const ExpressionStringVectorType& expressions)
+  {
+    assert(expressions.size() >= dimRange);
+    for (size_t rr = 0; rr < dimRange; ++rr) {
+      assert(expressions[rr].size() >= dimRangeCols);
+      for (size_t cc = 0; cc < dimRangeCols; ++cc) {
+        expressions_.emplace_back(expressions[rr][cc]);
+      }
+    }
+  } // ... build_function(...)
+
+  // same for the gradients, the gradient of entry rr * dimRangeCols + cc comes first, followed by the next one
+  void build_gradients(const GradientStringVectorType& gradient_expressions)
+  {
+    assert(gradient_expressions.size() == 0 || gradient_expressions.size() >= dimRangeCols);
+    if (gradient_expressions.size() > 0) {
+      gradient_expressions_.resize(dimRange * dimRangeCols * dimDomain);
+      for (size_t cc = 0; cc < dimRangeCols; ++cc) {
+        assert(gradient_expressions[cc].size() >= dimRange);
+        for (size_t rr = 0; rr < dimRange; ++rr) {
+          const auto& gradient_expression = gradient_expressions[cc][rr];
+          assert(gradient_expression.size() >= dimDomain);
+          for (size_t ii = 0; ii < dimDomain; ++ii)
+            gradient_expressions_[(rr * dimRangeCols + cc) * dimDomain + ii] = gradient_expression[ii];
+        }
+      }
+    }
+  } // ... build_gradients(...)
+
+  // the function and all gradients are parsed by mathexpr, the bytecode is only created on request
+  void parse(const std::string& variable)
+  {
+    variable_ = variable;
+    function_ = std::make_shared<const MathExpressionFunctionType>(variable_, expressions_);
+    if (!gradient_expressions_.empty())
+      gradient_ = std::make_shared<const MathExpressionGradientType>(variable_, gradient_expressions_);
+  } // ... parse(...)
+
+  // the function is group 0 and all gradients are group 1 of the bytecode, derived symbolically if none are given
+  std::shared_ptr<ExpressionBytecode> create_bytecode() const
+  {
+    std::vector<ExpressionBytecode::ExpressionsType> groups(1, expressions_);
+    const bool derive = gradient_expressions_.empty();
+    if (!derive)
+      groups.emplace_back(gradient_expressions_);
+    return std::make_shared<ExpressionBytecode>(variable_, dimDomain, groups, derive);
+  } // ... create_bytecode(...)
+
+  void set_bytecode(const std::shared_ptr<const ExpressionBytecode>& bytecode)
+  {
+    bytecode_        = bytecode;
+    registers_       = bytecode_->registers();
+    batch_registers_ = bytecode_->batch_registers();
+  }
+
+#if defined(NDEBUG) || defined(DUNE_STUFF_FUNCTIONS_EXPRESSION_DISABLE_CHECKS)
+  void check_value(const DomainType& /*xx*/, const RangeType& /*ret*/) const
+  {
+  }
+#else
+  void check_value(const DomainType& xx, const RangeType& ret) const
+  {
     bool failure = false;
     std::string error_type;
     for (size_t rr = 0; rr < dimRange; ++rr) {
@@ -237,10 +395,10 @@ public:
                          << error_type
                          << "!\n"
                          << "The variable of this function is:     "
-                         << function_->variable()
+                         << variable_
                          << "\n"
                          << "The expression of this functional is: "
-                         << function_->expression().at(rr * dimRangeCols + cc)
+                         << expressions_.at(rr * dimRangeCols + cc)
                          << "\n"
                          << "You tried to evaluate it with:   xx = "
                          << xx
@@ -251,56 +409,16 @@ public:
                          << "You can disable this check by defining DUNE_STUFF_FUNCTIONS_EXPRESSION_DISABLE_CHECKS\n");
       }
     }
-#endif // DUNE_STUFF_FUNCTIONS_EXPRESSION_DISABLE_CHECKS
-#endif // NDEBUG
-  } // ... evaluate(...)
-
-  virtual void jacobian(const DomainType& xx, JacobianRangeType& ret) const override
-  {
-    if (gradients_.size() == 0) {
-      DUNE_THROW(NotImplemented, "This function does not provide any gradients!");
-    } else {
-      assert(gradients_.size() == dimRangeCols);
-      jacobian_helper(xx, ret, internal::ChooseVariant<dimRangeCols>());
-    }
-  } // ... jacobian(...)
-
-private:
-  // fill the rows of the dimRange x dimRangeCols matrix (aka vector< vector< string > > expression) in a vector of
-  // length dimRange*dimRangeCols, e.g. [3 4; 1 2] becomes [3 4 1 2], in order to create function_
-  void build_function(const std::string variable, const ExpressionStringVectorType& expressions)
-  {
-    assert(expressions.size() >= dimRange);
-    std::vector<std::string> reordered_expressions;
-    for (size_t rr = 0; rr < dimRange; ++rr) {
-      assert(expressions[rr].size() >= dimRangeCols);
-      for (size_t cc = 0; cc < dimRangeCols; ++cc) {
-        reordered_expressions.emplace_back(expressions[rr][cc]);
-      }
-    }
-    function_ = std::make_shared<MathExpressionFunctionType>(variable, reordered_expressions);
-  } // ... build_function(...)
-
-  void build_gradients(const std::string variable, const GradientStringVectorType& gradient_expressions)
-  {
-    assert(gradient_expressions.size() == 0 || gradient_expressions.size() >= dimRangeCols);
-    if (gradient_expressions.size() > 0) {
-      for (size_t cc = 0; cc < dimRangeCols; ++cc) {
-        gradients_.emplace_back(std::vector<std::shared_ptr<const MathExpressionGradientType>>());
-        assert(gradient_expressions[cc].size() >= dimRange);
-        for (size_t rr = 0; rr < dimRange; ++rr) {
-          const auto& gradient_expression = gradient_expressions[cc][rr];
-          assert(gradient_expression.size() >= dimDomain);
-          gradients_[cc].emplace_back(new MathExpressionGradientType(variable, gradient_expression));
-        }
-      }
-    }
-  } // ... build_gradients(...)
+  } // ... check_value(...)
+#endif
 
   template <size_t rC>
   void evaluate_helper(const DomainType& xx, RangeType& ret, internal::ChooseVariant<rC>) const
   {
-    function_->evaluate(xx, *tmp_vector_);
+    if (bytecode_)
+      bytecode_->evaluate(xx, dimDomain, *registers_, *tmp_vector_);
+    else
+      function_->evaluate(xx, *tmp_vector_);
     for (size_t rr = 0; rr < dimRange; ++rr) {
       auto& retRow = ret[rr];
       for (size_t cc = 0; cc < dimRangeCols; ++cc)
@@ -310,26 +428,46 @@ private:
 
   void evaluate_helper(const DomainType& xx, RangeType& ret, internal::ChooseVariant<1>) const
   {
-    function_->evaluate(xx, ret);
+    if (bytecode_)
+      bytecode_->evaluate(xx, dimDomain, *registers_, ret);
+    else
+      function_->evaluate(xx, ret);
   } // ... evaluate_helper(..., ...< 1 >)
 
   template <size_t rC>
-  void jacobian_helper(const DomainType& xx, JacobianRangeType& ret, internal::ChooseVariant<rC>) const
+  void evaluate_batch_helper(const std::vector<DomainType>& xx, std::vector<RangeType>& ret,
+                             internal::ChooseVariant<rC>) const
   {
-    for (size_t cc = 0; cc < dimRangeCols; ++cc) {
-      assert(gradients_[cc].size() == dimRange);
-      for (size_t rr = 0; rr < dimRange; ++rr) {
-        gradients_[cc][rr]->evaluate(xx, ret[cc][rr]);
-      }
-    }
+    auto& tmp_vectors = *tmp_vectors_;
+    if (tmp_vectors.size() < xx.size())
+      tmp_vectors.resize(xx.size());
+    bytecode_->evaluate_batch(xx, dimDomain, *batch_registers_, tmp_vectors);
+    for (size_t ii = 0; ii < xx.size(); ++ii)
+      for (size_t rr = 0; rr < dimRange; ++rr)
+        for (size_t cc = 0; cc < dimRangeCols; ++cc)
+          ret[ii][rr][cc] = tmp_vectors[ii][rr * dimRangeCols + cc];
+  } // ... evaluate_batch_helper(...)
+
+  void evaluate_batch_helper(const std::vector<DomainType>& xx, std::vector<RangeType>& ret,
+                             internal::ChooseVariant<1>) const
+  {
+    bytecode_->evaluate_batch(xx, dimDomain, *batch_registers_, ret);
+  } // ... evaluate_batch_helper(..., ...< 1 >)
+
+  template <size_t rC>
+  void jacobian_helper(JacobianRangeType& ret, internal::ChooseVariant<rC>) const
+  {
+    for (size_t cc = 0; cc < dimRangeCols; ++cc)
+      for (size_t rr = 0; rr < dimRange; ++rr)
+        for (size_t ii = 0; ii < dimDomain; ++ii)
+          ret[cc][rr][ii] = (*tmp_jacobian_)[(rr * dimRangeCols + cc) * dimDomain + ii];
   } // ... jacobian_helper(...)
 
-  void jacobian_helper(const DomainType& xx, JacobianRangeType& ret, internal::ChooseVariant<1>) const
+  void jacobian_helper(JacobianRangeType& ret, internal::ChooseVariant<1>) const
   {
-    assert(gradients_[0].size() == dimRange);
-    for (size_t rr = 0; rr < dimRange; ++rr) {
-      gradients_[0][rr]->evaluate(xx, ret[rr]);
-    }
+    for (size_t rr = 0; rr < dimRange; ++rr)
+      for (size_t ii = 0; ii < dimDomain; ++ii)
+        ret[rr][ii] = (*tmp_jacobian_)[rr * dimDomain + ii];
   } // ... jacobian_helper(..., ...< 1 >)
 
   template <size_t rC>
@@ -382,12 +520,21 @@ private:
     }
   } // ... get_gradient(...)
 
-  std::shared_ptr<const MathExpressionFunctionType> function_;
+  std::string variable_;
+  std::vector<std::string> expressions_;
+  std::vector<std::string> gradient_expressions_;
   size_t order_;
   std::string name_;
+  std::shared_ptr<const MathExpressionFunctionType> function_;
+  std::shared_ptr<const MathExpressionGradientType> gradient_;
+  //! nullptr unless compile_bytecode() or compile_native() was called
+  std::shared_ptr<const ExpressionBytecode> bytecode_;
+  mutable typename DS::PerThreadValue<std::vector<double>> registers_;
+  mutable typename DS::PerThreadValue<std::vector<double>> batch_registers_;
   mutable typename DS::PerThreadValue<FieldVector<RangeFieldType, dimRange * dimRangeCols>> tmp_vector_;
+  mutable typename DS::PerThreadValue<std::vector<FieldVector<RangeFieldType, dimRange * dimRangeCols>>> tmp_vectors_;
   mutable typename DS::PerThreadValue<FieldVector<RangeFieldType, dimRangeCols>> tmp_row_;
-  std::vector<std::vector<std::shared_ptr<const MathExpressionGradientType>>> gradients_;
+  mutable typename DS::PerThreadValue<FieldVector<RangeFieldType, dimRangeCols * dimRange * dimDomain>> tmp_jacobian_;
 }; // class Expression
 
 } // namespace Functions
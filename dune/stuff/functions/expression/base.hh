@@ -21,6 +21,7 @@
 
 #include <dune/stuff/common/string.hh>
 #include <dune/stuff/common/color.hh>
+#include <dune/stuff/common/parallel/threadstorage.hh>
 
 #include "mathexpr.hh"
 
@@ -31,6 +32,8 @@ namespace Functions {
 /**
  *  \brief base class that makes a function out of the stuff from mathexpr.hh
  *  \attention  Most surely you do not want to use this class directly, but Functions::Expression!
+ *  \note The mathexpr objects store the argument and their evaluation stack, each thread thus gets its own parsed
+ *        copy of them. All evaluate methods are thread safe and do not lock.
  */
 template <class DomainFieldImp, size_t domainDim, class RangeFieldImp, size_t rangeDim>
 class MathExpressionBase
@@ -44,37 +47,88 @@ public:
   typedef RangeFieldImp RangeFieldType;
   static const size_t dimRange = rangeDim;
 
+private:
+  //! the parsed expressions of one thread
+  class Evaluator
+  {
+  public:
+    Evaluator(const std::vector<std::string>& variables, const std::vector<std::string>& expressions)
+      : variables_(variables)
+      , expressions_(expressions)
+    {
+      for (size_t ii = 0; ii < dimDomain; ++ii) {
+        arg_[ii]      = 0.0;
+        var_arg_[ii]  = new RVar(variables_[ii].c_str(), &arg_[ii]);
+        vararray_[ii] = var_arg_[ii];
+      }
+      for (size_t ii = 0; ii < dimRange; ++ii)
+        op_[ii] = new ROperation(expressions_[ii].c_str(), dimDomain, vararray_);
+    }
+
+    //! the RVars point into arg_, so copying means parsing again
+    Evaluator(const Evaluator& other)
+      : Evaluator(other.variables_, other.expressions_)
+    {
+    }
+
+    Evaluator& operator=(const Evaluator& other) = delete;
+
+    ~Evaluator()
+    {
+      for (size_t ii = 0; ii < dimRange; ++ii)
+        delete op_[ii];
+      for (size_t ii = 0; ii < dimDomain; ++ii)
+        delete var_arg_[ii];
+    }
+
+    template <class ArgType, class RetType>
+    void evaluate(const ArgType& arg, const size_t arg_size, RetType& ret)
+    {
+      // copy arg
+      for (size_t ii = 0; ii < std::min(dimDomain, arg_size); ++ii)
+        arg_[ii] = arg[ii];
+      // copy ret
+      for (size_t ii = 0; ii < dimRange; ++ii)
+        ret[ii] = op_[ii]->Val();
+    }
+
+  private:
+    const std::vector<std::string> variables_;
+    const std::vector<std::string> expressions_;
+    DomainFieldType arg_[dimDomain];
+    RVar* var_arg_[dimDomain];
+    RVar* vararray_[dimDomain];
+    ROperation* op_[dimRange];
+  }; // class Evaluator
+
+public:
   MathExpressionBase(const std::string _variable, const std::string _expression)
+    : MathExpressionBase(_variable, std::vector<std::string>(1, _expression))
   {
-    const std::vector<std::string> expressions(1, _expression);
-    setup(_variable, expressions);
   }
 
   MathExpressionBase(const std::string _variable, const std::vector<std::string> _expressions)
+    : variable_(_variable)
+    , variables_(create_variables(_variable))
+    , expressions_(check_expressions(_expressions))
+    , evaluators_(variables_, expressions_)
   {
-    setup(_variable, _expressions);
   }
 
   MathExpressionBase(const ThisType& _other)
+    : MathExpressionBase(_other.variable(), _other.expression())
   {
-    setup(_other.variable(), _other.expression());
   }
 
   ThisType& operator=(const ThisType& _other)
   {
     if (this != &_other) {
-      cleanup();
-      variable_    = "";
-      variables_   = std::vector<std::string>();
-      expressions_ = std::vector<std::string>();
-      setup(_other.variable(), _other.expression());
+      variable_    = _other.variable_;
+      variables_   = _other.variables_;
+      expressions_ = _other.expressions_;
+      evaluators_  = Evaluator(variables_, expressions_);
     }
-    return this;
-  }
-
-  ~MathExpressionBase()
-  {
-    cleanup();
+    return *this;
   }
 
   std::string variable() const
@@ -90,13 +144,7 @@ public:
   void evaluate(const Dune::FieldVector<DomainFieldType, dimDomain>& arg,
                 Dune::FieldVector<RangeFieldType, dimRange>& ret) const
   {
-    std::lock_guard<std::mutex> guard(mutex_);
-    // copy arg
-    for (typename Dune::FieldVector<DomainFieldType, dimDomain>::size_type ii = 0; ii < dimDomain; ++ii)
-      *(arg_[ii]) = arg[ii];
-    // copy ret
-    for (typename Dune::FieldVector<RangeFieldType, dimRange>::size_type ii = 0; ii < dimRange; ++ii)
-      ret[ii] = op_[ii]->Val();
+    evaluators_->evaluate(arg, dimDomain, ret);
   }
 
   /**
@@ -104,32 +152,20 @@ public:
    */
   void evaluate(const Dune::DynamicVector<DomainFieldType>& arg, Dune::DynamicVector<RangeFieldType>& ret) const
   {
-    std::lock_guard<std::mutex> guard(mutex_);
     // check for sizes
     assert(arg.size() > 0);
     if (ret.size() != dimRange)
       ret = Dune::DynamicVector<RangeFieldType>(dimRange);
-    // copy arg
-    for (size_t ii = 0; ii < std::min(domainDim, arg.size()); ++ii)
-      *(arg_[ii]) = arg[ii];
-    // copy ret
-    for (typename Dune::DynamicVector<RangeFieldType>::size_type ii = 0; ii < dimRange; ++ii)
-      ret[ii] = op_[ii]->Val();
+    evaluators_->evaluate(arg, arg.size(), ret);
   }
 
   void evaluate(const Dune::FieldVector<DomainFieldType, dimDomain>& arg,
                 Dune::DynamicVector<RangeFieldType>& ret) const
   {
-    std::lock_guard<std::mutex> guard(mutex_);
     // check for sizes
     if (ret.size() != dimRange)
       ret = Dune::DynamicVector<RangeFieldType>(dimRange);
-    // copy arg
-    for (typename Dune::FieldVector<DomainFieldType, dimDomain>::size_type ii = 0; ii < dimDomain; ++ii)
-      *(arg_[ii]) = arg[ii];
-    // copy ret
-    for (typename Dune::DynamicVector<RangeFieldType>::size_type ii = 0; ii < dimRange; ++ii)
-      ret[ii] = op_[ii]->Val();
+    evaluators_->evaluate(arg, dimDomain, ret);
   }
 
   /**
@@ -137,14 +173,8 @@ public:
    */
   void evaluate(const Dune::DynamicVector<DomainFieldType>& arg, Dune::FieldVector<RangeFieldType, dimRange>& ret) const
   {
-    std::lock_guard<std::mutex> guard(mutex_);
     assert(arg.size() > 0);
-    // copy arg
-    for (size_t ii = 0; ii < std::min(dimDomain, arg.size()); ++ii)
-      *(arg_[ii]) = arg[ii];
-    // copy ret
-    for (size_t ii = 0; ii < dimRange; ++ii)
-      ret[ii] = op_[ii]->Val();
+    evaluators_->evaluate(arg, arg.size(), ret);
   }
 
   void report(const std::string _name = "dune.stuff.function.mathexpressionbase", std::ostream& stream = std::cout,
@@ -164,11 +194,22 @@ public:
   } // void report(const std::string, std::ostream&, const std::string&) const
 
 private:
-  void setup(const std::string& _variable, const std::vector<std::string>& _expression)
+  static std::vector<std::string> create_variables(const std::string& _variable)
   {
     static_assert((dimDomain > 0), "Really?");
+    // fill variables (i.e. "x[0]", "x[1]", ...)
+    std::vector<std::string> variables;
+    for (size_t ii = 0; ii < dimDomain; ++ii) {
+      std::stringstream variableStream;
+      variableStream << _variable << "[" << ii << "]";
+      variables.push_back(variableStream.str());
+    }
+    return variables;
+  } // ... create_variables(...)
+
+  static std::vector<std::string> check_expressions(const std::vector<std::string>& _expression)
+  {
     static_assert((dimRange > 0), "Really?");
-    // set expressions
     if (_expression.size() < dimRange)
       DUNE_THROW(Dune::InvalidStateException,
                  "\n" << Dune::Stuff::Common::colorStringRed("ERROR:") << " '_expression' too short (is "
@@ -176,47 +217,13 @@ private:
                       << ", should be "
                       << dimRange
                       << ")!");
-    for (size_t ii = 0; ii < dimRange; ++ii)
-      expressions_.push_back(_expression[ii]);
-    // set variable (i.e. "x")
-    variable_ = _variable;
-    // fill variables (i.e. "x[0]", "x[1]", ...)
-    for (size_t ii = 0; ii < dimDomain; ++ii) {
-      std::stringstream variableStream;
-      variableStream << variable_ << "[" << ii << "]";
-      variables_.push_back(variableStream.str());
-    }
-    // create expressions
-    for (size_t ii = 0; ii < dimDomain; ++ii) {
-      arg_[ii]      = new DomainFieldType(0.0);
-      var_arg_[ii]  = new RVar(variables_[ii].c_str(), arg_[ii]);
-      vararray_[ii] = var_arg_[ii];
-    }
-    for (size_t ii = 0; ii < dimRange; ++ii) {
-      op_[ii] = new ROperation(expressions_[ii].c_str(), dimDomain, vararray_);
-    }
-  } // void setup(const std::string& _variable, const std::vector< std::string >& expressions)
-
-  void cleanup()
-  {
-    for (size_t ii = 0; ii < dimRange; ++ii) {
-      delete op_[ii];
-    }
-    for (size_t ii = 0; ii < dimDomain; ++ii) {
-      delete var_arg_[ii];
-      delete arg_[ii];
-    }
-  } // void cleanup()
+    return std::vector<std::string>(_expression.begin(), _expression.begin() + dimRange);
+  } // ... check_expressions(...)
 
   std::string variable_;
   std::vector<std::string> variables_;
   std::vector<std::string> expressions_;
-  size_t actualDimRange_;
-  mutable DomainFieldType* arg_[dimDomain];
-  RVar* var_arg_[dimDomain];
-  RVar* vararray_[dimDomain];
-  ROperation* op_[dimRange];
-  mutable std::mutex mutex_;
+  mutable PerThreadValue<Evaluator> evaluators_;
 }; // class MathExpressionBase
 
 } // namespace Functions
@@ -0,0 +1,914 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#include "config.h"
+
+#include "bytecode.hh"
+
+#include <cmath>
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <tuple>
+
+#if HAVE_DLFCN_H
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <boost/filesystem.hpp>
+
+#include <dune/common/exceptions.hh>
+
+#include "mathexpr.hh"
+
+namespace Dune {
+namespace Stuff {
+namespace Functions {
+namespace {
+
+/**
+ *  The operations, with the same semantics as in mathexpr.cc. They are compiled here and their source is also pasted
+ *  into the code generated by compile_native(), so both evaluate alike (thus no comments or directives inside).
+ */
+#define DUNE_STUFF_FUNCTIONS_EXPRESSION_OPERATIONS(...)                                                               \
+  __VA_ARGS__                                                                                                          \
+  const char* const operations_source = #__VA_ARGS__;
+
+DUNE_STUFF_FUNCTIONS_EXPRESSION_OPERATIONS(
+const double sqrt_max_double = std::sqrt(DBL_MAX);
+const double sqrt_min_double = std::sqrt(DBL_MIN);
+const double inv_eps         = .1 / DBL_EPSILON;
+
+inline bool invalid(const double value, const double bound)
+{
+  return value == ErrVal || std::abs(value) > bound;
+}
+
+inline double op_add(const double lhs, const double rhs)
+{
+  return (invalid(rhs, sqrt_max_double) || invalid(lhs, sqrt_max_double)) ? ErrVal : lhs + rhs;
+}
+
+inline double op_sub(const double lhs, const double rhs)
+{
+  return (invalid(rhs, sqrt_max_double) || invalid(lhs, sqrt_max_double)) ? ErrVal : lhs - rhs;
+}
+
+inline double op_mul(const double lhs, const double rhs)
+{
+  if (std::abs(rhs) < sqrt_min_double)
+    return 0;
+  if (invalid(rhs, sqrt_max_double))
+    return ErrVal;
+  if (std::abs(lhs) < sqrt_min_double)
+    return 0;
+  return invalid(lhs, sqrt_max_double) ? ErrVal : lhs * rhs;
+}
+
+inline double op_div(const double lhs, const double rhs)
+{
+  if (std::abs(rhs) < sqrt_min_double || invalid(rhs, sqrt_max_double))
+    return ErrVal;
+  if (std::abs(lhs) < sqrt_min_double)
+    return 0 / rhs;
+  return invalid(lhs, sqrt_max_double) ? ErrVal : lhs / rhs;
+}
+
+inline double op_pow(const double lhs, const double rhs)
+{
+  if (!lhs)
+    return 0;
+  if (rhs == ErrVal || lhs == ErrVal || std::abs(rhs * std::log(std::abs(lhs))) > DBL_MAX_EXP)
+    return ErrVal;
+  return (lhs > 0 || !std::fmod(rhs, 1)) ? std::pow(lhs, rhs) : ErrVal;
+}
+
+inline double op_nth_root(const double lhs, const double rhs)
+{
+  if (lhs == ErrVal || rhs == ErrVal || !lhs || rhs * std::log(std::abs(lhs)) < DBL_MIN_EXP)
+    return ErrVal;
+  if (rhs >= 0)
+    return std::pow(rhs, 1 / lhs);
+  return (std::abs(std::fmod(lhs, 2)) == 1) ? -std::pow(-rhs, 1 / lhs) : ErrVal;
+}
+
+inline double op_e10(const double lhs, const double rhs)
+{
+  if (std::abs(rhs) < sqrt_min_double)
+    return 0;
+  if (invalid(rhs, DBL_MAX_10_EXP))
+    return ErrVal;
+  if (std::abs(lhs) < sqrt_min_double)
+    return 0 * std::pow(10, rhs);
+  return invalid(lhs, sqrt_max_double) ? ErrVal : lhs * std::pow(10, rhs);
+}
+
+inline double op_atan2(const double lhs, const double rhs)
+{
+  if (invalid(rhs, inv_eps) || invalid(lhs, inv_eps))
+    return ErrVal;
+  return (lhs || rhs) ? std::atan2(lhs, rhs) : ErrVal;
+}
+
+inline double op_neg(const double arg)
+{
+  return (arg == ErrVal) ? ErrVal : -arg;
+}
+
+inline double op_abs(const double arg)
+{
+  return (arg == ErrVal) ? ErrVal : std::abs(arg);
+}
+
+inline double op_sqrt(const double arg)
+{
+  return (arg == ErrVal || arg > sqrt_max_double || arg < 0) ? ErrVal : std::sqrt(arg);
+}
+
+inline double op_sin(const double arg)
+{
+  return invalid(arg, inv_eps) ? ErrVal : std::sin(arg);
+}
+
+inline double op_cos(const double arg)
+{
+  return invalid(arg, inv_eps) ? ErrVal : std::cos(arg);
+}
+
+inline double op_tan(const double arg)
+{
+  return invalid(arg, inv_eps) ? ErrVal : std::tan(arg);
+}
+
+inline double op_log(const double arg)
+{
+  return (arg == ErrVal || arg <= 0) ? ErrVal : std::log(arg);
+}
+
+inline double op_exp(const double arg)
+{
+  return (arg == ErrVal || arg > DBL_MAX_EXP) ? ErrVal : std::exp(arg);
+}
+
+inline double op_asin(const double arg)
+{
+  return (arg == ErrVal || std::abs(arg) > 1) ? ErrVal : std::asin(arg);
+}
+
+inline double op_acos(const double arg)
+{
+  return (arg == ErrVal || std::abs(arg) > 1) ? ErrVal : std::acos(arg);
+}
+
+inline double op_atan(const double arg)
+{
+  return (arg == ErrVal) ? ErrVal : std::atan(arg);
+}
+
+inline double op_sign(const double arg)
+{
+  return (arg == ErrVal) ? ErrVal : double((arg > 0) - (arg < 0));
+}
+)
+
+#undef DUNE_STUFF_FUNCTIONS_EXPRESSION_OPERATIONS
+
+#ifndef DUNE_STUFF_EXPRESSION_JIT_CXX
+#define DUNE_STUFF_EXPRESSION_JIT_CXX "c++"
+#endif
+
+std::string environment(const char* name, const std::string& default_value)
+{
+  const char* const value = std::getenv(name);
+  return (value && *value) ? std::string(value) : default_value;
+}
+
+#if HAVE_DLFCN_H
+
+boost::filesystem::path native_cache_directory()
+{
+  // w/o a home, each user gets a directory of its own in the shared temporary directory
+  const std::string fallback_home =
+      (boost::filesystem::temp_directory_path() / ("dune-stuff-" + std::to_string(::getuid()))).string();
+  const std::string cache_home = environment("XDG_CACHE_HOME", environment("HOME", fallback_home) + "/.cache");
+  return environment("DUNE_STUFF_EXPRESSION_JIT_CACHE", cache_home + "/dune-stuff");
+}
+
+//! the libraries in directory are loaded into this process, so nobody else may be able to place them there
+bool owned_by_current_user(const boost::filesystem::path& directory)
+{
+  struct stat info;
+  return ::stat(directory.string().c_str(), &info) == 0 && S_ISDIR(info.st_mode) && info.st_uid == ::getuid()
+         && !(info.st_mode & (S_IWGRP | S_IWOTH));
+}
+
+#endif // HAVE_DLFCN_H
+
+//! FNV-1a, which unlike std::hash is the same for every build
+std::uint64_t stable_hash(const std::string& str)
+{
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const unsigned char cc : str) {
+    hash ^= cc;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+//! 17 significant digits are exact, unlike the default formatting of streams
+std::string literal(const double value)
+{
+  if (std::isnan(value))
+    return "std::numeric_limits<double>::quiet_NaN()";
+  if (std::isinf(value))
+    return value > 0 ? "std::numeric_limits<double>::infinity()" : "-std::numeric_limits<double>::infinity()";
+  if (value == 0)
+    return std::signbit(value) ? "-0.0" : "0.0";
+  char buffer[64];
+  std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  return buffer;
+}
+
+const char* operation_name(const size_t op)
+{
+  // in the order of ExpressionBytecode::OpCode
+  static const char* const names[] = {"op_add", "op_sub", "op_mul", "op_div", "op_pow", "op_nth_root", "op_e10",
+                                      "op_atan2", "op_neg", "op_abs", "op_sqrt", "op_sin", "op_cos", "op_tan",
+                                      "op_log", "op_exp", "op_asin", "op_acos", "op_atan", "op_sign"};
+  return names[op];
+}
+
+} // namespace
+
+const size_t ExpressionBytecode::batch_size;
+
+/**
+ *  Translates the tree of an ROperation into instructions, while
+ *  - evaluating every instruction with constant arguments right away and
+ *  - reusing the register of an instruction with the same opcode and arguments, if there is one.
+ *
+ *  The derivatives of compiled registers are obtained by the chain rule on the instructions, so they share all
+ *  subexpressions with the values. Trivial terms (adding zero, multiplying by one, ...) are simplified away there,
+ *  which is not done for the compiled expressions, to keep their operations (and ErrVal cases) those of mathexpr.
+ */
+class ExpressionBytecode::Compiler
+{
+public:
+  explicit Compiler(const std::vector<RVar*>& variables)
+    : variables_(variables)
+    , num_registers_(variables.size())
+  {
+  }
+
+  std::uint32_t compile(const ROperation& operation)
+  {
+    switch (operation.op) {
+      case Num:
+        return constant(operation.ValC);
+      case Var:
+        for (size_t ii = 0; ii < variables_.size(); ++ii)
+          if (operation.pvarval == variables_[ii]->pval)
+            return std::uint32_t(ii);
+        return constant(ErrVal);
+      case Juxt:
+        // only the value of the last member is left on mathexpr's stack
+        return compile(*operation.mmb2);
+      case Add:
+        return binary(OpCode::add, *operation.mmb1, *operation.mmb2);
+      case Sub:
+        return binary(OpCode::sub, *operation.mmb1, *operation.mmb2);
+      case Mult:
+        return binary(OpCode::mul, *operation.mmb1, *operation.mmb2);
+      case Div:
+        return binary(OpCode::div, *operation.mmb1, *operation.mmb2);
+      case Pow:
+        return binary(OpCode::pow, *operation.mmb1, *operation.mmb2);
+      case NthRoot:
+        return binary(OpCode::nth_root, *operation.mmb1, *operation.mmb2);
+      case E10:
+        return binary(OpCode::e10, *operation.mmb1, *operation.mmb2);
+      case Opp:
+        return unary(OpCode::neg, *operation.mmb2);
+      case Abs:
+        return unary(OpCode::abs, *operation.mmb2);
+      case Sqrt:
+        return unary(OpCode::sqrt, *operation.mmb2);
+      case Sin:
+        return unary(OpCode::sin, *operation.mmb2);
+      case Cos:
+        return unary(OpCode::cos, *operation.mmb2);
+      case Tg:
+        return unary(OpCode::tan, *operation.mmb2);
+      case Ln:
+        return unary(OpCode::log, *operation.mmb2);
+      case Exp:
+        return unary(OpCode::exp, *operation.mmb2);
+      case Asin:
+        return unary(OpCode::asin, *operation.mmb2);
+      case Acos:
+        return unary(OpCode::acos, *operation.mmb2);
+      case Atan:
+        if (operation.mmb2->op == Juxt) {
+          // atan(y, x), mathexpr uses the last two members
+          std::vector<const ROperation*> members;
+          juxt_members(*operation.mmb2, members);
+          const auto lhs_register = compile(*members[members.size() - 2]);
+          return instruction(OpCode::atan2, lhs_register, compile(*members[members.size() - 1]));
+        }
+        return unary(OpCode::atan, *operation.mmb2);
+      default:
+        // ErrOp and functions, which we never pass to mathexpr
+        return constant(ErrVal);
+    }
+  } // ... compile(...)
+
+  //! the registers of the derivatives of reg with respect to each variable
+  std::vector<std::uint32_t> derivative(const std::uint32_t reg)
+  {
+    const auto search = derivatives_.find(reg);
+    if (search != derivatives_.end())
+      return search->second;
+    std::vector<std::uint32_t> ret(variables_.size(), constant(0));
+    if (reg < variables_.size())
+      ret[reg] = constant(1);
+    else if (producers_.count(reg)) {
+      // copy, instructions_ might grow
+      const Instruction instruction = instructions_[producers_[reg]];
+      const auto aa                 = instruction.lhs;
+      const auto bb                 = instruction.rhs;
+      const auto tt                 = instruction.target;
+      const auto da                 = derivative(aa);
+      const auto db                 = derivative(bb);
+      for (size_t ii = 0; ii < variables_.size(); ++ii)
+        ret[ii] = chain_rule(instruction.op, aa, bb, tt, da[ii], db[ii]);
+    }
+    derivatives_[reg] = ret;
+    return ret;
+  } // ... derivative(...)
+
+  size_t num_registers() const
+  {
+    return num_registers_;
+  }
+
+  const std::vector<Instruction>& instructions() const
+  {
+    return instructions_;
+  }
+
+  std::vector<std::pair<std::uint32_t, double>> constants() const
+  {
+    return std::vector<std::pair<std::uint32_t, double>>(constant_values_.begin(), constant_values_.end());
+  }
+
+private:
+  static void juxt_members(const ROperation& operation, std::vector<const ROperation*>& members)
+  {
+    if (operation.op == Juxt) {
+      juxt_members(*operation.mmb1, members);
+      juxt_members(*operation.mmb2, members);
+    } else
+      members.push_back(&operation);
+  }
+
+  std::uint32_t constant(const double value)
+  {
+    // compare the bits, to tell 0 and -0 apart
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const auto search = constant_registers_.find(bits);
+    if (search != constant_registers_.end())
+      return search->second;
+    const auto reg            = new_register();
+    constant_registers_[bits] = reg;
+    constant_values_[reg]     = value;
+    return reg;
+  } // ... constant(...)
+
+  std::uint32_t binary(const OpCode op, const ROperation& lhs, const ROperation& rhs)
+  {
+    const auto lhs_register = compile(lhs);
+    return instruction(op, lhs_register, compile(rhs));
+  }
+
+  std::uint32_t unary(const OpCode op, const ROperation& arg)
+  {
+    const auto arg_register = compile(arg);
+    return instruction(op, arg_register, arg_register);
+  }
+
+  std::uint32_t instruction(const OpCode op, const std::uint32_t lhs, const std::uint32_t rhs)
+  {
+    const auto lhs_value = constant_values_.find(lhs);
+    const auto rhs_value = constant_values_.find(rhs);
+    if (lhs_value != constant_values_.end() && rhs_value != constant_values_.end())
+      return constant(apply(op, lhs_value->second, rhs_value->second));
+    const auto key    = std::make_tuple(op, lhs, rhs);
+    const auto search = common_subexpressions_.find(key);
+    if (search != common_subexpressions_.end())
+      return search->second;
+    const auto reg              = new_register();
+    common_subexpressions_[key] = reg;
+    producers_[reg]             = instructions_.size();
+    instructions_.push_back({op, reg, lhs, rhs});
+    return reg;
+  } // ... instruction(...)
+
+  bool is_constant(const std::uint32_t reg, const double value) const
+  {
+    const auto search = constant_values_.find(reg);
+    return search != constant_values_.end() && search->second == value;
+  }
+
+  // the following simplify trivial terms
+
+  std::uint32_t add(const std::uint32_t lhs, const std::uint32_t rhs)
+  {
+    if (is_constant(lhs, 0))
+      return rhs;
+    if (is_constant(rhs, 0))
+      return lhs;
+    return instruction(OpCode::add, lhs, rhs);
+  }
+
+  std::uint32_t sub(const std::uint32_t lhs, const std::uint32_t rhs)
+  {
+    if (is_constant(rhs, 0))
+      return lhs;
+    if (is_constant(lhs, 0))
+      return neg(rhs);
+    return instruction(OpCode::sub, lhs, rhs);
+  }
+
+  std::uint32_t mul(const std::uint32_t lhs, const std::uint32_t rhs)
+  {
+    if (is_constant(lhs, 0) || is_constant(rhs, 0))
+      return constant(0);
+    if (is_constant(lhs, 1))
+      return rhs;
+    if (is_constant(rhs, 1))
+      return lhs;
+    if (is_constant(lhs, -1))
+      return neg(rhs);
+    if (is_constant(rhs, -1))
+      return neg(lhs);
+    return instruction(OpCode::mul, lhs, rhs);
+  }
+
+  std::uint32_t div(const std::uint32_t lhs, const std::uint32_t rhs)
+  {
+    if (is_constant(lhs, 0))
+      return constant(0);
+    if (is_constant(rhs, 1))
+      return lhs;
+    return instruction(OpCode::div, lhs, rhs);
+  }
+
+  std::uint32_t neg(const std::uint32_t arg)
+  {
+    if (is_constant(arg, 0))
+      return constant(0);
+    return instruction(OpCode::neg, arg, arg);
+  }
+
+  std::uint32_t call(const OpCode op, const std::uint32_t arg)
+  {
+    return instruction(op, arg, arg);
+  }
+
+  //! the derivative of tt = aa op bb (or tt = op bb for unary ops), given the derivatives da and db
+  std::uint32_t chain_rule(const OpCode op, const std::uint32_t aa, const std::uint32_t bb, const std::uint32_t tt,
+                           const std::uint32_t da, const std::uint32_t db)
+  {
+    if (is_constant(db, 0) && (op >= OpCode::neg || is_constant(da, 0)))
+      return constant(0);
+    switch (op) {
+      case OpCode::add:
+        return add(da, db);
+      case OpCode::sub:
+        return sub(da, db);
+      case OpCode::mul:
+        return add(mul(da, bb), mul(aa, db));
+      case OpCode::div:
+        // (da - tt db) / bb
+        return div(sub(da, mul(tt, db)), bb);
+      case OpCode::pow:
+        if (is_constant(db, 0)) {
+          // bb aa^(bb - 1) da
+          const auto exponent = sub(bb, constant(1));
+          const auto power    = is_constant(exponent, 0)
+                                 ? constant(1)
+                                 : (is_constant(exponent, 1) ? aa : instruction(OpCode::pow, aa, exponent));
+          return mul(mul(bb, power), da);
+        }
+        // tt (db ln(aa) + bb da / aa)
+        return mul(tt, add(mul(db, call(OpCode::log, aa)), div(mul(bb, da), aa)));
+      case OpCode::nth_root:
+        // tt = bb^(1 / aa), thus tt (db / (aa bb) - da ln(bb) / aa^2)
+        return mul(tt, sub(div(db, mul(aa, bb)), div(mul(da, call(OpCode::log, bb)), mul(aa, aa))));
+      case OpCode::e10:
+        // tt = aa 10^bb, thus da 10^bb + tt ln(10) db
+        return add(mul(da, instruction(OpCode::pow, constant(10), bb)), mul(mul(tt, constant(std::log(10.))), db));
+      case OpCode::atan2:
+        // tt = atan(aa / bb), thus (bb da - aa db) / (aa^2 + bb^2)
+        return div(sub(mul(bb, da), mul(aa, db)), add(mul(aa, aa), mul(bb, bb)));
+      case OpCode::neg:
+        return neg(db);
+      case OpCode::abs:
+        // sign(bb) db, which is zero at the kink instead of the ErrVal of bb / tt
+        return mul(call(OpCode::sign, bb), db);
+      case OpCode::sqrt:
+        return div(db, mul(constant(2), tt));
+      case OpCode::sin:
+        return mul(call(OpCode::cos, bb), db);
+      case OpCode::cos:
+        return neg(mul(call(OpCode::sin, bb), db));
+      case OpCode::tan:
+        return mul(add(constant(1), mul(tt, tt)), db);
+      case OpCode::log:
+        return div(db, bb);
+      case OpCode::exp:
+        return mul(tt, db);
+      case OpCode::asin:
+        return div(db, call(OpCode::sqrt, sub(constant(1), mul(bb, bb))));
+      case OpCode::acos:
+        return neg(div(db, call(OpCode::sqrt, sub(constant(1), mul(bb, bb)))));
+      case OpCode::atan:
+        return div(db, add(constant(1), mul(bb, bb)));
+    }
+    return constant(ErrVal);
+  } // ... chain_rule(...)
+
+  std::uint32_t new_register()
+  {
+    return std::uint32_t(num_registers_++);
+  }
+
+  const std::vector<RVar*>& variables_;
+  size_t num_registers_;
+  std::vector<Instruction> instructions_;
+  std::map<std::uint32_t, double> constant_values_;
+  std::map<std::uint64_t, std::uint32_t> constant_registers_;
+  std::map<std::tuple<OpCode, std::uint32_t, std::uint32_t>, std::uint32_t> common_subexpressions_;
+  //! register -> index of the instruction writing it
+  std::map<std::uint32_t, size_t> producers_;
+  std::map<std::uint32_t, std::vector<std::uint32_t>> derivatives_;
+}; // class ExpressionBytecode::Compiler
+
+ExpressionBytecode::ExpressionBytecode(const std::string& variable, const size_t num_variables,
+                                       const std::vector<ExpressionsType>& expression_groups,
+                                       const bool derive_first_group)
+  : num_variables_(num_variables)
+{
+  // mathexpr needs the variables to point somewhere
+  std::vector<double> values(num_variables, 0.0);
+  std::vector<std::unique_ptr<RVar>> variables;
+  std::vector<RVar*> variable_ptrs;
+  for (size_t ii = 0; ii < num_variables; ++ii) {
+    const std::string name = variable + "[" + std::to_string(ii) + "]";
+    variables.emplace_back(new RVar(name.c_str(), &values[ii]));
+    variable_ptrs.push_back(variables.back().get());
+  }
+  Compiler compiler(variable_ptrs);
+  for (const auto& expressions : expression_groups) {
+    groups_.emplace_back();
+    for (const auto& expression : expressions) {
+      const ROperation operation(expression.c_str(), int(num_variables), variable_ptrs.data());
+      groups_.back().outputs.push_back(compiler.compile(operation));
+    }
+  }
+  if (derive_first_group && !groups_.empty()) {
+    const auto values = groups_.front().outputs;
+    groups_.emplace_back();
+    for (const auto& value : values)
+      for (const auto& derivative : compiler.derivative(value))
+        groups_.back().outputs.push_back(derivative);
+  }
+  num_registers_ = compiler.num_registers();
+  constants_     = compiler.constants();
+  // each group only runs the instructions its outputs depend on
+  const auto& instructions = compiler.instructions();
+  std::vector<std::ptrdiff_t> producer(num_registers_, -1);
+  for (size_t ii = 0; ii < instructions.size(); ++ii)
+    producer[instructions[ii].target] = ii;
+  for (auto&& group : groups_) {
+    std::vector<bool> needed(instructions.size(), false);
+    std::vector<std::uint32_t> todo(group.outputs);
+    while (!todo.empty()) {
+      const auto reg = todo.back();
+      todo.pop_back();
+      const auto ii = producer[reg];
+      if (ii < 0 || needed[ii])
+        continue;
+      needed[ii] = true;
+      todo.push_back(instructions[ii].lhs);
+      todo.push_back(instructions[ii].rhs);
+    }
+    for (size_t ii = 0; ii < instructions.size(); ++ii)
+      if (needed[ii])
+        group.program.push_back(instructions[ii]);
+  }
+} // ExpressionBytecode(...)
+
+bool ExpressionBytecode::compile_native()
+{
+  if (native_library_)
+    return true;
+#if HAVE_DLFCN_H
+  namespace bfs = boost::filesystem;
+  const std::string source   = native_source();
+  const std::string compiler = environment("DUNE_STUFF_EXPRESSION_JIT_CXX", DUNE_STUFF_EXPRESSION_JIT_CXX);
+  const std::string flags    = environment("DUNE_STUFF_EXPRESSION_JIT_FLAGS", "-O3");
+  std::stringstream name;
+  name << "expression_" << std::hex << stable_hash(compiler + "\n" + flags + "\n" + source);
+  boost::system::error_code error;
+  const bfs::path directory = native_cache_directory();
+  const bfs::path library   = directory / (name.str() + ".so");
+  bfs::create_directories(directory, error);
+  if (!owned_by_current_user(directory))
+    return false;
+  if (!bfs::exists(library, error)) {
+    // several threads or processes might do this at once, so only the final rename may touch library
+    const std::string unique     = bfs::unique_path(name.str() + ".%%%%-%%%%-%%%%").string();
+    const bfs::path source_file  = directory / (unique + ".cc");
+    const bfs::path library_file = directory / (unique + ".so");
+    {
+      std::ofstream file(source_file.string());
+      file << source;
+      if (!file)
+        return false;
+    }
+    const std::string command = "\"" + compiler + "\" " + flags + " -std=c++11 -fPIC -shared -o \""
+                                + library_file.string() + "\" \"" + source_file.string() + "\" > /dev/null 2>&1";
+    const int status = std::system(command.c_str());
+    bfs::remove(source_file, error);
+    if (status != 0) {
+      bfs::remove(library_file, error);
+      return false;
+    }
+    bfs::rename(library_file, library, error);
+    if (error) {
+      bfs::remove(library_file, error);
+      return false;
+    }
+  }
+  void* const handle = ::dlopen(library.string().c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!handle)
+    return false;
+  std::shared_ptr<void> native_library(handle, [](void* ptr) { ::dlclose(ptr); });
+  std::vector<std::pair<NativeFunctionType, NativeFunctionType>> functions;
+  for (size_t gg = 0; gg < groups_.size(); ++gg) {
+    const std::string symbol = "dune_stuff_expression_" + std::to_string(gg);
+    const auto native        = reinterpret_cast<NativeFunctionType>(::dlsym(handle, symbol.c_str()));
+    const auto native_batch  = reinterpret_cast<NativeFunctionType>(::dlsym(handle, (symbol + "_batch").c_str()));
+    if (!native || !native_batch)
+      return false;
+    functions.emplace_back(native, native_batch);
+  }
+  for (size_t gg = 0; gg < groups_.size(); ++gg) {
+    groups_[gg].native       = functions[gg].first;
+    groups_[gg].native_batch = functions[gg].second;
+  }
+  native_library_ = native_library;
+  return true;
+#else // HAVE_DLFCN_H
+  return false;
+#endif // HAVE_DLFCN_H
+} // ... compile_native(...)
+
+bool ExpressionBytecode::is_native() const
+{
+  return bool(native_library_);
+}
+
+/**
+ *  One function per group and one for its batched evaluation, both with the signature of NativeFunctionType. They
+ *  read the variables and write the outputs of the registers, everything else is kept in local variables.
+ */
+std::string ExpressionBytecode::native_source() const
+{
+  std::stringstream source;
+  source << "#include <cfloat>\n#include <cmath>\n#include <limits>\n\nnamespace {\n\n"
+         << "const double ErrVal = DBL_MAX;\n\n" << operations_source << "\n\n";
+  for (const auto& constant : constants_)
+    source << "const double r" << constant.first << " = " << literal(constant.second) << ";\n";
+  source << "\n} // namespace\n";
+  for (size_t gg = 0; gg < groups_.size(); ++gg) {
+    const auto& group = groups_[gg];
+    std::stringstream body;
+    std::vector<bool> computed(num_registers_, false);
+    for (const auto& instruction : group.program) {
+      const auto op = static_cast<size_t>(instruction.op);
+      body << "    const double r" << instruction.target << " = " << operation_name(op) << "(";
+      if (instruction.op < OpCode::neg)
+        body << "r" << instruction.lhs << ", ";
+      body << "r" << instruction.rhs << ");\n";
+      computed[instruction.target] = true;
+    }
+    // variables and constants are already in place
+    for (const auto& output : group.outputs)
+      if (computed[output])
+        body << "    lanes[" << output << " * stride] = r" << output << ";\n";
+    for (const bool batch : {false, true}) {
+      source << "\nextern \"C\" void dune_stuff_expression_" << gg << (batch ? "_batch" : "")
+             << "(double* registers)\n{\n";
+      if (batch)
+        source << "  const unsigned stride = " << batch_size << ";\n  for (unsigned kk = 0; kk < stride; ++kk) {\n"
+               << "    double* const lanes = registers + kk;\n";
+      else
+        source << "  const unsigned stride = 1;\n  {\n    double* const lanes = registers;\n";
+      for (size_t ii = 0; ii < num_variables_; ++ii)
+        source << "    const double r" << ii << " = lanes[" << ii << " * stride];\n";
+      source << body.str() << "  }\n}\n";
+    }
+  }
+  return source.str();
+} // ... native_source(...)
+
+size_t ExpressionBytecode::num_variables() const
+{
+  return num_variables_;
+}
+
+size_t ExpressionBytecode::num_groups() const
+{
+  return groups_.size();
+}
+
+size_t ExpressionBytecode::num_outputs(const size_t group) const
+{
+  return groups_.at(group).outputs.size();
+}
+
+size_t ExpressionBytecode::num_registers() const
+{
+  return num_registers_;
+}
+
+size_t ExpressionBytecode::num_instructions(const size_t group) const
+{
+  return groups_.at(group).program.size();
+}
+
+std::vector<double> ExpressionBytecode::registers() const
+{
+  std::vector<double> ret(num_registers_, 0.0);
+  for (const auto& constant : constants_)
+    ret[constant.first] = constant.second;
+  return ret;
+}
+
+std::vector<double> ExpressionBytecode::batch_registers() const
+{
+  std::vector<double> ret(num_registers_ * batch_size, 0.0);
+  for (const auto& constant : constants_)
+    std::fill_n(ret.begin() + constant.first * batch_size, batch_size, constant.second);
+  return ret;
+}
+
+inline double ExpressionBytecode::apply(const OpCode op, const double lhs, const double rhs)
+{
+  switch (op) {
+    case OpCode::add:
+      return op_add(lhs, rhs);
+    case OpCode::sub:
+      return op_sub(lhs, rhs);
+    case OpCode::mul:
+      return op_mul(lhs, rhs);
+    case OpCode::div:
+      return op_div(lhs, rhs);
+    case OpCode::pow:
+      return op_pow(lhs, rhs);
+    case OpCode::nth_root:
+      return op_nth_root(lhs, rhs);
+    case OpCode::e10:
+      return op_e10(lhs, rhs);
+    case OpCode::atan2:
+      return op_atan2(lhs, rhs);
+    case OpCode::neg:
+      return op_neg(rhs);
+    case OpCode::abs:
+      return op_abs(rhs);
+    case OpCode::sqrt:
+      return op_sqrt(rhs);
+    case OpCode::sin:
+      return op_sin(rhs);
+    case OpCode::cos:
+      return op_cos(rhs);
+    case OpCode::tan:
+      return op_tan(rhs);
+    case OpCode::log:
+      return op_log(rhs);
+    case OpCode::exp:
+      return op_exp(rhs);
+    case OpCode::asin:
+      return op_asin(rhs);
+    case OpCode::acos:
+      return op_acos(rhs);
+    case OpCode::atan:
+      return op_atan(rhs);
+    case OpCode::sign:
+      return op_sign(rhs);
+  }
+  return ErrVal;
+} // ... apply(...)
+
+void ExpressionBytecode::run(const std::vector<Instruction>& program, double* registers)
+{
+  for (const auto& instruction : program)
+    registers[instruction.target] = apply(instruction.op, registers[instruction.lhs], registers[instruction.rhs]);
+}
+
+template <ExpressionBytecode::OpCode op>
+inline void ExpressionBytecode::apply_batch(double* target, const double* lhs, const double* rhs)
+{
+  for (size_t kk = 0; kk < batch_size; ++kk)
+    target[kk] = apply(op, lhs[kk], rhs[kk]);
+}
+
+void ExpressionBytecode::run_batch(const std::vector<Instruction>& program, double* registers)
+{
+  for (const auto& instruction : program) {
+    double* target    = registers + instruction.target * batch_size;
+    const double* lhs = registers + instruction.lhs * batch_size;
+    const double* rhs = registers + instruction.rhs * batch_size;
+    switch (instruction.op) {
+      case OpCode::add:
+        apply_batch<OpCode::add>(target, lhs, rhs);
+        break;
+      case OpCode::sub:
+        apply_batch<OpCode::sub>(target, lhs, rhs);
+        break;
+      case OpCode::mul:
+        apply_batch<OpCode::mul>(target, lhs, rhs);
+        break;
+      case OpCode::div:
+        apply_batch<OpCode::div>(target, lhs, rhs);
+        break;
+      case OpCode::pow:
+        apply_batch<OpCode::pow>(target, lhs, rhs);
+        break;
+      case OpCode::nth_root:
+        apply_batch<OpCode::nth_root>(target, lhs, rhs);
+        break;
+      case OpCode::e10:
+        apply_batch<OpCode::e10>(target, lhs, rhs);
+        break;
+      case OpCode::atan2:
+        apply_batch<OpCode::atan2>(target, lhs, rhs);
+        break;
+      case OpCode::neg:
+        apply_batch<OpCode::neg>(target, lhs, rhs);
+        break;
+      case OpCode::abs:
+        apply_batch<OpCode::abs>(target, lhs, rhs);
+        break;
+      case OpCode::sqrt:
+        apply_batch<OpCode::sqrt>(target, lhs, rhs);
+        break;
+      case OpCode::sin:
+        apply_batch<OpCode::sin>(target, lhs, rhs);
+        break;
+      case OpCode::cos:
+        apply_batch<OpCode::cos>(target, lhs, rhs);
+        break;
+      case OpCode::tan:
+        apply_batch<OpCode::tan>(target, lhs, rhs);
+        break;
+      case OpCode::log:
+        apply_batch<OpCode::log>(target, lhs, rhs);
+        break;
+      case OpCode::exp:
+        apply_batch<OpCode::exp>(target, lhs, rhs);
+        break;
+      case OpCode::asin:
+        apply_batch<OpCode::asin>(target, lhs, rhs);
+        break;
+      case OpCode::acos:
+        apply_batch<OpCode::acos>(target, lhs, rhs);
+        break;
+      case OpCode::atan:
+        apply_batch<OpCode::atan>(target, lhs, rhs);
+        break;
+      case OpCode::sign:
+        apply_batch<OpCode::sign>(target, lhs, rhs);
+        break;
+    }
+  }
+} // ... run_batch(...)
+
+} // namespace Functions
+} // namespace Stuff
+} // namespace Dune
@@ -0,0 +1,222 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#ifndef DUNE_STUFF_FUNCTIONS_EXPRESSION_BYTECODE_HH
+#define DUNE_STUFF_FUNCTIONS_EXPRESSION_BYTECODE_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Dune {
+namespace Stuff {
+namespace Functions {
+
+/**
+ *  \brief Compiles mathexpr expressions (see mathexpr.hh, same syntax) into register bytecode.
+ *
+ *  The results agree with mathexpr up to rounding: mathexpr evaluates the elementary functions in long double (powl,
+ *  sinl, ...), the bytecode in double, so that evaluate_batch() can be vectorized.
+ *
+ *  The expressions are given in groups (e.g. the components of a function and the components of its gradient), all
+ *  of which are compiled into one program: constant subexpressions are folded and common subexpressions (across all
+ *  expressions of all groups) are computed only once. Evaluating a group only runs the instructions it depends on.
+ *
+ *  Register layout: the variables come first, followed by constants and intermediate results (each instruction writes
+ *  its own register). The bytecode is immutable, each thread evaluates it with its own registers(), so there is no
+ *  locking.
+ *
+ *  evaluate_batch() evaluates batch_size points at once, each register then holds one lane per point (structure of
+ *  arrays). Every instruction runs as a loop of fixed length over the lanes, which the compiler vectorizes for the
+ *  instruction set it targets (e.g. -mavx2 or -mavx512f).
+ *
+ *  The derivatives of the first group can be derived symbolically, they then share subexpressions with the values.
+ *
+ *  compile_native() optionally replaces the bytecode by native code, generated from it and compiled at runtime.
+ */
+class ExpressionBytecode
+{
+public:
+  typedef std::vector<std::string> ExpressionsType;
+
+  //! the number of points evaluate_batch() processes at once
+  static const size_t batch_size = 32;
+
+  /**
+   * \param variable the name of the variable, i.e. "x" for expressions in x[0], x[1], ...
+   * \param num_variables the number of components of variable
+   * \param derive_first_group if true, a group with the derivatives of the first group is appended, where the
+   *        derivative of output oo with respect to variable ii is output oo * num_variables + ii
+   */
+  ExpressionBytecode(const std::string& variable, const size_t num_variables,
+                     const std::vector<ExpressionsType>& expression_groups, const bool derive_first_group = false);
+
+  size_t num_variables() const;
+
+  size_t num_groups() const;
+
+  size_t num_outputs(const size_t group = 0) const;
+
+  size_t num_registers() const;
+
+  //! the number of instructions run to evaluate group
+  size_t num_instructions(const size_t group = 0) const;
+
+  /**
+   *  \brief Compiles the program to native code, which evaluate() and evaluate_batch() use afterwards.
+   *
+   *  C++ source is generated from the program and compiled into a shared object with the system compiler. The shared
+   *  object is cached on disk, keyed by a hash of the source, compiler and flags, so the compiler only runs once for
+   *  each set of expressions. The following environment variables are used, if set:
+   *  - DUNE_STUFF_EXPRESSION_JIT_CXX: the compiler (defaults to the one dune-stuff was configured with)
+   *  - DUNE_STUFF_EXPRESSION_JIT_FLAGS: the compiler flags (defaults to "-O3")
+   *  - DUNE_STUFF_EXPRESSION_JIT_CACHE: the cache directory (defaults to $XDG_CACHE_HOME/dune-stuff or
+   *    $HOME/.cache/dune-stuff), which has to be owned by the current user and must not be writable by others
+   *  \return false if native code is not available (no dlopen, no working compiler or an unsafe cache directory), the
+   *          bytecode is used then
+   */
+  bool compile_native();
+
+  bool is_native() const;
+
+  //! the registers to be used in evaluate, with preloaded constants
+  std::vector<double> registers() const;
+
+  //! the registers to be used in evaluate_batch, batch_size lanes per register with preloaded constants
+  std::vector<double> batch_registers() const;
+
+  /**
+   *  \attention arg will be used up to arg_size, ret has to have num_outputs(group) entries
+   *  \note registers has to stem from registers() and must not be used concurrently
+   */
+  template <class ArgType, class RetType>
+  void evaluate(const ArgType& arg, const size_t arg_size, std::vector<double>& registers, RetType& ret,
+                const size_t group = 0) const
+  {
+    assert(group < groups_.size());
+    assert(registers.size() == num_registers_);
+    for (size_t ii = 0; ii < num_variables_; ++ii)
+      registers[ii] = (ii < arg_size) ? double(arg[ii]) : 0.0;
+    if (groups_[group].native)
+      groups_[group].native(registers.data());
+    else
+      run(groups_[group].program, registers.data());
+    const auto& outputs = groups_[group].outputs;
+    for (size_t ii = 0; ii < outputs.size(); ++ii)
+      ret[ii] = registers[outputs[ii]];
+  } // ... evaluate(...)
+
+  /**
+   *  \brief Evaluates group for all args, as evaluate() would for each of them.
+   *  \attention each arg will be used up to arg_size, ret has to have args.size() entries with num_outputs(group)
+   *             entries each
+   *  \note registers has to stem from batch_registers() and must not be used concurrently
+   */
+  template <class ArgType, class RetType>
+  void evaluate_batch(const std::vector<ArgType>& args, const size_t arg_size, std::vector<double>& registers,
+                      std::vector<RetType>& ret, const size_t group = 0) const
+  {
+    assert(group < groups_.size());
+    assert(registers.size() == num_registers_ * batch_size);
+    assert(ret.size() >= args.size());
+    const auto& outputs = groups_[group].outputs;
+    for (size_t first = 0; first < args.size(); first += batch_size) {
+      const size_t count = std::min(batch_size, args.size() - first);
+      for (size_t ii = 0; ii < num_variables_; ++ii) {
+        double* lanes = registers.data() + ii * batch_size;
+        for (size_t kk = 0; kk < count; ++kk)
+          lanes[kk] = (ii < arg_size) ? double(args[first + kk][ii]) : 0.0;
+      }
+      if (groups_[group].native_batch)
+        groups_[group].native_batch(registers.data());
+      else
+        run_batch(groups_[group].program, registers.data());
+      for (size_t ii = 0; ii < outputs.size(); ++ii) {
+        const double* lanes = registers.data() + outputs[ii] * batch_size;
+        for (size_t kk = 0; kk < count; ++kk)
+          ret[first + kk][ii] = lanes[kk];
+      }
+    }
+  } // ... evaluate_batch(...)
+
+private:
+  //! the binary operations come first, sign has no mathexpr counterpart and only occurs in derivatives
+  enum class OpCode : std::uint8_t
+  {
+    add,
+    sub,
+    mul,
+    div,
+    pow,
+    nth_root,
+    e10,
+    atan2,
+    neg,
+    abs,
+    sqrt,
+    sin,
+    cos,
+    tan,
+    log,
+    exp,
+    asin,
+    acos,
+    atan,
+    sign
+  };
+
+  struct Instruction
+  {
+    OpCode op;
+    std::uint32_t target;
+    std::uint32_t lhs;
+    std::uint32_t rhs;
+  };
+
+  typedef void (*NativeFunctionType)(double*);
+
+  struct Group
+  {
+    std::vector<Instruction> program;
+    std::vector<std::uint32_t> outputs;
+    NativeFunctionType native       = nullptr;
+    NativeFunctionType native_batch = nullptr;
+  };
+
+  class Compiler;
+
+  //! same semantics as the respective mathexpr operation, unary operations only use rhs
+  static double apply(const OpCode op, const double lhs, const double rhs);
+
+  static void run(const std::vector<Instruction>& program, double* registers);
+
+  //! apply() for all lanes, the loop is vectorized since op is known at compile time
+  template <OpCode op>
+  static void apply_batch(double* target, const double* lhs, const double* rhs);
+
+  static void run_batch(const std::vector<Instruction>& program, double* registers);
+
+  std::string native_source() const;
+
+  size_t num_variables_;
+  size_t num_registers_;
+  //! register -> value, for the constant registers
+  std::vector<std::pair<std::uint32_t, double>> constants_;
+  std::vector<Group> groups_;
+  //! the handle of the shared object of compile_native(), if any
+  std::shared_ptr<void> native_library_;
+}; // class ExpressionBytecode
+
+} // namespace Functions
+} // namespace Stuff
+} // namespace Dune
+
+#endif // DUNE_STUFF_FUNCTIONS_EXPRESSION_BYTECODE_HH
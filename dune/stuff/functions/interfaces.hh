@@ -12,6 +12,7 @@
 #define DUNE_STUFF_FUNCTION_INTERFACE_HH
 
 #include <vector>
+#include <functional>
 #include <memory>
 #include <string>
 #include <ostream>
@@ -169,6 +170,17 @@ public:
     return entity_;
   }
 
+  /**
+   * \brief Rebinds this to ent, so it can be reused for the next entity instead of allocating a new one (see
+   *        LocalfunctionPool).
+   * \return false if rebinding is not supported (the default), this is left untouched then
+   * \note   Implementations have to call set_entity() and update everything that depends on the entity.
+   */
+  virtual bool bind(const EntityType& /*ent*/)
+  {
+    return false;
+  }
+
   /**
    * \defgroup haveto ´´These methods have to be implemented.''
    * @{
@@ -218,7 +230,13 @@ protected:
 #endif
   }
 
-  const EntityType& entity_;
+  void set_entity(const EntityType& ent)
+  {
+    entity_ = std::cref(ent);
+  }
+
+  //! rebindable (see bind()), but still converts to const EntityType&
+  std::reference_wrapper<const EntityType> entity_;
 }; // class LocalfunctionSetInterface
 
 /**
@@ -299,8 +317,12 @@ public:
     return ret;
   }
 
-  //! evaluate at N quadrature points into vector of size >= N
-  void evaluate(const Dune::QuadratureRule<DomainFieldType, dimDomain>& quadrature, std::vector<RangeType>& ret)
+  /**
+   * \brief evaluate at N quadrature points into vector of size >= N
+   * \note  Calls evaluate() for each point, implementations which can evaluate many points at once should override.
+   */
+  virtual void evaluate(const Dune::QuadratureRule<DomainFieldType, dimDomain>& quadrature,
+                        std::vector<RangeType>& ret) const
   {
     assert(ret.size() >= quadrature.size());
     std::size_t i = 0;
@@ -468,6 +490,8 @@ class GlobalFunctionInterface
 
 public:
   typedef typename BaseType::LocalfunctionType LocalfunctionType;
+  using typename BaseType::DomainFieldType;
+  using BaseType::dimDomain;
   typedef typename BaseType::DomainType DomainType;
   typedef typename BaseType::RangeType RangeType;
   typedef typename BaseType::JacobianRangeType JacobianRangeType;
@@ -492,6 +516,20 @@ public:
     return ret;
   }
 
+  //! evaluate at N points into vector of size >= N, used by the local functions for quadratures
+  virtual void evaluate(const std::vector<DomainType>& xx, std::vector<RangeType>& ret) const
+  {
+    assert(ret.size() >= xx.size());
+    for (size_t ii = 0; ii < xx.size(); ++ii)
+      evaluate(xx[ii], ret[ii]);
+  }
+
+  //! whether the local functions should collect the points of a quadrature for evaluate(std::vector< DomainType >)
+  virtual bool supports_batch() const
+  {
+    return false;
+  }
+
   virtual JacobianRangeType jacobian(const DomainType& xx) const
   {
     JacobianRangeType ret;
@@ -535,6 +573,23 @@ private:
       global_function_.evaluate(xx_global, ret);
     }
 
+    virtual void evaluate(const Dune::QuadratureRule<DomainFieldType, dimDomain>& quadrature,
+                          std::vector<RangeType>& ret) const override final
+    {
+      assert(ret.size() >= quadrature.size());
+      size_t ii = 0;
+      if (!global_function_.supports_batch()) {
+        for (const auto& point : quadrature)
+          global_function_.evaluate(geometry_.global(point.position()), ret[ii++]);
+        return;
+      }
+      // keeps its capacity for all entities this local function is bound to
+      points_global_.resize(quadrature.size());
+      for (const auto& point : quadrature)
+        points_global_[ii++] = geometry_.global(point.position());
+      global_function_.evaluate(points_global_, ret);
+    } // ... evaluate(...)
+
     virtual void jacobian(const DomainType& xx, JacobianRangeType& ret) const override final
     {
       const auto xx_global = geometry_.global(xx);
@@ -546,9 +601,17 @@ private:
       return global_function_.order();
     }
 
+    virtual bool bind(const EntityImp& entity_in) override final
+    {
+      this->set_entity(entity_in);
+      geometry_ = entity_in.geometry();
+      return true;
+    }
+
   private:
-    const typename EntityImp::Geometry geometry_;
+    typename EntityImp::Geometry geometry_;
     const ThisType& global_function_;
+    mutable std::vector<DomainType> points_global_;
   }; // class Localfunction
 
 public:
@@ -631,6 +694,20 @@ public:
     return ret;
   }
 
+  //! evaluate at N points into vector of size >= N, used by the local functions for quadratures
+  virtual void evaluate(const std::vector<DomainType>& xx, std::vector<RangeType>& ret) const
+  {
+    assert(ret.size() >= xx.size());
+    for (size_t ii = 0; ii < xx.size(); ++ii)
+      evaluate(xx[ii], ret[ii]);
+  }
+
+  //! whether the local functions should collect the points of a quadrature for evaluate(std::vector< DomainType >)
+  virtual bool supports_batch() const
+  {
+    return false;
+  }
+
   virtual JacobianRangeType jacobian(const DomainType& xx) const
   {
     JacobianRangeType ret;
@@ -670,6 +747,23 @@ private:
       global_function_.evaluate(xx_global, ret);
     }
 
+    virtual void evaluate(const Dune::QuadratureRule<DomainFieldType, dimDomain>& quadrature,
+                          std::vector<RangeType>& ret) const override final
+    {
+      assert(ret.size() >= quadrature.size());
+      size_t ii = 0;
+      if (!global_function_.supports_batch()) {
+        for (const auto& point : quadrature)
+          global_function_.evaluate(geometry_.global(point.position()), ret[ii++]);
+        return;
+      }
+      // keeps its capacity for all entities this local function is bound to
+      points_global_.resize(quadrature.size());
+      for (const auto& point : quadrature)
+        points_global_[ii++] = geometry_.global(point.position());
+      global_function_.evaluate(points_global_, ret);
+    } // ... evaluate(...)
+
     virtual void jacobian(const DomainType& xx, JacobianRangeType& ret) const override final
     {
       const auto xx_global = geometry_.global(xx);
@@ -681,9 +775,17 @@ private:
       return global_function_.order();
     }
 
+    virtual bool bind(const EntityImp& entity_in) override final
+    {
+      this->set_entity(entity_in);
+      geometry_ = entity_in.geometry();
+      return true;
+    }
+
   private:
-    const typename EntityImp::Geometry geometry_;
+    typename EntityImp::Geometry geometry_;
     const ThisType& global_function_;
+    mutable std::vector<DomainType> points_global_;
   }; // class Localfunction
 
 public:
@@ -0,0 +1,77 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#ifndef DUNE_STUFF_FUNCTIONS_LOCALFUNCTION_POOL_HH
+#define DUNE_STUFF_FUNCTIONS_LOCALFUNCTION_POOL_HH
+
+#include <memory>
+
+#include <boost/noncopyable.hpp>
+
+#include <dune/stuff/common/parallel/threadstorage.hh>
+
+#include "interfaces.hh"
+
+namespace Dune {
+namespace Stuff {
+namespace Functions {
+
+/**
+ * \brief Provides one local function of a localizable function per thread, which is rebound to each entity.
+ *
+ *        local_function() allocates a new local function for every entity, which shows up in assemblies (and gets
+ *        worse with more threads, due to contention in malloc). bind() instead reuses the local function of the
+ *        calling thread, only the first call on each thread allocates. Local functions which do not support
+ *        rebinding (see LocalfunctionSetInterface::bind()) are replaced by a new one, as before.
+\code
+LocalfunctionPool<FunctionType> local_functions(function);
+for (const auto& entity : DSC::entityRange(grid_view)) {
+  const auto& local_function = local_functions.bind(entity);
+  ...
+}
+\endcode
+ * \note The local function returned by bind() is only valid until the next call of bind() on the same thread.
+ */
+template <class FunctionImp>
+class LocalfunctionPool : public boost::noncopyable
+{
+  static_assert(is_localizable_function<FunctionImp>::value, "FunctionImp has to be a LocalizableFunction!");
+
+public:
+  typedef FunctionImp FunctionType;
+  typedef typename FunctionType::EntityType EntityType;
+  typedef typename FunctionType::LocalfunctionType LocalfunctionType;
+
+  explicit LocalfunctionPool(const FunctionType& function)
+    : function_(function)
+  {
+  }
+
+  const LocalfunctionType& bind(const EntityType& entity) const
+  {
+    auto& local_function = *local_functions_;
+    if (!local_function || !local_function->bind(entity))
+      local_function = function_.local_function(entity);
+    return *local_function;
+  } // ... bind(...)
+
+  const FunctionType& function() const
+  {
+    return function_;
+  }
+
+private:
+  const FunctionType& function_;
+  //! PerThreadValue copies its initial value for each thread, so this cannot be a unique_ptr
+  mutable PerThreadValue<std::shared_ptr<LocalfunctionType>> local_functions_;
+}; // class LocalfunctionPool
+
+} // namespace Functions
+} // namespace Stuff
+} // namespace Dune
+
+#endif // DUNE_STUFF_FUNCTIONS_LOCALFUNCTION_POOL_HH
@@ -11,9 +11,14 @@
 #ifndef DUNE_STUFF_FUNCTION_RandomEllipsoidsFunction_HH
 #define DUNE_STUFF_FUNCTION_RandomEllipsoidsFunction_HH
 
-#include <vector>
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
 #include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include <dune/common/exceptions.hh>
 
@@ -46,12 +51,138 @@ struct Ellipsoid
     }
     return DSC::FloatCmp::le(sum, 1.);
   }
-  bool intersects_cube(DomainType /*ll*/, DomainType /*ur*/) const
+
+  //! whether the ellipsoid intersects the axis-aligned box [ll, ur]
+  bool intersects_cube(const DomainType& ll, const DomainType& ur) const
   {
-    DUNE_THROW(NotImplemented, "");
+    // scaling each axis by 1/radius turns the ellipsoid into the unit ball and the box into another box, so the point of
+    // the box closest to the center decides
+    double sum = 0;
+    for (auto ii : DSC::valueRange(dim)) {
+      const auto closest = std::min(std::max(center[ii], ll[ii]), ur[ii]);
+      sum += std::pow((closest - center[ii]) / radii[ii], 2);
+    }
+    return DSC::FloatCmp::le(sum, 1.);
   }
 };
 
+namespace internal {
+
+/**
+ * \brief Bounding volume hierarchy over ellipsoids, finds the ones intersecting a box in logarithmic time.
+ *
+ *        The tree is built top down, each node is split at the median center along the axis in which the centers are
+ *        spread the most, until at most leaf_size ellipsoids are left. The nodes are stored in depth first order, so
+ *        the left child of a node directly follows it.
+ */
+template <size_t dim, class CoordType>
+class EllipsoidTree
+{
+public:
+  typedef Ellipsoid<dim, CoordType> EllipsoidType;
+  typedef typename EllipsoidType::DomainType DomainType;
+
+  static const size_t leaf_size = 8;
+
+  explicit EllipsoidTree(std::vector<EllipsoidType> ellipsoids = std::vector<EllipsoidType>())
+    : ellipsoids_(std::move(ellipsoids))
+  {
+    if (!ellipsoids_.empty()) {
+      nodes_.reserve(2 * (ellipsoids_.size() / leaf_size + 1));
+      build(0, ellipsoids_.size());
+    }
+  }
+
+  size_t size() const
+  {
+    return ellipsoids_.size();
+  }
+
+  //! appends the ellipsoids intersecting the box [lower_left, upper_right] to ret
+  void intersecting(const DomainType& lower_left, const DomainType& upper_right, std::vector<EllipsoidType>& ret) const
+  {
+    if (nodes_.empty())
+      return;
+    std::vector<size_t> stack(1, 0);
+    while (!stack.empty()) {
+      const size_t index = stack.back();
+      stack.pop_back();
+      const auto& node = nodes_[index];
+      bool overlaps = true;
+      for (size_t ii = 0; ii < dim; ++ii)
+        overlaps = overlaps && node.lower[ii] <= upper_right[ii] && lower_left[ii] <= node.upper[ii];
+      if (!overlaps)
+        continue;
+      if (node.count > 0) {
+        for (size_t ii = node.first; ii < node.first + node.count; ++ii)
+          if (ellipsoids_[ii].intersects_cube(lower_left, upper_right))
+            ret.push_back(ellipsoids_[ii]);
+      } else {
+        stack.push_back(node.right);
+        stack.push_back(index + 1);
+      }
+    }
+  } // ... intersecting(...)
+
+private:
+  struct Node
+  {
+    //! the bounding box of all ellipsoids below this node
+    DomainType lower;
+    DomainType upper;
+    //! the ellipsoids of a leaf are [first, first + count), count is 0 for inner nodes
+    size_t first;
+    size_t count;
+    size_t right;
+  };
+
+  size_t build(const size_t first, const size_t last)
+  {
+    const size_t index = nodes_.size();
+    nodes_.emplace_back();
+    Node node;
+    node.first = first;
+    node.count = last - first;
+    node.right = 0;
+    node.lower = std::numeric_limits<CoordType>::max();
+    node.upper = std::numeric_limits<CoordType>::lowest();
+    DomainType centers_lower(std::numeric_limits<CoordType>::max());
+    DomainType centers_upper(std::numeric_limits<CoordType>::lowest());
+    for (size_t ii = first; ii < last; ++ii) {
+      const auto& ellipsoid = ellipsoids_[ii];
+      for (size_t dd = 0; dd < dim; ++dd) {
+        node.lower[dd]    = std::min(node.lower[dd], ellipsoid.center[dd] - ellipsoid.radii[dd]);
+        node.upper[dd]    = std::max(node.upper[dd], ellipsoid.center[dd] + ellipsoid.radii[dd]);
+        centers_lower[dd] = std::min(centers_lower[dd], ellipsoid.center[dd]);
+        centers_upper[dd] = std::max(centers_upper[dd], ellipsoid.center[dd]);
+      }
+    }
+    if (last - first > leaf_size) {
+      size_t axis = 0;
+      for (size_t dd = 1; dd < dim; ++dd)
+        if (centers_upper[dd] - centers_lower[dd] > centers_upper[axis] - centers_lower[axis])
+          axis = dd;
+      const size_t middle = first + (last - first) / 2;
+      std::nth_element(ellipsoids_.begin() + first,
+                       ellipsoids_.begin() + middle,
+                       ellipsoids_.begin() + last,
+                       [axis](const EllipsoidType& left, const EllipsoidType& right) {
+                         return left.center[axis] < right.center[axis];
+                       });
+      node.count = 0;
+      build(first, middle);
+      node.right = build(middle, last);
+    }
+    nodes_[index] = node;
+    return index;
+  } // ... build(...)
+
+  std::vector<EllipsoidType> ellipsoids_;
+  std::vector<Node> nodes_;
+}; // class EllipsoidTree
+
+} // namespace internal
+
 template <class EntityImp, class DomainFieldImp, size_t domainDim, class RangeFieldImp, size_t rangeDim,
           size_t rangeDimCols = 1>
 class RandomEllipsoidsFunction
@@ -73,6 +204,11 @@ public:
   typedef typename BaseType::RangeFieldType RangeFieldType;
   typedef typename BaseType::RangeType RangeType;
   typedef Ellipsoid<dimDomain, DomainFieldType> EllipsoidType;
+
+private:
+  typedef internal::EllipsoidTree<dimDomain, DomainFieldType> TreeType;
+
+public:
   class Localfunction
       : public LocalfunctionInterface<EntityImp, DomainFieldImp, domainDim, RangeFieldImp, rangeDim, rangeDimCols>
   {
@@ -91,7 +227,7 @@ public:
       : BaseType(ent)
       , geometry_(ent.geometry())
       , value_(value)
-      , local_ellipsoids_(local_ellipsoids)
+      , local_ellipsoids_(std::move(local_ellipsoids))
     {
       //      DSC_LOG_DEBUG_0 << "create local LF Ellips with " << local_ellipsoids_.size() << " instances\n";
     }
@@ -174,7 +310,7 @@ public:
     typedef unsigned long UL;
     const UL level_0_count = ellipsoid_cfg.get("ellipsoids.count", 10);
     const UL max_depth     = ellipsoid_cfg.get("ellipsoids.recursion_depth", 1);
-    const UL children      = ellipsoid_cfg.get<UL>("ellipsoids.children", 3u); //, DSC::ValidateLess<UL>(0));
+    const UL children      = ellipsoid_cfg.get("ellipsoids.children", UL(3)); //, DSC::ValidateLess<UL>(0));
     const UL total_count = level_0_count + level_0_count * std::pow(children, max_depth + 1);
     ellipsoids_.resize(level_0_count);
     ellipsoids_.reserve(total_count);
@@ -216,6 +352,7 @@ public:
     for (auto ii : parent_range) {
       recurse_add(0, ellipsoids_[ii]);
     }
+    tree_ = TreeType(ellipsoids_);
     DSC_LOG_DEBUG_0 << "generated " << ellipsoids_.size() << " of " << total_count << "\n";
     to_file(*DSC::make_ofstream("ellipsoids.txt"));
   }
@@ -249,7 +386,7 @@ public:
   }
 
 private:
-  std::tuple<typename EllipsoidType::DomainType, typename EllipsoidType::DomainType>
+  std::pair<typename EllipsoidType::DomainType, typename EllipsoidType::DomainType>
   bounding_box(const EntityType& entity) const
   {
     typename EllipsoidType::DomainType ll, ur;
@@ -264,34 +401,20 @@ private:
     for (auto ii : DSC::valueRange(dimDomain)) {
       ll[ii] = coord_limits[ii].min();
       ur[ii] = coord_limits[ii].max();
-
-      return std::make_pair(std::move(ll), std::move(ur));
     }
-  }
+    return std::make_pair(std::move(ll), std::move(ur));
+  } // ... bounding_box(...)
 
 public:
   virtual std::unique_ptr<LocalfunctionType> local_function(const EntityType& entity) const override
   {
-    const auto local_value = DomainFieldType(ellipsoid_cfg_.get("ellipsoids.local_value", 1.));
-    // decide on the subdomain the center of the entity belongs to
-    const auto max_radius = ellipsoid_cfg_.get("ellipsoids.max_radius", 0.04);
+    const RangeType local_value(ellipsoid_cfg_.get("ellipsoids.local_value", 1.));
+    // only the ellipsoids intersecting the bounding box of the entity can contain any of its points
     typename EllipsoidType::DomainType ll, ur;
     std::tie(ll, ur) = bounding_box(entity);
-    std::for_each(ll.begin(), ll.end(), [&max_radius](DomainFieldType& lc) { lc -= 1.1 * max_radius; });
-    std::for_each(ur.begin(), ur.end(), [&max_radius](DomainFieldType& uc) { uc += 1.1 * max_radius; });
     std::vector<EllipsoidType> local_ellipsoids;
-    for (const auto& ellipsoid : ellipsoids_) {
-      bool inside = true;
-      for (auto ii : DSC::valueRange(dimDomain)) {
-        inside = inside && DSC::FloatCmp::ge(ellipsoid.center[ii], ll[ii]);
-        inside = inside && DSC::FloatCmp::le(ellipsoid.center[ii], ur[ii]);
-      }
-      if (inside) {
-        local_ellipsoids.push_back(ellipsoid);
-      }
-    }
-    std::vector<EllipsoidType> tmp = ellipsoids_;
-    return std::unique_ptr<Localfunction>(new Localfunction(entity, local_value, std::move(tmp)));
+    tree_.intersecting(ll, ur, local_ellipsoids);
+    return std::unique_ptr<Localfunction>(new Localfunction(entity, local_value, std::move(local_ellipsoids)));
   } // ... local_function(...)
 
 private:
@@ -300,6 +423,7 @@ private:
   const std::string name_;
   const Stuff::Common::Configuration ellipsoid_cfg_;
   std::vector<EllipsoidType> ellipsoids_;
+  TreeType tree_;
 }; // class RandomEllipsoidsFunction
 
 } // namespace Functions
@@ -15,6 +15,9 @@
 
 #include <dune/stuff/common/exceptions.hh>
 #include <dune/stuff/common/configuration.hh>
+#include <dune/stuff/common/mapped_binary_cache.hh>
+#include <dune/stuff/common/memory.hh>
+#include <dune/stuff/common/shared_memory.hh>
 #include <dune/stuff/common/color.hh>
 #include <dune/stuff/common/string.hh>
 #include <dune/stuff/common/fvector.hh>
@@ -67,34 +70,47 @@ public:
   } // ... static_id(...)
 
 private:
-  static std::vector<RangeType> read_values_from_file(const std::string& filename, const RangeFieldType& min,
-                                                      const RangeFieldType& max, const RangeType& unit_range)
+  static const size_t entriesPerDim = model1_x_elements * model1_y_elements * model1_z_elements;
 
+  static void read_values_from_file(const std::string& filename, const RangeFieldType& min, const RangeFieldType& max,
+                                    const RangeType& unit_range, RangeType* data)
   {
-    if (!(max > min))
-      DUNE_THROW(Dune::RangeError, "max (is " << max << ") has to be larger than min (is " << min << ")!");
     const RangeFieldType scale = (max - min) / (internal::model1_max_value - internal::model1_min_value);
     const RangeFieldType shift = min - scale * internal::model1_min_value;
-    // read all the data from the file
-    std::ifstream datafile(filename);
-    if (datafile.is_open()) {
-      static const size_t entriesPerDim = model1_x_elements * model1_y_elements * model1_z_elements;
-      // create storage (there should be exactly 6000 values in the file, but we onyl read the first 2000)
-      std::vector<RangeType> data(entriesPerDim, unit_range);
-      double tmp     = 0;
-      size_t counter = 0;
-      while (datafile >> tmp && counter < entriesPerDim)
-        data[counter++] *= (tmp * scale) + shift;
-      datafile.close();
-      if (counter != entriesPerDim)
-        DUNE_THROW(Dune::IOError,
-                   "wrong number of entries in '" << filename << "' (are " << counter << ", should be " << entriesPerDim
-                                                  << ")!");
-      return data;
-    } else
+    // read all the data from the file (or its binary cache)
+    std::unique_ptr<const Common::MappedBinaryCache> values;
+    try {
+      values = Common::make_unique<const Common::MappedBinaryCache>(filename);
+    } catch (Dune::IOError&) {
       DUNE_THROW(Exceptions::spe10_data_file_missing, "could not open '" << filename << "'!");
+    }
+    // there should be exactly 6000 values in the file, but we only use the first 2000
+    if (values->size() < entriesPerDim)
+      DUNE_THROW(Dune::IOError,
+                 "wrong number of entries in '" << filename << "' (are " << values->size() << ", should be "
+                                                << entriesPerDim
+                                                << ")!");
+    for (size_t ii = 0; ii < entriesPerDim; ++ii) {
+      data[ii] = unit_range;
+      data[ii] *= ((*values)[ii] * scale) + shift;
+    }
   } // ... read_values_from_file(...)
 
+  //! the values are computed once per node and shared by all functions and processes using the same file and range
+  static std::shared_ptr<const RangeType> shared_values(const std::string& filename, const RangeFieldType& min,
+                                                        const RangeFieldType& max, const RangeType& unit_range)
+  {
+    if (!(max > min))
+      DUNE_THROW(Dune::RangeError, "max (is " << max << ") has to be larger than min (is " << min << ")!");
+    std::string key = static_id() + "\n" + Common::SharedMemorySegment::file_key(filename) + "\n";
+    for (const auto* parameter : {&min, &max})
+      key.append(reinterpret_cast<const char*>(parameter), sizeof(RangeFieldType));
+    key.append(reinterpret_cast<const char*>(&unit_range), sizeof(RangeType));
+    return Common::make_shared_array<RangeType>(key, entriesPerDim, [&](RangeType* data) {
+      read_values_from_file(filename, min, max, unit_range, data);
+    });
+  } // ... shared_values(...)
+
 public:
   static Common::Configuration default_config(const std::string sub_name = "")
   {
@@ -133,7 +149,7 @@ public:
   Model1Base(const std::string& filename, const DomainType& lowerLeft, const DomainType& upperRight,
              const RangeFieldType min, const RangeFieldType max, const std::string nm, const RangeType& unit_range)
     : BaseType(lowerLeft, upperRight, {model1_x_elements, model1_z_elements},
-               read_values_from_file(filename, min, max, unit_range), nm)
+               shared_values(filename, min, max, unit_range), entriesPerDim, nm)
   {
   }
 
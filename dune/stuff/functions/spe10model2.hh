@@ -13,6 +13,8 @@
 
 #include <dune/stuff/common/exceptions.hh>
 #include <dune/stuff/common/configuration.hh>
+#include <dune/stuff/common/mapped_binary_cache.hh>
+#include <dune/stuff/common/memory.hh>
 #include <dune/stuff/common/color.hh>
 #include <dune/stuff/common/string.hh>
 #include <dune/stuff/common/fvector.hh>
@@ -37,14 +39,19 @@ class Model2 : public Stuff::GlobalFunctionInterface<EntityImp, DomainFieldImp,
   typedef Stuff::GlobalFunctionInterface<EntityImp, DomainFieldImp, dim_domain, RangeFieldImp, r, rC> BaseType;
 
 public:
+  /**
+   * \param single_precision store the permeability as float, which halves the size of the binary cache
+   * \see Common::MappedBinaryCache, the data is parsed once into a binary cache beside data_filename and mapped
+   */
   Model2(std::string data_filename = "perm_case2a.dat",
-         DSC::FieldVector<double, dim_domain> upper_right = default_upper_right)
+         DSC::FieldVector<double, dim_domain> upper_right = default_upper_right, const bool single_precision = false)
     : deltas_{{upper_right[0] / num_elements[0], upper_right[1] / num_elements[1], upper_right[2] / num_elements[2]}}
     , permeability_(nullptr)
     , permMatrix_(0.0)
     , filename_(data_filename)
   {
-    readPermeability();
+    readPermeability(single_precision ? Common::MappedBinaryCache::Precision::float32
+                                      : Common::MappedBinaryCache::Precision::float64);
   }
 
   static const DSC::FieldVector<double, dim_domain> default_upper_right;
@@ -53,8 +60,6 @@ public:
 
   virtual ~Model2()
   {
-    delete permeability_;
-    permeability_ = nullptr;
   }
 
   //! currently used in gdt assembler
@@ -80,7 +85,7 @@ public:
                        + permIntervalls_[2] * num_elements[1] * num_elements[0];
     for (size_t dim = 0; dim < dim_domain; ++dim) {
       const auto idx      = offset + dim * 1122000;
-      diffusion[dim][dim] = permeability_[idx];
+      diffusion[dim][dim] = (*permeability_)[idx];
     }
   }
 
@@ -90,26 +95,21 @@ public:
   }
 
 private:
-  void readPermeability()
+  void readPermeability(const Common::MappedBinaryCache::Precision precision)
   {
-    std::ifstream file(filename_);
-    double val;
-    if (!file) { // file couldn't be opened
+    try {
+      permeability_ = Common::make_unique<const Common::MappedBinaryCache>(filename_, precision);
+    } catch (IOError&) { // file couldn't be opened
       return;
     }
-    file >> val;
-    int counter   = 0;
-    permeability_ = new double[3366000];
-    while (!file.eof()) {
-      // keep reading until end-of-file
-      permeability_[counter++] = val;
-      file >> val; // sets EOF flag if no value found
-    }
-    file.close();
+    if (permeability_->size() < 3366000)
+      DUNE_THROW(IOError,
+                 "wrong number of entries in '" << filename_ << "' (are " << permeability_->size()
+                                                << ", should be 3366000)!");
   }
 
   std::array<double, dim_domain> deltas_;
-  double* permeability_; //! TODO automatic memory
+  std::unique_ptr<const Common::MappedBinaryCache> permeability_;
   mutable typename BaseType::DomainType permIntervalls_;
   mutable Dune::FieldMatrix<double, BaseType::DomainType::dimension, BaseType::DomainType::dimension> permMatrix_;
   const std::string filename_;
@@ -145,9 +145,7 @@ struct Dimensions
   Dimensions(const GridViewType& gridView)
   {
     GridDimensionsFunctor f(coord_limits, entity_volume, entity_width);
-    Walker<GridViewType> gw(gridView);
-    gw.add(f);
-    gw.walk();
+    make_static_walker(gridView, f).walk();
   }
 
   Dimensions(const EntityType& entity)
@@ -15,9 +15,12 @@
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <cassert>
 #include <type_traits>
 #include <functional>
 
+#include <dune/common/unused.hh>
 #include <dune/common/version.hh>
 
 #if HAVE_TBB
@@ -26,21 +29,29 @@
 #include <dune/stuff/common/parallel/threadmanager.hh>
 #endif // DUNE_VERSION_NEWER(DUNE_COMMON, 3, 9)
 
-#include <tbb/blocked_range.h>
-#include <tbb/parallel_reduce.h>
-#include <tbb/tbb_stddef.h>
+#include <tbb/parallel_invoke.h>
 #endif // HAVE_TBB
 
+#if HAVE_LIKWID && ENABLE_PERFMON
+#include <likwid.h>
+#include <dune/stuff/common/profiler.hh>
+#include <dune/stuff/common/parallel/threadstorage.hh>
+#endif
+
 #include <dune/stuff/grid/entity.hh>
 #include <dune/stuff/grid/intersection.hh>
 #include <dune/stuff/grid/layers.hh>
+#include <dune/stuff/common/configuration.hh>
+#include <dune/stuff/common/memory.hh>
 #include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/common/type_utils.hh>
 #include <dune/stuff/common/parallel/threadmanager.hh>
-#include <dune/stuff/common/ranges.hh>
 
 #include "walker/functors.hh"
 #include "walker/apply-on.hh"
 #include "walker/wrapper.hh"
+#include "walker/partitioning.hh"
+#include "walker/static.hh"
 
 namespace Dune {
 namespace Stuff {
@@ -85,12 +96,35 @@ struct GridPartViewHolder<GPV, false>
   const type grid_part_;
 };
 
+#if HAVE_LIKWID && ENABLE_PERFMON
+//! registers the calling thread with the marker API, once per thread
+inline void likwid_marker_thread_init()
+{
+  static PerThreadValue<bool> initialized(false);
+  if (!*initialized) {
+    LIKWID_MARKER_THREADINIT;
+    *initialized = true;
+  }
+}
+#endif // HAVE_LIKWID && ENABLE_PERFMON
+
 } // namespace internal
 
+/**
+ *  \brief Walks a grid view and applies all registered functors on each entity and intersection.
+ *
+ *         For a parallel walk (see walk(true) and walk(partitioning)) the partitions are processed by recursive
+ *         bisection, each second half being processed by a copy of the walker (and of all functors which support
+ *         copying, see Functor::Codim0::copy()). These copies are joined in a fixed order afterwards, so the results
+ *         are reproducible for a fixed number of partitions, independently of the number of threads or their
+ *         scheduling.
+ */
 template <class GridViewImp>
 class Walker : internal::GridPartViewHolder<GridViewImp>, public Functor::Codim0And1<GridViewImp>
 {
   typedef Walker<GridViewImp> ThisType;
+  typedef Functor::Codim0And1<GridViewImp> FunctorBaseType;
+  typedef typename internal::GridPartViewHolder<GridViewImp>::type RealGridViewType;
 
 public:
   typedef GridViewImp GridViewType;
@@ -99,7 +133,26 @@ public:
 
   explicit Walker(GridViewType grd_vw)
     : internal::GridPartViewHolder<GridViewImp>(grd_vw)
+    , ownership_cache_(nullptr)
+    , ownership_(nullptr)
+  {
+  }
+
+  /**
+   * \brief Copies other and all its functors, where supported (see Functor::Codim0::copy()).
+   * \note  Used by the parallel walk, copies which are not supported are shared with other.
+   */
+  Walker(const ThisType& other, internal::FunctorCopiesType& copies)
+    : internal::GridPartViewHolder<GridViewImp>(other.grid_view_)
+    , ownership_cache_(other.ownership_cache_)
+    , ownership_(other.ownership_)
   {
+    for (const auto& functor : other.codim0_functors_)
+      codim0_functors_.emplace_back(functor->copy(copies));
+    for (const auto& functor : other.codim1_functors_)
+      codim1_functors_.emplace_back(functor->copy(copies));
+    for (const auto& functor : other.codim1_once_functors_)
+      codim1_once_functors_.emplace_back(functor->copy(copies));
   }
 
   const GridViewType& grid_view() const
@@ -108,84 +161,131 @@ public:
   }
 
   ThisType& add(std::function<void(const EntityType&)> lambda,
-                const ApplyOn::WhichEntity<GridViewType>* where = new ApplyOn::AllEntities<GridViewType>())
+                const ApplyOn::WhichEntity<GridViewType>* where = nullptr)
   {
-    codim0_functors_.emplace_back(new internal::Codim0LambdaWrapper<GridViewType>(lambda, where));
+    push_back(new internal::Codim0LambdaWrapper<GridViewType>(lambda, where), lambda);
     return *this;
   }
 
   ThisType& add(std::function<void(const IntersectionType&, const EntityType&, const EntityType&)> lambda,
-                const ApplyOn::WhichIntersection<GridViewType>* where = new ApplyOn::AllIntersections<GridViewType>())
+                const ApplyOn::WhichIntersection<GridViewType>* where = nullptr)
   {
-    codim1_functors_.emplace_back(new internal::Codim1LambdaWrapper<GridViewType>(lambda, where));
+    push_back(new internal::Codim1LambdaWrapper<GridViewType>(lambda, where), lambda);
     return *this;
   }
 
-  ThisType& add(Functor::Codim0<GridViewType>& functor,
-                const ApplyOn::WhichEntity<GridViewType>* where = new ApplyOn::AllEntities<GridViewType>())
+  ThisType& add(Functor::Codim0<GridViewType>& functor, const ApplyOn::WhichEntity<GridViewType>* where = nullptr)
   {
-    codim0_functors_.emplace_back(
-        new internal::Codim0FunctorWrapper<GridViewType, Functor::Codim0<GridViewType>>(functor, where));
+    push_back(new internal::Codim0FunctorWrapper<GridViewType, Functor::Codim0<GridViewType>>(functor, where),
+              functor);
     return *this;
   }
 
-  ThisType& add(Functor::Codim1<GridViewType>& functor,
-                const ApplyOn::WhichIntersection<GridViewType>* where = new ApplyOn::AllIntersections<GridViewType>())
+  ThisType& add(Functor::Codim1<GridViewType>& functor, const ApplyOn::WhichIntersection<GridViewType>* where = nullptr)
   {
-    codim1_functors_.emplace_back(
-        new internal::Codim1FunctorWrapper<GridViewType, Functor::Codim1<GridViewType>>(functor, where));
+    push_back(new internal::Codim1FunctorWrapper<GridViewType, Functor::Codim1<GridViewType>>(functor, where),
+              functor);
     return *this;
   }
 
   ThisType& add(Functor::Codim0And1<GridViewType>& functor,
-                const ApplyOn::WhichEntity<GridViewType>* which_entities = new ApplyOn::AllEntities<GridViewType>(),
-                const ApplyOn::WhichIntersection<GridViewType>* which_intersections =
-                    new ApplyOn::AllIntersections<GridViewType>())
-  {
-    codim0_functors_.emplace_back(
-        new internal::Codim0FunctorWrapper<GridViewType, Functor::Codim0And1<GridViewType>>(functor, which_entities));
-    codim1_functors_.emplace_back(new internal::Codim1FunctorWrapper<GridViewType, Functor::Codim0And1<GridViewType>>(
-        functor, which_intersections));
+                const ApplyOn::WhichEntity<GridViewType>* which_entities = nullptr,
+                const ApplyOn::WhichIntersection<GridViewType>* which_intersections = nullptr)
+  {
+    push_back(
+        new internal::Codim0FunctorWrapper<GridViewType, Functor::Codim0And1<GridViewType>>(functor, which_entities),
+        functor);
+    push_back(new internal::Codim1FunctorWrapper<GridViewType, Functor::Codim0And1<GridViewType>>(functor,
+                                                                                                   which_intersections),
+              functor);
     return *this;
   }
 
   ThisType& add(Functor::Codim0And1<GridViewType>& functor,
                 const ApplyOn::WhichIntersection<GridViewType>* which_intersections,
-                const ApplyOn::WhichEntity<GridViewType>* which_entities = new ApplyOn::AllEntities<GridViewType>())
+                const ApplyOn::WhichEntity<GridViewType>* which_entities = nullptr)
   {
-    codim0_functors_.emplace_back(
-        new internal::Codim0FunctorWrapper<GridViewType, Functor::Codim0And1<GridViewType>>(functor, which_entities));
-    codim1_functors_.emplace_back(new internal::Codim1FunctorWrapper<GridViewType, Functor::Codim0And1<GridViewType>>(
-        functor, which_intersections));
+    push_back(
+        new internal::Codim0FunctorWrapper<GridViewType, Functor::Codim0And1<GridViewType>>(functor, which_entities),
+        functor);
+    push_back(new internal::Codim1FunctorWrapper<GridViewType, Functor::Codim0And1<GridViewType>>(functor,
+                                                                                                   which_intersections),
+              functor);
     return *this;
   }
 
   ThisType& add(ThisType& other,
-                const ApplyOn::WhichEntity<GridViewType>* which_entities = new ApplyOn::AllEntities<GridViewType>(),
-                const ApplyOn::WhichIntersection<GridViewType>* which_intersections =
-                    new ApplyOn::AllIntersections<GridViewType>())
+                const ApplyOn::WhichEntity<GridViewType>* which_entities = nullptr,
+                const ApplyOn::WhichIntersection<GridViewType>* which_intersections = nullptr)
   {
     if (&other == this)
       DUNE_THROW(Stuff::Exceptions::you_are_using_this_wrong, "Do not add a Walker to itself!");
-    codim0_functors_.emplace_back(new internal::WalkerWrapper<GridViewType, ThisType>(other, which_entities));
-    codim1_functors_.emplace_back(new internal::WalkerWrapper<GridViewType, ThisType>(other, which_intersections));
+    push_back(new internal::Codim0WalkerWrapper<GridViewType, ThisType>(other, which_entities), other);
+    push_back(new internal::Codim1WalkerWrapper<GridViewType, ThisType>(other, which_intersections), other);
     return *this;
   } // ... add(...)
 
   ThisType& add(ThisType& other, const ApplyOn::WhichIntersection<GridViewType>* which_intersections,
-                const ApplyOn::WhichEntity<GridViewType>* which_entities = new ApplyOn::AllEntities<GridViewType>())
+                const ApplyOn::WhichEntity<GridViewType>* which_entities = nullptr)
   {
     if (&other == this)
       DUNE_THROW(Stuff::Exceptions::you_are_using_this_wrong, "Do not add a Walker to itself!");
-    codim0_functors_.emplace_back(new internal::WalkerWrapper<GridViewType, ThisType>(other, which_entities));
-    codim1_functors_.emplace_back(new internal::WalkerWrapper<GridViewType, ThisType>(other, which_intersections));
+    push_back(new internal::Codim0WalkerWrapper<GridViewType, ThisType>(other, which_entities), other);
+    push_back(new internal::Codim1WalkerWrapper<GridViewType, ThisType>(other, which_intersections), other);
     return *this;
   } // ... add(...)
 
+  /**
+   * \brief Adds a codim 1 functor which visits each inner intersection only once, from the side of the entity with
+   *        the smaller index, instead of from both sides.
+   *
+   *        The functor gets the inside and the outside entity of each inner intersection in a single call and thus has
+   *        to account for both orientations itself, e.g. by adding a numerical flux to both entities. If all codim 1
+   *        functors are added this way, the second visit is skipped before the outside entity is created. The
+   *        ownership of the intersections is taken from cache at the beginning of each walk (and thus recreated
+   *        after the grid has changed), so cache has to outlive the walk.
+   */
+  ThisType& add_inner_once(std::function<void(const IntersectionType&, const EntityType&, const EntityType&)> lambda,
+                           SeedPartitioningCache<RealGridViewType>& cache,
+                           const ApplyOn::WhichIntersection<GridViewType>* where = nullptr)
+  {
+    ownership_cache_ = &cache;
+    push_back_once(new internal::Codim1LambdaWrapper<GridViewType>(lambda, where), lambda);
+    return *this;
+  }
+
+  //! \see add_inner_once()
+  ThisType& add_inner_once(Functor::Codim1<GridViewType>& functor, SeedPartitioningCache<RealGridViewType>& cache,
+                           const ApplyOn::WhichIntersection<GridViewType>* where = nullptr)
+  {
+    ownership_cache_ = &cache;
+    push_back_once(new internal::Codim1FunctorWrapper<GridViewType, Functor::Codim1<GridViewType>>(functor, where),
+                   functor);
+    return *this;
+  }
+
+  //! \see add_inner_once(), the entities are visited as usual
+  ThisType& add_inner_once(Functor::Codim0And1<GridViewType>& functor, SeedPartitioningCache<RealGridViewType>& cache,
+                           const ApplyOn::WhichIntersection<GridViewType>* which_intersections = nullptr,
+                           const ApplyOn::WhichEntity<GridViewType>* which_entities = nullptr)
+  {
+    ownership_cache_ = &cache;
+    push_back(
+        new internal::Codim0FunctorWrapper<GridViewType, Functor::Codim0And1<GridViewType>>(functor, which_entities),
+        functor);
+    push_back_once(new internal::Codim1FunctorWrapper<GridViewType, Functor::Codim0And1<GridViewType>>(
+                       functor, which_intersections),
+                   functor);
+    return *this;
+  }
+
   void clear()
   {
     codim0_functors_.clear();
     codim1_functors_.clear();
+    codim1_once_functors_.clear();
+    ownership_cache_ = nullptr;
+    ownership_       = nullptr;
   } // ... clear()
 
   virtual void prepare()
@@ -194,6 +294,8 @@ public:
       functor->prepare();
     for (auto& functor : codim1_functors_)
       functor->prepare();
+    for (auto& functor : codim1_once_functors_)
+      functor->prepare();
   } // ... prepare()
 
   bool apply_on(const EntityType& entity) const
@@ -209,6 +311,9 @@ public:
     for (const auto& functor : codim1_functors_)
       if (functor->apply_on(this->grid_view_, intersection))
         return true;
+    for (const auto& functor : codim1_once_functors_)
+      if (functor->apply_on(this->grid_view_, intersection))
+        return true;
     return false;
   } // ... apply_on(...)
 
@@ -219,12 +324,18 @@ public:
         functor->apply_local(entity);
   } // ... apply_local(...)
 
+  /**
+   * \note The functors added by add_inner_once() are applied if inside_entity does not have a larger index than
+   *       outside_entity, which is the same decision as the one of the IntersectionOwnership used by the walks.
+   */
   virtual void apply_local(const IntersectionType& intersection, const EntityType& inside_entity,
                            const EntityType& outside_entity)
   {
-    for (auto& functor : codim1_functors_)
-      if (functor->apply_on(this->grid_view_, intersection))
-        functor->apply_local(intersection, inside_entity, outside_entity);
+    const auto& index_set = this->real_grid_view().indexSet();
+    apply_local(intersection,
+                inside_entity,
+                outside_entity,
+                !codim1_once_functors_.empty() && index_set.index(inside_entity) <= index_set.index(outside_entity));
   } // ... apply_local(...)
 
   virtual void finalize()
@@ -233,26 +344,59 @@ public:
       functor->finalize();
     for (auto& functor : codim1_functors_)
       functor->finalize();
+    for (auto& functor : codim1_once_functors_)
+      functor->finalize();
   } // ... finalize()
 
+  virtual std::unique_ptr<FunctorBaseType> copy() const override
+  {
+    internal::FunctorCopiesType copies;
+    return Common::make_unique<ThisType>(*this, copies);
+  }
+
+  virtual void join(FunctorBaseType& other) override
+  {
+    internal::JoinedFunctorsType joined;
+    join(static_cast<ThisType&>(other), joined);
+  }
+
+  //! joins all functors with those of other, which has to be a copy of this
+  void join(ThisType& other, internal::JoinedFunctorsType& joined)
+  {
+    assert(other.codim0_functors_.size() == codim0_functors_.size());
+    assert(other.codim1_functors_.size() == codim1_functors_.size());
+    assert(other.codim1_once_functors_.size() == codim1_once_functors_.size());
+    for (size_t ii = 0; ii < codim0_functors_.size(); ++ii)
+      codim0_functors_[ii]->join(*other.codim0_functors_[ii], joined);
+    for (size_t ii = 0; ii < codim1_functors_.size(); ++ii)
+      codim1_functors_[ii]->join(*other.codim1_functors_[ii], joined);
+    for (size_t ii = 0; ii < codim1_once_functors_.size(); ++ii)
+      codim1_once_functors_[ii]->join(*other.codim1_once_functors_[ii], joined);
+  } // ... join(...)
+
+  /**
+   * \brief Walks the grid view, in parallel if use_tbb is true.
+   *
+   *        The number of partitions for the parallel walk is given by threading.partition_factor times the number of
+   *        threads. W/o TBB the partitions are walked sequentially, yielding the same results as a threaded walk.
+   */
   void walk(const bool use_tbb = false)
   {
-#if DUNE_VERSION_NEWER(DUNE_COMMON, 3, 9) && HAVE_TBB // EXADUNE
     if (use_tbb) {
-      const auto num_partitions = DSC_CONFIG_GET("threading.partition_factor", 1u) * threadManager().current_threads();
-      RangedPartitioning<typename internal::GridPartViewHolder<GridViewType>::type, 0> partitioning(
-          this->real_grid_view(), num_partitions);
+#if DUNE_VERSION_NEWER(DUNE_COMMON, 3, 9) && HAVE_TBB // EXADUNE
+      RangedPartitioning<RealGridViewType, 0> partitioning(this->real_grid_view(), default_num_partitions());
+#else
+      SeedPartitioning<RealGridViewType> partitioning(this->real_grid_view(), default_num_partitions());
+#endif
       this->walk(partitioning);
       return;
     }
-#else
-    const auto DSC_UNUSED(no_warning_for_use_tbb) = use_tbb;
-#endif
     // prepare functors
     prepare();
+    prepare_ownership();
 
     // only do something, if we have to
-    if ((codim0_functors_.size() + codim1_functors_.size()) > 0) {
+    if ((codim0_functors_.size() + codim1_functors_.size() + codim1_once_functors_.size()) > 0) {
       walk_range(DSC::entityRange(this->grid_view_));
     } // only do something, if we have to
 
@@ -261,63 +405,188 @@ public:
     clear();
   } // ... walk(...)
 
-#if HAVE_TBB
-
-protected:
-  template <class PartioningType, class WalkerType>
-  struct Body
+  /**
+   * \brief Walks the grid view in parallel, using a partitioning from cache (see walk(true)).
+   *
+   *        The partitioning is only created on the first call and after the grid has changed, so repeated walks over
+   *        the same grid view should use this variant. Use a space filling curve ordering to improve the locality of
+   *        the traversal on unstructured grids.
+   * \note  Not every adaptation is detected (see SeedPartitioningCache), call cache.clear() after adapting the grid
+   *        unless it is adapted through dune-fem.
+   */
+  void walk(SeedPartitioningCache<RealGridViewType>& cache, const EntityOrdering ordering = EntityOrdering::grid_view)
   {
-    Body(WalkerType& walker, PartioningType& partitioning)
-      : walker_(walker)
-      , partitioning_(partitioning)
-    {
-    }
+    this->walk(cache.partitioning(this->real_grid_view(), default_num_partitions(), ordering));
+  }
 
-    Body(Body& other, tbb::split /*split*/)
-      : walker_(other.walker_)
-      , partitioning_(other.partitioning_)
-    {
-    }
+  /**
+   * \brief Walks the grid view along the given partitioning (see SeedPartitioning).
+   * \note  If LIKWID is available and ENABLE_PERFMON is set, each partition is measured in the marker region
+   *        "dune-stuff.walker" of the thread walking it (e.g. `likwid-perfctr -m -g L2CACHE` reports the cache misses
+   *        of the traversal per thread).
+   */
+  template <class PartioningType>
+  void walk(PartioningType& partitioning)
+  {
+#if HAVE_LIKWID && ENABLE_PERFMON
+    DSC_PROFILER; // initializes the marker API
+#endif
+    // prepare functors
+    prepare();
+    prepare_ownership();
 
-    void operator()(const tbb::blocked_range<std::size_t>& range) const
-    {
-      // for all partitions in tbb-range
-      for (std::size_t p = range.begin(); p != range.end(); ++p) {
-        auto partition = partitioning_.partition(p);
-        walker_.walk_range(partition);
-      }
-    }
+    // only do something, if we have to
+    if ((codim0_functors_.size() + codim1_functors_.size() + codim1_once_functors_.size()) > 0)
+      walk_partitions(partitioning, 0, partitioning.partitions());
 
-    void join(Body& /*other*/)
-    {
-    }
+    // finalize functors
+    finalize();
+    clear();
+  } // ... walk(...)
 
-    WalkerType& walker_;
-    const PartioningType& partitioning_;
-  }; // struct Body
+  /**
+   * \brief Walks the grid view color by color (see ColoredPartitioning), each color in parallel.
+   *
+   *        The entities of one color do not share any neighbors, so codim 1 functors may write to the data of the
+   *        inside and outside entity without locks or atomics, as long as they do not support copy(). The colors are
+   *        walked one after another.
+   */
+  void walk_colored(SeedPartitioningCache<RealGridViewType>& cache)
+  {
+    this->walk_colored(cache.coloring(this->real_grid_view(), default_num_partitions()));
+  }
 
-public:
-  template <class PartioningType>
-  void walk(PartioningType& partitioning)
+  void walk_colored(const ColoredPartitioning<RealGridViewType>& coloring)
   {
     // prepare functors
     prepare();
+    prepare_ownership();
 
     // only do something, if we have to
-    if ((codim0_functors_.size() + codim1_functors_.size()) > 0) {
-      tbb::blocked_range<std::size_t> range(0, partitioning.partitions());
-      Body<PartioningType, ThisType> body(*this, partitioning);
-      tbb::parallel_reduce(range, body);
+    if ((codim0_functors_.size() + codim1_functors_.size() + codim1_once_functors_.size()) > 0) {
+      for (size_t cc = 0; cc < coloring.colors(); ++cc) {
+        const auto color = coloring.color(cc);
+        walk_partitions(color, 0, color.partitions());
+      }
     }
 
     // finalize functors
     finalize();
     clear();
-  } // ... tbb_walk(...)
+  } // ... walk_colored(...)
 
-#endif // HAVE_TBB
+  //! number of partitions used by walk(true), walk(cache) and walk_colored(cache)
+  static size_t default_num_partitions()
+  {
+    return DSC_CONFIG_GET("threading.partition_factor", 1u) * threadManager().current_threads();
+  }
 
 protected:
+  /**
+   * \brief Stores functor, measures it if DUNE_STUFF_WALKER_DO_PROFILE is set (see internal::ProfiledCodim0Object).
+   *
+   *        The profiler section is named after the type of the original functor and its position among the functors
+   *        of this walker, since all lambdas of one signature share the same std::function type.
+   */
+  template <class OriginalType>
+  void push_back(internal::Codim0Object<GridViewType>* functor, const OriginalType& original)
+  {
+#if DUNE_STUFF_WALKER_DO_PROFILE
+    codim0_functors_.emplace_back(new internal::ProfiledCodim0Object<GridViewType>(
+        functor,
+        "Walker::" + Common::demangledTypeId(original) + " #" + std::to_string(codim0_functors_.size())
+            + " (codim 0)"));
+#else
+    DUNE_UNUSED_PARAMETER(original);
+    codim0_functors_.emplace_back(functor);
+#endif
+  }
+
+  //! \see push_back()
+  template <class OriginalType>
+  void push_back(internal::Codim1Object<GridViewType>* functor, const OriginalType& original)
+  {
+#if DUNE_STUFF_WALKER_DO_PROFILE
+    codim1_functors_.emplace_back(new internal::ProfiledCodim1Object<GridViewType>(
+        functor,
+        "Walker::" + Common::demangledTypeId(original) + " #" + std::to_string(codim1_functors_.size())
+            + " (codim 1)"));
+#else
+    DUNE_UNUSED_PARAMETER(original);
+    codim1_functors_.emplace_back(functor);
+#endif
+  }
+
+  //! \see push_back(), for the functors added by add_inner_once()
+  template <class OriginalType>
+  void push_back_once(internal::Codim1Object<GridViewType>* functor, const OriginalType& original)
+  {
+#if DUNE_STUFF_WALKER_DO_PROFILE
+    codim1_once_functors_.emplace_back(new internal::ProfiledCodim1Object<GridViewType>(
+        functor,
+        "Walker::" + Common::demangledTypeId(original) + " #" + std::to_string(codim1_once_functors_.size())
+            + " (codim 1, inner once)"));
+#else
+    DUNE_UNUSED_PARAMETER(original);
+    codim1_once_functors_.emplace_back(functor);
+#endif
+  }
+
+  //! fetches the current ownership for the functors added by add_inner_once(), at the beginning of each walk
+  void prepare_ownership()
+  {
+    ownership_ = codim1_once_functors_.empty() ? nullptr : &ownership_cache_->ownership(this->real_grid_view());
+  }
+
+  //! applies all codim 1 functors, those added by add_inner_once() only if owned
+  void apply_local(const IntersectionType& intersection, const EntityType& inside_entity,
+                   const EntityType& outside_entity, const bool owned)
+  {
+    for (auto& functor : codim1_functors_)
+      if (functor->apply_on(this->grid_view_, intersection))
+        functor->apply_local(intersection, inside_entity, outside_entity);
+    if (owned)
+      for (auto& functor : codim1_once_functors_)
+        if (functor->apply_on(this->grid_view_, intersection))
+          functor->apply_local(intersection, inside_entity, outside_entity);
+  } // ... apply_local(...)
+
+  /**
+   * \brief Walks the partitions [first, last) by recursive bisection.
+   *
+   *        The second half is walked by a copy of this walker (concurrently, if TBB is available) and joined into this
+   *        one afterwards, so the reduction tree only depends on the number of partitions.
+   */
+  template <class PartioningType>
+  void walk_partitions(const PartioningType& partitioning, const size_t first, const size_t last)
+  {
+    if (last - first < 2) {
+      if (first < last) {
+#if HAVE_LIKWID && ENABLE_PERFMON
+        internal::likwid_marker_thread_init();
+        LIKWID_MARKER_START("dune-stuff.walker");
+#endif
+        walk_range(partitioning.partition(first));
+#if HAVE_LIKWID && ENABLE_PERFMON
+        LIKWID_MARKER_STOP("dune-stuff.walker");
+#endif
+      }
+      return;
+    }
+    const size_t middle = first + (last - first) / 2;
+    internal::FunctorCopiesType copies;
+    ThisType second_half(*this, copies);
+#if HAVE_TBB
+    tbb::parallel_invoke([&] { this->walk_partitions(partitioning, first, middle); },
+                         [&] { second_half.walk_partitions(partitioning, middle, last); });
+#else
+    walk_partitions(partitioning, first, middle);
+    second_half.walk_partitions(partitioning, middle, last);
+#endif
+    internal::JoinedFunctorsType joined;
+    join(second_half, joined);
+  } // ... walk_partitions(...)
+
   template <class EntityRange>
   void walk_range(const EntityRange& entity_range)
   {
@@ -332,19 +601,25 @@ protected:
       apply_local(entity);
 
       // only walk the intersections, if there are codim1 functors present
-      if (codim1_functors_.size() > 0) {
+      if (codim1_functors_.size() + codim1_once_functors_.size() > 0) {
+        const size_t entity_index = ownership_ ? this->real_grid_view().indexSet().index(entity) : 0;
+        size_t position = 0;
         // walk the intersections
         const auto intersection_it_end = this->grid_view_.iend(entity);
         for (auto intersection_it = this->grid_view_.ibegin(entity); intersection_it != intersection_it_end;
-             ++intersection_it) {
+             ++intersection_it, ++position) {
+          // inner intersections owned by the neighbor are skipped by the functors added by add_inner_once()
+          const bool owned = ownership_ && ownership_->visit(entity_index, position);
+          if (!owned && codim1_functors_.empty())
+            continue;
           const auto& intersection = *intersection_it;
 
           // apply codim1 functors
           if (intersection.neighbor()) {
             const auto neighbor = intersection.outside();
-            apply_local(intersection, entity, neighbor);
+            apply_local(intersection, entity, neighbor, owned);
           } else
-            apply_local(intersection, entity, entity);
+            apply_local(intersection, entity, entity, owned);
 
         } // walk the intersections
       } // only walk the intersections, if there are codim1 functors present
@@ -353,6 +628,10 @@ protected:
 
   std::vector<std::unique_ptr<internal::Codim0Object<GridViewType>>> codim0_functors_;
   std::vector<std::unique_ptr<internal::Codim1Object<GridViewType>>> codim1_functors_;
+  std::vector<std::unique_ptr<internal::Codim1Object<GridViewType>>> codim1_once_functors_;
+  SeedPartitioningCache<RealGridViewType>* ownership_cache_;
+  //! only valid during a walk, see prepare_ownership()
+  const IntersectionOwnership<RealGridViewType>* ownership_;
 }; // class Walker
 
 } // namespace Grid
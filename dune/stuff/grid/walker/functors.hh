@@ -12,6 +12,8 @@
 // nothing here will compile w/o grid present
 #if HAVE_DUNE_GRID
 
+#include <memory>
+
 #include <dune/stuff/grid/entity.hh>
 #include <dune/stuff/grid/intersection.hh>
 #include <dune/stuff/grid/boundaryinfo.hh>
@@ -41,6 +43,27 @@ public:
   virtual void finalize()
   {
   }
+
+  /**
+   * \brief Returns a copy of this functor to be used by another worker of a parallel walk.
+   *
+   *        The default (nullptr) means that all workers share this functor, which then has to be thread safe. Each
+   *        copy is merged back into its origin by join() once the worker is done.
+   */
+  virtual std::unique_ptr<Codim0<GridViewImp>> copy() const
+  {
+    return nullptr;
+  }
+
+  /**
+   * \brief Merges the state of other, a (possibly joined) copy of this functor, into this functor.
+   *
+   *        The copies are joined along a fixed binary tree over the partitions of the walk, so reductions are
+   *        reproducible for a fixed number of partitions.
+   */
+  virtual void join(Codim0<GridViewImp>& /*other*/)
+  {
+  }
 }; // class Codim0
 
 template <class GridViewImp>
@@ -65,6 +88,17 @@ public:
   virtual void finalize()
   {
   }
+
+  //! \see Codim0::copy()
+  virtual std::unique_ptr<Codim1<GridViewImp>> copy() const
+  {
+    return nullptr;
+  }
+
+  //! \see Codim0::join()
+  virtual void join(Codim1<GridViewImp>& /*other*/)
+  {
+  }
 }; // class Codim1
 
 template <class GridViewImp>
@@ -91,6 +125,17 @@ public:
   virtual void finalize()
   {
   }
+
+  //! \see Codim0::copy()
+  virtual std::unique_ptr<Codim0And1<GridViewImp>> copy() const
+  {
+    return nullptr;
+  }
+
+  //! \see Codim0::join()
+  virtual void join(Codim0And1<GridViewImp>& /*other*/)
+  {
+  }
 }; // class Codim0And1
 
 template <class GridViewImp>
@@ -0,0 +1,666 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Felix Schindler (2015)
+//   Rene Milk       (2015)
+
+#ifndef DUNE_STUFF_GRID_WALKER_PARTITIONING_HH
+#define DUNE_STUFF_GRID_WALKER_PARTITIONING_HH
+
+// nothing here will compile w/o grid present
+#if HAVE_DUNE_GRID
+
+#include <map>
+#include <array>
+#include <mutex>
+#include <tuple>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+
+#include <boost/functional/hash.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <dune/common/unused.hh>
+
+#if HAVE_DUNE_FEM
+#include <dune/fem/space/common/dofmanager.hh>
+#endif
+
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/common/memory.hh>
+#include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/grid/entity.hh>
+
+namespace Dune {
+namespace Stuff {
+namespace Grid {
+namespace internal {
+
+//! iterator over a contiguous range of entity seeds, dereferences to the corresponding entity
+template <class GridType, class SeedIteratorType, class EntityImp>
+class EntitySeedIterator
+    : public boost::iterator_facade<EntitySeedIterator<GridType, SeedIteratorType, EntityImp>, const EntityImp,
+                                    boost::forward_traversal_tag, EntityImp>
+{
+  typedef EntitySeedIterator<GridType, SeedIteratorType, EntityImp> ThisType;
+
+public:
+  EntitySeedIterator(const GridType& grid, SeedIteratorType seed_it)
+    : grid_(&grid)
+    , seed_it_(seed_it)
+  {
+  }
+
+private:
+  friend class boost::iterator_core_access;
+
+  void increment()
+  {
+    ++seed_it_;
+  }
+
+  bool equal(const ThisType& other) const
+  {
+    return seed_it_ == other.seed_it_;
+  }
+
+  EntityImp dereference() const
+  {
+    return grid_->entity(*seed_it_);
+  }
+
+  const GridType* grid_;
+  SeedIteratorType seed_it_;
+}; // class EntitySeedIterator
+
+//! a range of EntitySeedIterators, models a partition of a partitioning
+template <class IteratorType>
+class EntitySeedRange
+{
+public:
+  EntitySeedRange(IteratorType beg, IteratorType en)
+    : begin_(beg)
+    , end_(en)
+  {
+  }
+
+  IteratorType begin() const
+  {
+    return begin_;
+  }
+
+  IteratorType end() const
+  {
+    return end_;
+  }
+
+private:
+  IteratorType begin_;
+  IteratorType end_;
+}; // class EntitySeedRange
+
+/**
+ * \brief Returns a number which changes whenever the grid (as seen by grid_view) is adapted.
+ *
+ *        There is no such thing in the grid interface, so we use a hash of the maximum level and the sizes of all
+ *        codimensions, combined with the sequence number of dune-fem's DofManager, if available. The latter only
+ *        changes if the grid is adapted through dune-fem, the former misses an adaptation which restores all sizes
+ *        (e.g. a refinement followed by a coarsening).
+ */
+template <class GridViewType>
+size_t grid_sequence(const GridViewType& grid_view)
+{
+  size_t seed = 0;
+  boost::hash_combine(seed, grid_view.grid().maxLevel());
+  for (int cc = 0; cc <= GridViewType::dimension; ++cc)
+    boost::hash_combine(seed, grid_view.size(cc));
+#if HAVE_DUNE_FEM
+  boost::hash_combine(seed, Fem::DofManager<typename GridViewType::Grid>::instance(grid_view.grid()).sequence());
+#endif
+  return seed;
+} // ... grid_sequence(...)
+
+/**
+ * \brief Position of a point of the unit cube [0, 2^bits)^dim along a Morton (Z-order) or Hilbert curve.
+ *
+ *        The Hilbert index is computed by transposing the coordinates as in J. Skilling, "Programming the Hilbert
+ *        curve", AIP Conf. Proc. 707 (2004), and interleaving the bits of the result.
+ */
+template <size_t dim>
+std::uint64_t space_filling_curve_index(std::array<std::uint64_t, dim> xx, const size_t bits, const bool hilbert)
+{
+  static_assert(dim > 0, "");
+  assert(bits * dim <= 64);
+  if (hilbert && bits > 0) {
+    const std::uint64_t mm = std::uint64_t(1) << (bits - 1);
+    // inverse undo
+    for (std::uint64_t qq = mm; qq > 1; qq >>= 1) {
+      const std::uint64_t pp = qq - 1;
+      for (size_t ii = 0; ii < dim; ++ii) {
+        if (xx[ii] & qq)
+          xx[0] ^= pp;
+        else {
+          const std::uint64_t tt = (xx[0] ^ xx[ii]) & pp;
+          xx[0] ^= tt;
+          xx[ii] ^= tt;
+        }
+      }
+    }
+    // gray encode
+    for (size_t ii = 1; ii < dim; ++ii)
+      xx[ii] ^= xx[ii - 1];
+    std::uint64_t tt = 0;
+    for (std::uint64_t qq = mm; qq > 1; qq >>= 1)
+      if (xx[dim - 1] & qq)
+        tt ^= qq - 1;
+    for (size_t ii = 0; ii < dim; ++ii)
+      xx[ii] ^= tt;
+  }
+  // interleave the bits, most significant first
+  std::uint64_t index = 0;
+  for (size_t bb = bits; bb > 0; --bb)
+    for (size_t ii = 0; ii < dim; ++ii)
+      index = (index << 1) | ((xx[ii] >> (bb - 1)) & 1);
+  return index;
+} // ... space_filling_curve_index(...)
+
+} // namespace internal
+
+//! order of the entities within a SeedPartitioning
+enum class EntityOrdering
+{
+  grid_view, //!< the iteration order of the grid view
+  morton, //!< along a Morton (Z-order) curve through the entity centers
+  hilbert //!< along a Hilbert curve through the entity centers
+};
+
+/**
+ *  \brief Splits the codim 0 entities of a grid view into contiguous chunks of entity seeds.
+ *
+ *         Models the partitioning concept of dune-grid (partitions(), partition(p)), and can thus be used in
+ *         Walker::walk(partitioning). Each partition is a range of entities in the order of the grid view, the entities
+ *         are recovered from their seeds on the fly.
+ *
+ *         The partitions are balanced w.r.t. the cost of an entity, which we take to be one plus its number of
+ *         intersections. The partitioning stays valid as long as the grid is not adapted, see up_to_date() and
+ *         SeedPartitioningCache.
+ *
+ *         If the iteration order of the grid view has poor locality (as is often the case for unstructured grids), the
+ *         entities may instead be ordered along a space filling curve through their centers, see EntityOrdering. Each
+ *         partition is then a compact tile of the domain, even if only one partition is used.
+ */
+template <class GridViewImp>
+class SeedPartitioning
+{
+public:
+  typedef GridViewImp GridViewType;
+  typedef typename GridViewType::Grid GridType;
+  typedef typename Stuff::Grid::Entity<GridViewType>::Type EntityType;
+  typedef typename EntityType::EntitySeed EntitySeedType;
+
+private:
+  typedef std::vector<EntitySeedType> SeedContainerType;
+  typedef internal::EntitySeedIterator<GridType, typename SeedContainerType::const_iterator, EntityType>
+      IteratorType;
+
+public:
+  typedef internal::EntitySeedRange<IteratorType> PartitionType;
+
+  SeedPartitioning(const GridViewType& grid_view,
+                   const size_t num_partitions,
+                   const EntityOrdering ordering = EntityOrdering::grid_view)
+    : grid_(grid_view.grid())
+    , index_set_(&grid_view.indexSet())
+    , sequence_(internal::grid_sequence(grid_view))
+    , ordering_(ordering)
+  {
+    if (num_partitions == 0)
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given, "num_partitions has to be positive!");
+    // collect the seeds and the number of intersections of each entity
+    std::vector<size_t> num_intersections;
+    std::vector<DomainType> centers;
+    seeds_.reserve(grid_view.size(0));
+    num_intersections.reserve(grid_view.size(0));
+    if (ordering_ != EntityOrdering::grid_view)
+      centers.reserve(grid_view.size(0));
+    size_t total_cost = 0;
+    for (const auto& entity : Common::entityRange(grid_view)) {
+      seeds_.emplace_back(entity.seed());
+      size_t count = 0;
+      const auto intersection_it_end = grid_view.iend(entity);
+      for (auto intersection_it = grid_view.ibegin(entity); intersection_it != intersection_it_end; ++intersection_it)
+        ++count;
+      num_intersections.push_back(count);
+      total_cost += 1 + count;
+      if (ordering_ != EntityOrdering::grid_view)
+        centers.emplace_back(entity.geometry().center());
+    }
+    if (ordering_ != EntityOrdering::grid_view)
+      reorder(centers, num_intersections);
+    // each partition ends as soon as its accumulated cost reaches its share of the total cost, but we leave at least
+    // one entity for each of the remaining partitions
+    const size_t partitions = std::max(size_t(1), std::min(num_partitions, seeds_.size()));
+    offsets_.resize(partitions + 1, 0);
+    intersections_.resize(partitions, 0);
+    size_t cost = 0;
+    size_t ee   = 0;
+    for (size_t pp = 0; pp < partitions; ++pp) {
+      const size_t target = (pp + 1 == partitions) ? total_cost : (total_cost * (pp + 1)) / partitions;
+      const size_t last = seeds_.size() - (partitions - pp - 1);
+      while (ee < last && (cost < target || ee == offsets_[pp])) {
+        cost += 1 + num_intersections[ee];
+        intersections_[pp] += num_intersections[ee];
+        ++ee;
+      }
+      offsets_[pp + 1] = ee;
+    }
+    assert(offsets_[partitions] == seeds_.size());
+  } // SeedPartitioning(...)
+
+  size_t partitions() const
+  {
+    return offsets_.size() - 1;
+  }
+
+  PartitionType partition(const size_t pp) const
+  {
+    assert(pp < partitions());
+    return PartitionType(IteratorType(grid_, seeds_.begin() + offsets_[pp]),
+                         IteratorType(grid_, seeds_.begin() + offsets_[pp + 1]));
+  }
+
+  //! number of entities in partition pp
+  size_t size(const size_t pp) const
+  {
+    assert(pp < partitions());
+    return offsets_[pp + 1] - offsets_[pp];
+  }
+
+  //! number of intersections of all entities in partition pp
+  size_t intersections(const size_t pp) const
+  {
+    assert(pp < partitions());
+    return intersections_[pp];
+  }
+
+  EntityOrdering ordering() const
+  {
+    return ordering_;
+  }
+
+  //! whether this partitioning was created for grid_view and the grid has not changed since
+  bool up_to_date(const GridViewType& grid_view) const
+  {
+    return &grid_view.indexSet() == index_set_ && size_t(grid_view.indexSet().size(0)) == seeds_.size()
+           && internal::grid_sequence(grid_view) == sequence_;
+  }
+
+private:
+  typedef typename EntityType::Geometry::GlobalCoordinate DomainType;
+  static const size_t dimDomain = DomainType::dimension;
+
+  //! sorts seeds_ and num_intersections along the space filling curve through centers
+  void reorder(const std::vector<DomainType>& centers, std::vector<size_t>& num_intersections)
+  {
+    if (seeds_.empty())
+      return;
+    // scale the bounding box of the centers to [0, 2^bits)^dimDomain
+    DomainType lower(std::numeric_limits<typename DomainType::field_type>::max());
+    DomainType upper(std::numeric_limits<typename DomainType::field_type>::lowest());
+    for (const auto& center : centers)
+      for (size_t dd = 0; dd < dimDomain; ++dd) {
+        lower[dd] = std::min(lower[dd], center[dd]);
+        upper[dd] = std::max(upper[dd], center[dd]);
+      }
+    const size_t bits         = std::min(size_t(32), 64 / dimDomain);
+    const double max_quantity = double((std::uint64_t(1) << bits) - 1);
+    std::vector<std::uint64_t> keys(seeds_.size());
+    for (size_t ee = 0; ee < seeds_.size(); ++ee) {
+      std::array<std::uint64_t, dimDomain> quantized;
+      for (size_t dd = 0; dd < dimDomain; ++dd) {
+        const auto width = upper[dd] - lower[dd];
+        quantized[dd] = width > 0 ? std::uint64_t((centers[ee][dd] - lower[dd]) / width * max_quantity) : 0;
+      }
+      keys[ee] = internal::space_filling_curve_index(quantized, bits, ordering_ == EntityOrdering::hilbert);
+    }
+    // stable, to be reproducible for coinciding keys
+    std::vector<size_t> permutation(seeds_.size());
+    std::iota(permutation.begin(), permutation.end(), 0);
+    std::stable_sort(permutation.begin(), permutation.end(), [&](size_t ii, size_t jj) { return keys[ii] < keys[jj]; });
+    SeedContainerType sorted_seeds;
+    std::vector<size_t> sorted_num_intersections;
+    sorted_seeds.reserve(seeds_.size());
+    sorted_num_intersections.reserve(seeds_.size());
+    for (const auto& ee : permutation) {
+      sorted_seeds.push_back(seeds_[ee]);
+      sorted_num_intersections.push_back(num_intersections[ee]);
+    }
+    seeds_.swap(sorted_seeds);
+    num_intersections.swap(sorted_num_intersections);
+  } // ... reorder(...)
+
+  const GridType& grid_;
+  const void* index_set_;
+  const size_t sequence_;
+  const EntityOrdering ordering_;
+  SeedContainerType seeds_;
+  std::vector<size_t> offsets_;
+  std::vector<size_t> intersections_;
+}; // class SeedPartitioning
+
+/**
+ *  \brief Groups the codim 0 entities of a grid view into colors, such that entities of the same color may be
+ *         processed concurrently.
+ *
+ *         Two entities get different colors if they share a vertex, are neighbors or share a neighbor (greedy
+ *         distance-2 coloring). A codim 1 functor applied to the intersections of entities of one color thus never
+ *         touches the same inside or outside entity twice at the same time, and may write to the data of both (or to
+ *         the vertices of the inside entity) without any synchronization.
+ *         Within each color the entities are split into partitions, see Walker::walk_colored().
+ */
+template <class GridViewImp>
+class ColoredPartitioning
+{
+public:
+  typedef GridViewImp GridViewType;
+  typedef typename GridViewType::Grid GridType;
+  typedef typename Stuff::Grid::Entity<GridViewType>::Type EntityType;
+  typedef typename EntityType::EntitySeed EntitySeedType;
+
+private:
+  typedef std::vector<EntitySeedType> SeedContainerType;
+  typedef internal::EntitySeedIterator<GridType, typename SeedContainerType::const_iterator, EntityType>
+      IteratorType;
+
+public:
+  typedef internal::EntitySeedRange<IteratorType> PartitionType;
+
+  //! the entities of one color, split into evenly sized partitions
+  class ColorType
+  {
+  public:
+    ColorType(const GridType& grid, const typename SeedContainerType::const_iterator beg, const size_t sz,
+              const size_t num_partitions)
+      : grid_(grid)
+      , begin_(beg)
+      , size_(sz)
+      , partitions_(std::max(size_t(1), std::min(num_partitions, size_)))
+    {
+    }
+
+    size_t partitions() const
+    {
+      return partitions_;
+    }
+
+    PartitionType partition(const size_t pp) const
+    {
+      assert(pp < partitions_);
+      return PartitionType(IteratorType(grid_, begin_ + (size_ * pp) / partitions_),
+                           IteratorType(grid_, begin_ + (size_ * (pp + 1)) / partitions_));
+    }
+
+    size_t size() const
+    {
+      return size_;
+    }
+
+  private:
+    const GridType& grid_;
+    const typename SeedContainerType::const_iterator begin_;
+    const size_t size_;
+    const size_t partitions_;
+  }; // class ColorType
+
+  ColoredPartitioning(const GridViewType& grid_view, const size_t num_partitions)
+    : grid_(grid_view.grid())
+    , index_set_(&grid_view.indexSet())
+    , sequence_(internal::grid_sequence(grid_view))
+    , num_partitions_(num_partitions)
+  {
+    if (num_partitions_ == 0)
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given, "num_partitions has to be positive!");
+    const auto& index_set = grid_view.indexSet();
+    const size_t num_entities = grid_view.size(0);
+    // collect the seeds, indices, neighbors and vertices of all entities
+    static const int dimension = GridViewType::dimension;
+    SeedContainerType seeds;
+    std::vector<size_t> indices;
+    std::vector<std::vector<size_t>> neighbors(num_entities);
+    std::vector<std::vector<size_t>> vertices(num_entities);
+    std::vector<std::vector<size_t>> vertex_entities(index_set.size(dimension));
+    seeds.reserve(num_entities);
+    indices.reserve(num_entities);
+    for (const auto& entity : Common::entityRange(grid_view)) {
+      const size_t index = index_set.index(entity);
+      seeds.emplace_back(entity.seed());
+      indices.push_back(index);
+      for (int vv = 0; vv < entity.template count<dimension>(); ++vv) {
+        const size_t vertex = index_set.subIndex(entity, vv, dimension);
+        vertices[index].push_back(vertex);
+        vertex_entities[vertex].push_back(index);
+      }
+      const auto intersection_it_end = grid_view.iend(entity);
+      for (auto intersection_it = grid_view.ibegin(entity); intersection_it != intersection_it_end; ++intersection_it) {
+        const auto& intersection = *intersection_it;
+        if (intersection.neighbor())
+          neighbors[index].push_back(index_set.index(intersection.outside()));
+      }
+    }
+    // greedy coloring, forbidden[c] == ee + 1 marks color c as taken in the distance-2 neighborhood of entity ee
+    std::vector<size_t> colors(num_entities, 0);
+    std::vector<size_t> forbidden;
+    size_t num_colors = 0;
+    for (size_t ee = 0; ee < num_entities; ++ee) {
+      for (const auto& vertex : vertices[ee])
+        for (const auto& other : vertex_entities[vertex])
+          if (other < ee)
+            mark(forbidden, colors[other], ee);
+      for (const auto& neighbor : neighbors[ee]) {
+        if (neighbor < ee)
+          mark(forbidden, colors[neighbor], ee);
+        for (const auto& second_neighbor : neighbors[neighbor])
+          if (second_neighbor < ee)
+            mark(forbidden, colors[second_neighbor], ee);
+      }
+      size_t color = 0;
+      while (color < forbidden.size() && forbidden[color] == ee + 1)
+        ++color;
+      colors[ee] = color;
+      num_colors = std::max(num_colors, color + 1);
+    }
+    // sort the seeds by color, keeping the iteration order of the grid view within each color
+    color_offsets_.resize(num_colors + 1, 0);
+    for (const auto& color : colors)
+      ++color_offsets_[color + 1];
+    std::partial_sum(color_offsets_.begin(), color_offsets_.end(), color_offsets_.begin());
+    std::vector<size_t> positions(color_offsets_.begin(), color_offsets_.end() - 1);
+    std::vector<size_t> permutation(seeds.size());
+    for (size_t ii = 0; ii < seeds.size(); ++ii)
+      permutation[positions[colors[indices[ii]]]++] = ii;
+    seeds_.reserve(seeds.size());
+    for (const auto& ii : permutation)
+      seeds_.push_back(seeds[ii]);
+  } // ColoredPartitioning(...)
+
+  size_t colors() const
+  {
+    return color_offsets_.size() - 1;
+  }
+
+  ColorType color(const size_t cc) const
+  {
+    assert(cc < colors());
+    return ColorType(
+        grid_, seeds_.begin() + color_offsets_[cc], color_offsets_[cc + 1] - color_offsets_[cc], num_partitions_);
+  }
+
+  //! whether this coloring was created for grid_view and the grid has not changed since
+  bool up_to_date(const GridViewType& grid_view) const
+  {
+    return &grid_view.indexSet() == index_set_ && size_t(grid_view.indexSet().size(0)) == seeds_.size()
+           && internal::grid_sequence(grid_view) == sequence_;
+  }
+
+private:
+  static void mark(std::vector<size_t>& forbidden, const size_t color, const size_t ee)
+  {
+    if (forbidden.size() <= color)
+      forbidden.resize(color + 1, 0);
+    forbidden[color] = ee + 1;
+  }
+
+  const GridType& grid_;
+  const void* index_set_;
+  const size_t sequence_;
+  const size_t num_partitions_;
+  SeedContainerType seeds_;
+  std::vector<size_t> color_offsets_;
+}; // class ColoredPartitioning
+
+/**
+ *  \brief Decides for each intersection whether it is to be visited in a walk which visits each inner intersection
+ *         only once, see Walker::add_inner_once().
+ *
+ *         An inner intersection is owned by the entity with the smaller index, boundary intersections are always
+ *         visited. The decision is stored per entity and per position of the intersection in the intersection iteration
+ *         of that entity, so a walk can skip the second visit before the outside entity is even created.
+ */
+template <class GridViewImp>
+class IntersectionOwnership
+{
+public:
+  typedef GridViewImp GridViewType;
+  typedef typename Stuff::Grid::Entity<GridViewType>::Type EntityType;
+
+  explicit IntersectionOwnership(const GridViewType& grid_view)
+    : index_set_(&grid_view.indexSet())
+    , sequence_(internal::grid_sequence(grid_view))
+    , offsets_(grid_view.size(0) + 1, 0)
+  {
+    const auto& index_set = grid_view.indexSet();
+    // count the intersections of each entity
+    for (const auto& entity : Common::entityRange(grid_view)) {
+      size_t count = 0;
+      const auto intersection_it_end = grid_view.iend(entity);
+      for (auto intersection_it = grid_view.ibegin(entity); intersection_it != intersection_it_end; ++intersection_it)
+        ++count;
+      offsets_[index_set.index(entity) + 1] = count;
+    }
+    std::partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+    // decide which side visits each intersection
+    visit_.resize(offsets_.back(), true);
+    for (const auto& entity : Common::entityRange(grid_view)) {
+      const size_t index = index_set.index(entity);
+      size_t position = offsets_[index];
+      const auto intersection_it_end = grid_view.iend(entity);
+      for (auto intersection_it = grid_view.ibegin(entity); intersection_it != intersection_it_end;
+           ++intersection_it, ++position) {
+        const auto& intersection = *intersection_it;
+        if (intersection.neighbor())
+          visit_[position] = index <= size_t(index_set.index(intersection.outside()));
+      }
+    }
+  } // IntersectionOwnership(...)
+
+  //! whether the intersection at position (in the intersection iteration) of the entity with index is to be visited
+  bool visit(const size_t index, const size_t position) const
+  {
+    assert(index + 1 < offsets_.size());
+    assert(offsets_[index] + position < offsets_[index + 1]);
+    return visit_[offsets_[index] + position];
+  }
+
+  //! whether this ownership was created for grid_view and the grid has not changed since
+  bool up_to_date(const GridViewType& grid_view) const
+  {
+    return &grid_view.indexSet() == index_set_ && size_t(grid_view.indexSet().size(0)) + 1 == offsets_.size()
+           && internal::grid_sequence(grid_view) == sequence_;
+  }
+
+private:
+  const void* index_set_;
+  const size_t sequence_;
+  std::vector<size_t> offsets_;
+  std::vector<bool> visit_;
+}; // class IntersectionOwnership
+
+/**
+ *  \brief Keeps SeedPartitionings, ColoredPartitionings and IntersectionOwnerships around for repeated walks, e.g. in
+ *         each step of a time stepping scheme.
+ *
+ *         The partitionings are identified by the index set of the grid view, the number of partitions and the
+ *         ordering, and are recreated once the grid changes (see internal::grid_sequence()).
+ *  \note  The cache must not outlive the grids it was used with. Unless the grid is adapted through dune-fem, an
+ *         adaptation which restores the number of entities of each codimension is not detected: call clear() after
+ *         such an adaptation.
+ */
+template <class GridViewImp>
+class SeedPartitioningCache
+{
+public:
+  typedef GridViewImp GridViewType;
+  typedef SeedPartitioning<GridViewType> PartitioningType;
+  typedef ColoredPartitioning<GridViewType> ColoringType;
+  typedef IntersectionOwnership<GridViewType> OwnershipType;
+
+  const PartitioningType& partitioning(const GridViewType& grid_view,
+                                       const size_t num_partitions,
+                                       const EntityOrdering ordering = EntityOrdering::grid_view)
+  {
+    std::lock_guard<std::mutex> DUNE_UNUSED(guard)(mutex_);
+    auto& cached =
+        partitionings_[std::make_tuple(static_cast<const void*>(&grid_view.indexSet()), num_partitions, ordering)];
+    if (!cached || !cached->up_to_date(grid_view))
+      cached = Common::make_unique<PartitioningType>(grid_view, num_partitions, ordering);
+    return *cached;
+  }
+
+  const ColoringType& coloring(const GridViewType& grid_view, const size_t num_partitions)
+  {
+    std::lock_guard<std::mutex> DUNE_UNUSED(guard)(mutex_);
+    auto& cached = colorings_[std::make_pair(static_cast<const void*>(&grid_view.indexSet()), num_partitions)];
+    if (!cached || !cached->up_to_date(grid_view))
+      cached = Common::make_unique<ColoringType>(grid_view, num_partitions);
+    return *cached;
+  }
+
+  const OwnershipType& ownership(const GridViewType& grid_view)
+  {
+    std::lock_guard<std::mutex> DUNE_UNUSED(guard)(mutex_);
+    auto& cached = ownerships_[static_cast<const void*>(&grid_view.indexSet())];
+    if (!cached || !cached->up_to_date(grid_view))
+      cached = Common::make_unique<OwnershipType>(grid_view);
+    return *cached;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> DUNE_UNUSED(guard)(mutex_);
+    partitionings_.clear();
+    colorings_.clear();
+    ownerships_.clear();
+  }
+
+private:
+  std::map<std::tuple<const void*, size_t, EntityOrdering>, std::unique_ptr<PartitioningType>> partitionings_;
+  std::map<std::pair<const void*, size_t>, std::unique_ptr<ColoringType>> colorings_;
+  std::map<const void*, std::unique_ptr<OwnershipType>> ownerships_;
+  std::mutex mutex_;
+}; // class SeedPartitioningCache
+
+} // namespace Grid
+} // namespace Stuff
+} // namespace Dune
+
+#endif // HAVE_DUNE_GRID
+
+#endif // DUNE_STUFF_GRID_WALKER_PARTITIONING_HH
@@ -0,0 +1,333 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Felix Schindler (2015)
+//   Rene Milk       (2015)
+
+#ifndef DUNE_STUFF_GRID_WALKER_STATIC_HH
+#define DUNE_STUFF_GRID_WALKER_STATIC_HH
+
+// nothing here will compile w/o grid present
+#if HAVE_DUNE_GRID
+
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+#include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/grid/entity.hh>
+#include <dune/stuff/grid/intersection.hh>
+
+#include "functors.hh"
+#include "apply-on.hh"
+
+namespace Dune {
+namespace Stuff {
+namespace Grid {
+namespace internal {
+
+//! a functor together with an ApplyOn filter, to be used in a StaticWalker, see filtered()
+template <class FunctorImp, class WhichImp>
+struct StaticFilteredFunctor
+{
+  typedef FunctorImp FunctorType;
+  typedef WhichImp WhichType;
+
+  StaticFilteredFunctor(FunctorType& fnctr, WhichType whch)
+    : functor(fnctr)
+    , which(std::move(whch))
+  {
+  }
+
+  FunctorType& functor;
+  const WhichType which;
+}; // struct StaticFilteredFunctor
+
+/**
+ * \brief Static dispatch of the StaticWalker calls to one of its functors.
+ *
+ *        All calls are qualified with the static type of the functor (or filter), which disables virtual dispatch and
+ *        allows the compiler to inline them.
+ */
+template <class GridViewType, class FunctorImp>
+struct StaticFunctorTraits
+{
+  typedef typename std::decay<FunctorImp>::type FunctorType;
+  typedef typename Stuff::Grid::Entity<GridViewType>::Type EntityType;
+  typedef typename Stuff::Grid::Intersection<GridViewType>::Type IntersectionType;
+
+  static const bool codim0 = std::is_base_of<Functor::Codim0<GridViewType>, FunctorType>::value
+                             || std::is_base_of<Functor::Codim0And1<GridViewType>, FunctorType>::value;
+  static const bool codim1 = std::is_base_of<Functor::Codim1<GridViewType>, FunctorType>::value
+                             || std::is_base_of<Functor::Codim0And1<GridViewType>, FunctorType>::value;
+  static_assert(codim0 || codim1, "FunctorImp has to be derived from one of the Functor::Codim* interfaces!");
+
+  static FunctorType& functor(FunctorType& functor)
+  {
+    return functor;
+  }
+
+  static bool apply_on(const FunctorType& /*functor*/, const GridViewType& /*grid_view*/, const EntityType& /*entity*/)
+  {
+    return true;
+  }
+
+  static bool apply_on(const FunctorType& /*functor*/, const GridViewType& /*grid_view*/,
+                       const IntersectionType& /*intersection*/)
+  {
+    return true;
+  }
+}; // struct StaticFunctorTraits
+
+template <class GridViewType, class FunctorImp, class WhichImp>
+struct StaticFunctorTraits<GridViewType, StaticFilteredFunctor<FunctorImp, WhichImp>>
+{
+  typedef StaticFilteredFunctor<FunctorImp, WhichImp> FilteredType;
+  typedef StaticFunctorTraits<GridViewType, FunctorImp> WrappedTraits;
+  typedef typename WrappedTraits::FunctorType FunctorType;
+  typedef typename WrappedTraits::EntityType EntityType;
+  typedef typename WrappedTraits::IntersectionType IntersectionType;
+
+  static const bool codim0 = WrappedTraits::codim0;
+  static const bool codim1 = WrappedTraits::codim1;
+  static const bool filters_entities = std::is_base_of<ApplyOn::WhichEntity<GridViewType>, WhichImp>::value;
+  static_assert(filters_entities || std::is_base_of<ApplyOn::WhichIntersection<GridViewType>, WhichImp>::value,
+                "WhichImp has to be derived from ApplyOn::WhichEntity or ApplyOn::WhichIntersection!");
+
+  static FunctorType& functor(FilteredType& filtered)
+  {
+    return filtered.functor;
+  }
+
+  static bool apply_on(const FilteredType& filtered, const GridViewType& grid_view, const EntityType& entity)
+  {
+    return apply_on(filtered, grid_view, entity, std::integral_constant<bool, filters_entities>());
+  }
+
+  static bool apply_on(const FilteredType& filtered, const GridViewType& grid_view,
+                       const IntersectionType& intersection)
+  {
+    return apply_on(filtered, grid_view, intersection, std::integral_constant<bool, !filters_entities>());
+  }
+
+private:
+  template <class E>
+  static bool apply_on(const FilteredType& filtered, const GridViewType& grid_view, const E& element, std::true_type)
+  {
+    return filtered.which.WhichImp::apply_on(grid_view, element);
+  }
+
+  template <class E>
+  static bool apply_on(const FilteredType& /*filtered*/, const GridViewType& /*grid_view*/, const E& /*element*/,
+                       std::false_type)
+  {
+    return true;
+  }
+}; // struct StaticFunctorTraits< ..., StaticFilteredFunctor< ... > >
+
+//! applies StaticWalker calls to the functors ii, ..., size - 1 of a tuple
+template <class GridViewType, class TupleType, size_t ii = 0, size_t size = std::tuple_size<TupleType>::value>
+struct StaticFunctorLoop
+{
+  typedef typename std::tuple_element<ii, TupleType>::type ElementType;
+  typedef StaticFunctorTraits<GridViewType, typename std::decay<ElementType>::type> Traits;
+  typedef typename Traits::FunctorType FunctorType;
+  typedef StaticFunctorLoop<GridViewType, TupleType, ii + 1, size> NextType;
+  typedef typename Traits::EntityType EntityType;
+  typedef typename Traits::IntersectionType IntersectionType;
+
+  static const bool has_codim1 = Traits::codim1 || NextType::has_codim1;
+
+  static void prepare(TupleType& functors)
+  {
+    Traits::functor(std::get<ii>(functors)).FunctorType::prepare();
+    NextType::prepare(functors);
+  }
+
+  static void apply_local(TupleType& functors, const GridViewType& grid_view, const EntityType& entity)
+  {
+    apply_local(functors, grid_view, entity, std::integral_constant<bool, Traits::codim0>());
+    NextType::apply_local(functors, grid_view, entity);
+  }
+
+  static void apply_local(TupleType& functors, const GridViewType& grid_view, const IntersectionType& intersection,
+                          const EntityType& inside_entity, const EntityType& outside_entity)
+  {
+    apply_local(functors,
+                grid_view,
+                intersection,
+                inside_entity,
+                outside_entity,
+                std::integral_constant<bool, Traits::codim1>());
+    NextType::apply_local(functors, grid_view, intersection, inside_entity, outside_entity);
+  }
+
+  static void finalize(TupleType& functors)
+  {
+    Traits::functor(std::get<ii>(functors)).FunctorType::finalize();
+    NextType::finalize(functors);
+  }
+
+private:
+  static void apply_local(TupleType& functors, const GridViewType& grid_view, const EntityType& entity,
+                          std::true_type)
+  {
+    auto& element = std::get<ii>(functors);
+    if (Traits::apply_on(element, grid_view, entity))
+      Traits::functor(element).FunctorType::apply_local(entity);
+  }
+
+  static void apply_local(TupleType& /*functors*/, const GridViewType& /*grid_view*/, const EntityType& /*entity*/,
+                          std::false_type)
+  {
+  }
+
+  static void apply_local(TupleType& functors, const GridViewType& grid_view, const IntersectionType& intersection,
+                          const EntityType& inside_entity, const EntityType& outside_entity, std::true_type)
+  {
+    auto& element = std::get<ii>(functors);
+    if (Traits::apply_on(element, grid_view, intersection))
+      Traits::functor(element).FunctorType::apply_local(intersection, inside_entity, outside_entity);
+  }
+
+  static void apply_local(TupleType& /*functors*/, const GridViewType& /*grid_view*/,
+                          const IntersectionType& /*intersection*/, const EntityType& /*inside_entity*/,
+                          const EntityType& /*outside_entity*/, std::false_type)
+  {
+  }
+}; // struct StaticFunctorLoop
+
+template <class GridViewType, class TupleType, size_t size>
+struct StaticFunctorLoop<GridViewType, TupleType, size, size>
+{
+  static const bool has_codim1 = false;
+
+  static void prepare(TupleType& /*functors*/)
+  {
+  }
+
+  template <class... Args>
+  static void apply_local(TupleType& /*functors*/, Args&&... /*args*/)
+  {
+  }
+
+  static void finalize(TupleType& /*functors*/)
+  {
+  }
+}; // struct StaticFunctorLoop< ..., size, size >
+
+} // namespace internal
+
+/**
+ *  \brief Restricts a functor of a StaticWalker to the entities or intersections selected by which.
+ *
+ *         The filter is stored by value, e.g. filtered(functor, ApplyOn::BoundaryIntersections<GridViewType>()).
+ */
+template <class FunctorImp, class WhichImp>
+internal::StaticFilteredFunctor<FunctorImp, typename std::decay<WhichImp>::type> filtered(FunctorImp& functor,
+                                                                                           WhichImp&& which)
+{
+  return internal::StaticFilteredFunctor<FunctorImp, typename std::decay<WhichImp>::type>(
+      functor, std::forward<WhichImp>(which));
+}
+
+/**
+ *  \brief Walks a grid view and applies a fixed set of functors, known at compile time.
+ *
+ *         In contrast to the Walker, there is no virtual dispatch and no std::function involved: the functors (and
+ *         their filters, see filtered()) are called with their static type and the whole per entity pipeline may be
+ *         inlined. This pays off for cheap functors, e.g. the ones in information.hh. Use make_static_walker() to
+ *         deduce the types.
+ *  \note  Since virtual dispatch is bypassed, each functor has to be given with its most derived type.
+ *  \note  The walk is sequential, use the Walker for parallel walks.
+ */
+template <class GridViewImp, class... FunctorImps>
+class StaticWalker
+{
+  typedef std::tuple<FunctorImps...> FunctorTupleType;
+  typedef internal::StaticFunctorLoop<GridViewImp, FunctorTupleType> LoopType;
+
+public:
+  typedef GridViewImp GridViewType;
+  typedef typename Stuff::Grid::Entity<GridViewType>::Type EntityType;
+  typedef typename Stuff::Grid::Intersection<GridViewType>::Type IntersectionType;
+
+  template <class... Args>
+  explicit StaticWalker(GridViewType grd_vw, Args&&... functors)
+    : grid_view_(grd_vw)
+    , functors_(std::forward<Args>(functors)...)
+  {
+  }
+
+  const GridViewType& grid_view() const
+  {
+    return grid_view_;
+  }
+
+  void walk()
+  {
+    LoopType::prepare(functors_);
+    walk_range(DSC::entityRange(grid_view_));
+    LoopType::finalize(functors_);
+  } // ... walk()
+
+  //! walks all partitions of partitioning sequentially
+  template <class PartioningType>
+  void walk(const PartioningType& partitioning)
+  {
+    LoopType::prepare(functors_);
+    for (size_t pp = 0; pp < partitioning.partitions(); ++pp)
+      walk_range(partitioning.partition(pp));
+    LoopType::finalize(functors_);
+  } // ... walk(...)
+
+private:
+  template <class EntityRange>
+  void walk_range(const EntityRange& entity_range)
+  {
+    for (const auto& entity : entity_range) {
+      LoopType::apply_local(functors_, grid_view_, entity);
+      // only walk the intersections, if there are codim1 functors present
+      if (LoopType::has_codim1) {
+        const auto intersection_it_end = grid_view_.iend(entity);
+        for (auto intersection_it = grid_view_.ibegin(entity); intersection_it != intersection_it_end;
+             ++intersection_it) {
+          const auto& intersection = *intersection_it;
+          if (intersection.neighbor()) {
+            const auto neighbor = intersection.outside();
+            LoopType::apply_local(functors_, grid_view_, intersection, entity, neighbor);
+          } else
+            LoopType::apply_local(functors_, grid_view_, intersection, entity, entity);
+        }
+      }
+    }
+  } // ... walk_range(...)
+
+  const GridViewType grid_view_;
+  FunctorTupleType functors_;
+}; // class StaticWalker
+
+/**
+ *  \brief Creates a StaticWalker, functors passed as lvalues are referenced, filtered() ones are stored.
+ *
+ *  \code
+auto walker = make_static_walker(grid_view, volume_functor, filtered(face_functor, ApplyOn::InnerIntersections<GV>()));
+walker.walk();
+\endcode
+ */
+template <class GridViewType, class... FunctorImps>
+StaticWalker<GridViewType, FunctorImps...> make_static_walker(const GridViewType& grid_view,
+                                                              FunctorImps&&... functors)
+{
+  return StaticWalker<GridViewType, FunctorImps...>(grid_view, std::forward<FunctorImps>(functors)...);
+}
+
+} // namespace Grid
+} // namespace Stuff
+} // namespace Dune
+
+#endif // HAVE_DUNE_GRID
+
+#endif // DUNE_STUFF_GRID_WALKER_STATIC_HH
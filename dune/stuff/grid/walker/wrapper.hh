@@ -13,6 +13,28 @@
 // nothing here will compile w/o grid present
 #if HAVE_DUNE_GRID
 
+#ifndef DUNE_STUFF_WALKER_DO_PROFILE
+#define DUNE_STUFF_WALKER_DO_PROFILE 0
+#endif
+
+#include <map>
+#include <set>
+#include <memory>
+#include <functional>
+
+#if DUNE_STUFF_WALKER_DO_PROFILE
+#include <chrono>
+#include <string>
+#endif
+
+#include <dune/stuff/common/memory.hh>
+
+#if DUNE_STUFF_WALKER_DO_PROFILE
+#include <dune/stuff/common/logging.hh>
+#include <dune/stuff/common/profiler.hh>
+#include <dune/stuff/common/parallel/threadstorage.hh>
+#endif
+
 #include "functors.hh"
 #include "apply-on.hh"
 
@@ -21,6 +43,42 @@ namespace Stuff {
 namespace Grid {
 namespace internal {
 
+/**
+ * \brief Copies of the functors for one worker of a parallel walk, indexed by the address of the original functor.
+ *
+ *        A Functor::Codim0And1 (or a Walker) is wrapped twice, once for each codim, but has to be copied only once.
+ */
+typedef std::map<const void*, std::shared_ptr<void>> FunctorCopiesType;
+
+//! the functors already joined in the course of joining two walkers, see FunctorCopiesType
+typedef std::set<const void*> JoinedFunctorsType;
+
+//! \return the copy of functor for the current worker, nullptr if functor does not support copying
+template <class FunctorType>
+std::shared_ptr<FunctorType> copy_once(const FunctorType& functor, FunctorCopiesType& copies)
+{
+  auto& functor_copy = copies[&functor];
+  if (!functor_copy)
+    functor_copy = std::shared_ptr<FunctorType>(functor.copy());
+  return std::static_pointer_cast<FunctorType>(functor_copy);
+}
+
+//! \see copy_once, but walkers always support copying
+template <class WalkerType>
+std::shared_ptr<WalkerType> copy_walker_once(const WalkerType& walker, FunctorCopiesType& copies)
+{
+  auto& walker_copy = copies[&walker];
+  if (!walker_copy)
+    walker_copy = std::make_shared<WalkerType>(walker, copies);
+  return std::static_pointer_cast<WalkerType>(walker_copy);
+}
+
+/**
+ * \brief Type erased functor as stored in a Walker.
+ *
+ *        All wrappers take ownership of the given ApplyOn filter, where nullptr selects all entities (intersections)
+ *        without the cost of an allocation or a virtual call.
+ */
 template <class GridViewType>
 class Codim0Object : public Functor::Codim0<GridViewType>
 {
@@ -34,12 +92,19 @@ public:
   }
 
   virtual bool apply_on(const GridViewType& grid_view, const EntityType& entity) const = 0;
+
+  //! copies the wrapped functor (if supported) for another worker of a parallel walk
+  virtual std::unique_ptr<Codim0Object<GridViewType>> copy(FunctorCopiesType& copies) const = 0;
+
+  //! joins the wrapped functor with the one wrapped by other, which has to be a copy of this
+  virtual void join(Codim0Object<GridViewType>& other, JoinedFunctorsType& joined) = 0;
 };
 
 template <class GridViewType, class Codim0FunctorType>
 class Codim0FunctorWrapper : public Codim0Object<GridViewType>
 {
   typedef Codim0Object<GridViewType> BaseType;
+  typedef Codim0FunctorWrapper<GridViewType, Codim0FunctorType> ThisType;
 
 public:
   typedef typename BaseType::EntityType EntityType;
@@ -61,7 +126,7 @@ public:
 
   virtual bool apply_on(const GridViewType& grid_view, const EntityType& entity) const override final
   {
-    return where_->apply_on(grid_view, entity);
+    return !where_ || where_->apply_on(grid_view, entity);
   }
 
   virtual void apply_local(const EntityType& entity) override final
@@ -74,9 +139,33 @@ public:
     wrapped_functor_.finalize();
   }
 
+  virtual std::unique_ptr<BaseType> copy(FunctorCopiesType& copies) const override final
+  {
+    const auto functor_copy = copy_once(wrapped_functor_, copies);
+    // functors which do not support copying are shared among all workers
+    return std::unique_ptr<BaseType>(
+        new ThisType(functor_copy, functor_copy ? *functor_copy : wrapped_functor_, where_));
+  }
+
+  virtual void join(BaseType& other, JoinedFunctorsType& joined) override final
+  {
+    auto& other_functor = static_cast<ThisType&>(other).wrapped_functor_;
+    if (&other_functor != &wrapped_functor_ && joined.insert(&wrapped_functor_).second)
+      wrapped_functor_.join(other_functor);
+  }
+
 private:
+  Codim0FunctorWrapper(std::shared_ptr<Codim0FunctorType> functor_copy, Codim0FunctorType& wrapped_functor,
+                       std::shared_ptr<const ApplyOn::WhichEntity<GridViewType>> where)
+    : functor_copy_(functor_copy)
+    , wrapped_functor_(wrapped_functor)
+    , where_(where)
+  {
+  }
+
+  const std::shared_ptr<Codim0FunctorType> functor_copy_;
   Codim0FunctorType& wrapped_functor_;
-  std::unique_ptr<const ApplyOn::WhichEntity<GridViewType>> where_;
+  const std::shared_ptr<const ApplyOn::WhichEntity<GridViewType>> where_;
 }; // class Codim0FunctorWrapper
 
 template <class GridViewType>
@@ -92,12 +181,19 @@ public:
   }
 
   virtual bool apply_on(const GridViewType& grid_view, const IntersectionType& intersection) const = 0;
+
+  //! \see Codim0Object::copy()
+  virtual std::unique_ptr<Codim1Object<GridViewType>> copy(FunctorCopiesType& copies) const = 0;
+
+  //! \see Codim0Object::join()
+  virtual void join(Codim1Object<GridViewType>& other, JoinedFunctorsType& joined) = 0;
 };
 
 template <class GridViewType, class Codim1FunctorType>
 class Codim1FunctorWrapper : public Codim1Object<GridViewType>
 {
   typedef Codim1Object<GridViewType> BaseType;
+  typedef Codim1FunctorWrapper<GridViewType, Codim1FunctorType> ThisType;
 
 public:
   typedef typename BaseType::EntityType EntityType;
@@ -116,7 +212,7 @@ public:
 
   virtual bool apply_on(const GridViewType& grid_view, const IntersectionType& intersection) const override final
   {
-    return where_->apply_on(grid_view, intersection);
+    return !where_ || where_->apply_on(grid_view, intersection);
   }
 
   virtual void apply_local(const IntersectionType& intersection, const EntityType& inside_entity,
@@ -130,33 +226,51 @@ public:
     wrapped_functor_.finalize();
   }
 
+  virtual std::unique_ptr<BaseType> copy(FunctorCopiesType& copies) const override final
+  {
+    const auto functor_copy = copy_once(wrapped_functor_, copies);
+    // functors which do not support copying are shared among all workers
+    return std::unique_ptr<BaseType>(
+        new ThisType(functor_copy, functor_copy ? *functor_copy : wrapped_functor_, where_));
+  }
+
+  virtual void join(BaseType& other, JoinedFunctorsType& joined) override final
+  {
+    auto& other_functor = static_cast<ThisType&>(other).wrapped_functor_;
+    if (&other_functor != &wrapped_functor_ && joined.insert(&wrapped_functor_).second)
+      wrapped_functor_.join(other_functor);
+  }
+
 private:
+  Codim1FunctorWrapper(std::shared_ptr<Codim1FunctorType> functor_copy, Codim1FunctorType& wrapped_functor,
+                       std::shared_ptr<const ApplyOn::WhichIntersection<GridViewType>> where)
+    : functor_copy_(functor_copy)
+    , wrapped_functor_(wrapped_functor)
+    , where_(where)
+  {
+  }
+
+  const std::shared_ptr<Codim1FunctorType> functor_copy_;
   Codim1FunctorType& wrapped_functor_;
-  std::unique_ptr<const ApplyOn::WhichIntersection<GridViewType>> where_;
+  const std::shared_ptr<const ApplyOn::WhichIntersection<GridViewType>> where_;
 }; // class Codim1FunctorWrapper
 
 template <class GridViewType, class WalkerType>
-class WalkerWrapper : public Codim0Object<GridViewType>, public Codim1Object<GridViewType>
+class Codim0WalkerWrapper : public Codim0Object<GridViewType>
 {
+  typedef Codim0Object<GridViewType> BaseType;
+  typedef Codim0WalkerWrapper<GridViewType, WalkerType> ThisType;
+
 public:
-  typedef typename Codim1Object<GridViewType>::EntityType EntityType;
-  typedef typename Codim1Object<GridViewType>::IntersectionType IntersectionType;
+  typedef typename BaseType::EntityType EntityType;
 
-  WalkerWrapper(WalkerType& grid_walker, const ApplyOn::WhichEntity<GridViewType>* which_entities)
+  Codim0WalkerWrapper(WalkerType& grid_walker, const ApplyOn::WhichEntity<GridViewType>* which_entities)
     : grid_walker_(grid_walker)
     , which_entities_(which_entities)
-    , which_intersections_(new ApplyOn::AllIntersections<GridViewType>())
   {
   }
 
-  WalkerWrapper(WalkerType& grid_walker, const ApplyOn::WhichIntersection<GridViewType>* which_intersections)
-    : grid_walker_(grid_walker)
-    , which_entities_(new ApplyOn::AllEntities<GridViewType>())
-    , which_intersections_(which_intersections)
-  {
-  }
-
-  virtual ~WalkerWrapper()
+  virtual ~Codim0WalkerWrapper()
   {
   }
 
@@ -167,17 +281,75 @@ public:
 
   virtual bool apply_on(const GridViewType& grid_view, const EntityType& entity) const override final
   {
-    return which_entities_->apply_on(grid_view, entity) && grid_walker_.apply_on(entity);
+    return (!which_entities_ || which_entities_->apply_on(grid_view, entity)) && grid_walker_.apply_on(entity);
   }
 
-  virtual bool apply_on(const GridViewType& grid_view, const IntersectionType& intersection) const override final
+  virtual void apply_local(const EntityType& entity) override final
   {
-    return which_intersections_->apply_on(grid_view, intersection) && grid_walker_.apply_on(intersection);
+    grid_walker_.apply_local(entity);
   }
 
-  virtual void apply_local(const EntityType& entity) override final
+  virtual void finalize() override final
   {
-    grid_walker_.apply_local(entity);
+    grid_walker_.finalize();
+  }
+
+  virtual std::unique_ptr<BaseType> copy(FunctorCopiesType& copies) const override final
+  {
+    auto walker_copy = copy_walker_once(grid_walker_, copies);
+    return std::unique_ptr<BaseType>(new ThisType(walker_copy, *walker_copy, which_entities_));
+  }
+
+  virtual void join(BaseType& other, JoinedFunctorsType& joined) override final
+  {
+    auto& other_walker = static_cast<ThisType&>(other).grid_walker_;
+    if (joined.insert(&grid_walker_).second)
+      grid_walker_.join(other_walker, joined);
+  }
+
+private:
+  Codim0WalkerWrapper(std::shared_ptr<WalkerType> walker_copy, WalkerType& grid_walker,
+                      std::shared_ptr<const ApplyOn::WhichEntity<GridViewType>> which_entities)
+    : walker_copy_(walker_copy)
+    , grid_walker_(grid_walker)
+    , which_entities_(which_entities)
+  {
+  }
+
+  const std::shared_ptr<WalkerType> walker_copy_;
+  WalkerType& grid_walker_;
+  const std::shared_ptr<const ApplyOn::WhichEntity<GridViewType>> which_entities_;
+}; // class Codim0WalkerWrapper
+
+template <class GridViewType, class WalkerType>
+class Codim1WalkerWrapper : public Codim1Object<GridViewType>
+{
+  typedef Codim1Object<GridViewType> BaseType;
+  typedef Codim1WalkerWrapper<GridViewType, WalkerType> ThisType;
+
+public:
+  typedef typename BaseType::EntityType EntityType;
+  typedef typename BaseType::IntersectionType IntersectionType;
+
+  Codim1WalkerWrapper(WalkerType& grid_walker, const ApplyOn::WhichIntersection<GridViewType>* which_intersections)
+    : grid_walker_(grid_walker)
+    , which_intersections_(which_intersections)
+  {
+  }
+
+  virtual ~Codim1WalkerWrapper()
+  {
+  }
+
+  virtual void prepare() override final
+  {
+    grid_walker_.prepare();
+  }
+
+  virtual bool apply_on(const GridViewType& grid_view, const IntersectionType& intersection) const override final
+  {
+    return (!which_intersections_ || which_intersections_->apply_on(grid_view, intersection))
+           && grid_walker_.apply_on(intersection);
   }
 
   virtual void apply_local(const IntersectionType& intersection, const EntityType& inside_entity,
@@ -191,16 +363,38 @@ public:
     grid_walker_.finalize();
   }
 
+  virtual std::unique_ptr<BaseType> copy(FunctorCopiesType& copies) const override final
+  {
+    auto walker_copy = copy_walker_once(grid_walker_, copies);
+    return std::unique_ptr<BaseType>(new ThisType(walker_copy, *walker_copy, which_intersections_));
+  }
+
+  virtual void join(BaseType& other, JoinedFunctorsType& joined) override final
+  {
+    auto& other_walker = static_cast<ThisType&>(other).grid_walker_;
+    if (joined.insert(&grid_walker_).second)
+      grid_walker_.join(other_walker, joined);
+  }
+
 private:
+  Codim1WalkerWrapper(std::shared_ptr<WalkerType> walker_copy, WalkerType& grid_walker,
+                      std::shared_ptr<const ApplyOn::WhichIntersection<GridViewType>> which_intersections)
+    : walker_copy_(walker_copy)
+    , grid_walker_(grid_walker)
+    , which_intersections_(which_intersections)
+  {
+  }
+
+  const std::shared_ptr<WalkerType> walker_copy_;
   WalkerType& grid_walker_;
-  std::unique_ptr<const ApplyOn::WhichEntity<GridViewType>> which_entities_;
-  std::unique_ptr<const ApplyOn::WhichIntersection<GridViewType>> which_intersections_;
-}; // class WalkerWrapper
+  const std::shared_ptr<const ApplyOn::WhichIntersection<GridViewType>> which_intersections_;
+}; // class Codim1WalkerWrapper
 
 template <class GridViewType>
 class Codim0LambdaWrapper : public Codim0Object<GridViewType>
 {
   typedef Codim0Object<GridViewType> BaseType;
+  typedef Codim0LambdaWrapper<GridViewType> ThisType;
 
 public:
   typedef typename BaseType::EntityType EntityType;
@@ -218,7 +412,7 @@ public:
 
   virtual bool apply_on(const GridViewType& grid_view, const EntityType& entity) const override final
   {
-    return where_->apply_on(grid_view, entity);
+    return !where_ || where_->apply_on(grid_view, entity);
   }
 
   virtual void apply_local(const EntityType& entity) override final
@@ -226,15 +420,32 @@ public:
     lambda_(entity);
   }
 
+  //! copies the lambda, state captured by reference is thus shared among all workers
+  virtual std::unique_ptr<BaseType> copy(FunctorCopiesType& /*copies*/) const override final
+  {
+    return std::unique_ptr<BaseType>(new ThisType(lambda_, where_));
+  }
+
+  virtual void join(BaseType& /*other*/, JoinedFunctorsType& /*joined*/) override final
+  {
+  }
+
 private:
+  Codim0LambdaWrapper(LambdaType lambda, std::shared_ptr<const ApplyOn::WhichEntity<GridViewType>> where)
+    : lambda_(lambda)
+    , where_(where)
+  {
+  }
+
   LambdaType lambda_;
-  std::unique_ptr<const ApplyOn::WhichEntity<GridViewType>> where_;
+  const std::shared_ptr<const ApplyOn::WhichEntity<GridViewType>> where_;
 }; // class Codim0LambdaWrapper
 
 template <class GridViewType>
 class Codim1LambdaWrapper : public Codim1Object<GridViewType>
 {
   typedef Codim1Object<GridViewType> BaseType;
+  typedef Codim1LambdaWrapper<GridViewType> ThisType;
 
 public:
   typedef typename BaseType::EntityType EntityType;
@@ -249,7 +460,7 @@ public:
 
   virtual bool apply_on(const GridViewType& grid_view, const IntersectionType& intersection) const override final
   {
-    return where_->apply_on(grid_view, intersection);
+    return !where_ || where_->apply_on(grid_view, intersection);
   }
 
   virtual void apply_local(const IntersectionType& intersection, const EntityType& inside_entity,
@@ -258,11 +469,203 @@ public:
     lambda_(intersection, inside_entity, outside_entity);
   }
 
+  //! copies the lambda, state captured by reference is thus shared among all workers
+  virtual std::unique_ptr<BaseType> copy(FunctorCopiesType& /*copies*/) const override final
+  {
+    return std::unique_ptr<BaseType>(new ThisType(lambda_, where_));
+  }
+
+  virtual void join(BaseType& /*other*/, JoinedFunctorsType& /*joined*/) override final
+  {
+  }
+
 private:
+  Codim1LambdaWrapper(LambdaType lambda, std::shared_ptr<const ApplyOn::WhichIntersection<GridViewType>> where)
+    : lambda_(lambda)
+    , where_(where)
+  {
+  }
+
   LambdaType lambda_;
-  std::unique_ptr<const ApplyOn::WhichIntersection<GridViewType>> where_;
+  const std::shared_ptr<const ApplyOn::WhichIntersection<GridViewType>> where_;
 }; // class Codim1FunctorWrapper
 
+#if DUNE_STUFF_WALKER_DO_PROFILE
+
+//! wall time and number of calls of one functor in one thread, see ProfiledCodim0Object
+struct FunctorStatistics
+{
+  FunctorStatistics()
+    : calls(0)
+    , time(0)
+  {
+  }
+
+  size_t calls;
+  std::chrono::steady_clock::duration time;
+}; // struct FunctorStatistics
+
+typedef PerThreadValue<FunctorStatistics> PerThreadFunctorStatisticsType;
+
+//! adds the statistics of all threads to the profiler section (the calls as its items, see Profiler::addItems())
+inline void report_functor_statistics(const std::string& section_name,
+                                      const PerThreadFunctorStatisticsType& statistics)
+{
+  const auto add = [](FunctorStatistics sum, const FunctorStatistics& other) {
+    sum.calls += other.calls;
+    sum.time += other.time;
+    return sum;
+  };
+  const auto total = statistics.accumulate(FunctorStatistics(), add);
+  const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(total.time).count();
+  const double seconds    = std::chrono::duration<double>(total.time).count();
+  DSC_PROFILER.addTiming(section_name, {{Common::TimingData::TimeType(milliseconds), 0, 0}});
+  DSC_PROFILER.addItems(section_name, total.calls);
+  DSC_LOG_DEBUG << section_name << ": " << total.calls << " calls in " << seconds << "s ("
+                << (seconds > 0 ? total.calls / seconds : 0.) << " per second)" << std::endl;
+} // ... report_functor_statistics(...)
+
+/**
+ * \brief Measures the time spent in the wrapped functor, enabled by DUNE_STUFF_WALKER_DO_PROFILE.
+ *
+ *        The statistics are collected per thread and shared among all copies of a parallel walk. They are reported to
+ *        the profiler in finalize(), in the section "Walker::<type of the functor> #<position in the walker>".
+ */
+template <class GridViewType>
+class ProfiledCodim0Object : public Codim0Object<GridViewType>
+{
+  typedef Codim0Object<GridViewType> BaseType;
+  typedef ProfiledCodim0Object<GridViewType> ThisType;
+
+public:
+  typedef typename BaseType::EntityType EntityType;
+
+  ProfiledCodim0Object(BaseType* wrapped, const std::string& section_name)
+    : wrapped_(wrapped)
+    , section_name_(section_name)
+    , statistics_(std::make_shared<PerThreadFunctorStatisticsType>())
+  {
+  }
+
+  virtual void prepare() override final
+  {
+    wrapped_->prepare();
+  }
+
+  virtual bool apply_on(const GridViewType& grid_view, const EntityType& entity) const override final
+  {
+    return wrapped_->apply_on(grid_view, entity);
+  }
+
+  virtual void apply_local(const EntityType& entity) override final
+  {
+    const auto start = std::chrono::steady_clock::now();
+    wrapped_->apply_local(entity);
+    auto& statistics = **statistics_;
+    statistics.time += std::chrono::steady_clock::now() - start;
+    ++statistics.calls;
+  }
+
+  virtual void finalize() override final
+  {
+    wrapped_->finalize();
+    report_functor_statistics(section_name_, *statistics_);
+  }
+
+  virtual std::unique_ptr<BaseType> copy(FunctorCopiesType& copies) const override final
+  {
+    return std::unique_ptr<BaseType>(new ThisType(wrapped_->copy(copies), section_name_, statistics_));
+  }
+
+  virtual void join(BaseType& other, JoinedFunctorsType& joined) override final
+  {
+    wrapped_->join(*static_cast<ThisType&>(other).wrapped_, joined);
+  }
+
+private:
+  ProfiledCodim0Object(std::unique_ptr<BaseType> wrapped, const std::string& section_name,
+                       std::shared_ptr<PerThreadFunctorStatisticsType> statistics)
+    : wrapped_(std::move(wrapped))
+    , section_name_(section_name)
+    , statistics_(statistics)
+  {
+  }
+
+  std::unique_ptr<BaseType> wrapped_;
+  const std::string section_name_;
+  const std::shared_ptr<PerThreadFunctorStatisticsType> statistics_;
+}; // class ProfiledCodim0Object
+
+//! \see ProfiledCodim0Object
+template <class GridViewType>
+class ProfiledCodim1Object : public Codim1Object<GridViewType>
+{
+  typedef Codim1Object<GridViewType> BaseType;
+  typedef ProfiledCodim1Object<GridViewType> ThisType;
+
+public:
+  typedef typename BaseType::EntityType EntityType;
+  typedef typename BaseType::IntersectionType IntersectionType;
+
+  ProfiledCodim1Object(BaseType* wrapped, const std::string& section_name)
+    : wrapped_(wrapped)
+    , section_name_(section_name)
+    , statistics_(std::make_shared<PerThreadFunctorStatisticsType>())
+  {
+  }
+
+  virtual void prepare() override final
+  {
+    wrapped_->prepare();
+  }
+
+  virtual bool apply_on(const GridViewType& grid_view, const IntersectionType& intersection) const override final
+  {
+    return wrapped_->apply_on(grid_view, intersection);
+  }
+
+  virtual void apply_local(const IntersectionType& intersection, const EntityType& inside_entity,
+                           const EntityType& outside_entity) override final
+  {
+    const auto start = std::chrono::steady_clock::now();
+    wrapped_->apply_local(intersection, inside_entity, outside_entity);
+    auto& statistics = **statistics_;
+    statistics.time += std::chrono::steady_clock::now() - start;
+    ++statistics.calls;
+  }
+
+  virtual void finalize() override final
+  {
+    wrapped_->finalize();
+    report_functor_statistics(section_name_, *statistics_);
+  }
+
+  virtual std::unique_ptr<BaseType> copy(FunctorCopiesType& copies) const override final
+  {
+    return std::unique_ptr<BaseType>(new ThisType(wrapped_->copy(copies), section_name_, statistics_));
+  }
+
+  virtual void join(BaseType& other, JoinedFunctorsType& joined) override final
+  {
+    wrapped_->join(*static_cast<ThisType&>(other).wrapped_, joined);
+  }
+
+private:
+  ProfiledCodim1Object(std::unique_ptr<BaseType> wrapped, const std::string& section_name,
+                       std::shared_ptr<PerThreadFunctorStatisticsType> statistics)
+    : wrapped_(std::move(wrapped))
+    , section_name_(section_name)
+    , statistics_(statistics)
+  {
+  }
+
+  std::unique_ptr<BaseType> wrapped_;
+  const std::string section_name_;
+  const std::shared_ptr<PerThreadFunctorStatisticsType> statistics_;
+}; // class ProfiledCodim1Object
+
+#endif // DUNE_STUFF_WALKER_DO_PROFILE
+
 } // namespace internal
 } // namespace Grid
 } // namespace Stuff
@@ -13,6 +13,7 @@
 #include "container/common.hh"
 #include "container/eigen.hh"
 #include "container/istl.hh"
+#include "container/pattern-cache.hh"
 
 #include <dune/stuff/common/logging.hh>
 
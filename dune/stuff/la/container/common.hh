@@ -394,6 +394,12 @@ public:
   {
   }
 
+  /// This constructors ignores the given pattern and initializes the matrix with 0.
+  CommonDenseMatrix(const size_t rr, const size_t cc, const SparsityPatternCSR& /*pattern*/)
+    : backend_(new BackendType(rr, cc, ScalarType(0)))
+  {
+  }
+
   CommonDenseMatrix(const ThisType& other)
     : backend_(other.backend_)
   {
@@ -11,6 +11,7 @@
 #ifndef DUNE_STUFF_LA_CONTAINER_EIGEN_SPARSE_HH
 #define DUNE_STUFF_LA_CONTAINER_EIGEN_SPARSE_HH
 
+#include <algorithm>
 #include <memory>
 #include <type_traits>
 #include <vector>
@@ -127,6 +128,31 @@ public:
     }
   } // EigenRowMajorSparseMatrix(...)
 
+  //! copies the CSR arrays of pattern_in into the compressed storage of the backend, see SparsityPatternBuilder
+  EigenRowMajorSparseMatrix(const size_t rr, const size_t cc, const SparsityPatternCSR& pattern_in)
+  {
+    typedef typename std::remove_reference<decltype(*std::declval<BackendType>().outerIndexPtr())>::type
+        EIGEN_storage_index;
+    if (pattern_in.size() != rr)
+      DUNE_THROW(Exceptions::shapes_do_not_match,
+                 "The size of the pattern (" << pattern_in.size() << ") does not match the number of rows of this ("
+                                             << rr
+                                             << ")!");
+    const auto& row_ptr = pattern_in.row_ptr();
+    const auto& col_idx = pattern_in.col_idx();
+    if (pattern_in.nonzeros() > 0 && *std::max_element(col_idx.begin(), col_idx.end()) >= cc)
+      DUNE_THROW(Exceptions::shapes_do_not_match,
+                 "The columns of the pattern do not match the number of columns of this (" << cc << ")!");
+    backend_ = std::make_shared<BackendType>(internal::boost_numeric_cast<EIGEN_size_t>(rr),
+                                             internal::boost_numeric_cast<EIGEN_size_t>(cc));
+    // checks that all indices fit into the index type of the backend
+    internal::boost_numeric_cast<EIGEN_storage_index>(std::max(pattern_in.nonzeros(), cc));
+    backend_->resizeNonZeros(internal::boost_numeric_cast<EIGEN_size_t>(pattern_in.nonzeros()));
+    std::copy(row_ptr.begin(), row_ptr.end(), backend_->outerIndexPtr());
+    std::copy(col_idx.begin(), col_idx.end(), backend_->innerIndexPtr());
+    std::fill(backend_->valuePtr(), backend_->valuePtr() + pattern_in.nonzeros(), ScalarType(0));
+  } // EigenRowMajorSparseMatrix(...)
+
   explicit EigenRowMajorSparseMatrix(const size_t rr = 0, const size_t cc = 0)
   {
     backend_ = std::make_shared<BackendType>(rr, cc);
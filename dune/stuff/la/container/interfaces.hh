@@ -13,5 +13,6 @@
 #include "container-interface.hh"
 #include "vector-interface.hh"
 #include "matrix-interface.hh"
+#include "operator-interface.hh"
 
 #endif // DUNE_STUFF_LA_CONTAINER_INTERFACES_HH
@@ -0,0 +1,257 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#ifndef DUNE_STUFF_LA_CONTAINER_ISTL_KERNELS_HH
+#define DUNE_STUFF_LA_CONTAINER_ISTL_KERNELS_HH
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <vector>
+
+#if HAVE_TBB
+#include <tbb/parallel_for.h>
+#endif
+
+#include <dune/common/ftraits.hh>
+
+#include <dune/stuff/common/parallel/threadmanager.hh>
+
+namespace Dune {
+namespace Stuff {
+namespace LA {
+namespace internal {
+
+/**
+ * \brief Splits the rows [0, size) into contiguous blocks which are processed by the threads of threadManager().
+ *
+ *        The split only depends on the size and the number of threads: reductions combine the partial results of the
+ *        blocks in a fixed order, so their results do not depend on the scheduling. Less than 2 * min_block_size rows
+ *        are not split (and do not query the thread manager), since the overhead would dominate.
+ */
+class RowBlocks
+{
+public:
+  static const constexpr size_t min_block_size = 8192;
+
+  explicit RowBlocks(const size_t size)
+    : size_(size)
+    , num_blocks_(size < 2 * min_block_size
+                      ? 1
+                      : std::max(size_t(1), std::min(4 * threadManager().max_threads(), size / min_block_size)))
+  {
+  }
+
+  size_t size() const
+  {
+    return num_blocks_;
+  }
+
+  size_t begin(const size_t bb) const
+  {
+    return (size_ * bb) / num_blocks_;
+  }
+
+  size_t end(const size_t bb) const
+  {
+    return begin(bb + 1);
+  }
+
+  //! calls functor(first_row, past_the_last_row) for each block
+  template <class FunctorType>
+  void apply(const FunctorType& functor) const
+  {
+    for_each_block([&](const size_t bb) { functor(begin(bb), end(bb)); });
+  }
+
+  //! combines the results of functor(first_row, past_the_last_row) of all blocks, in the order of the blocks
+  template <class ResultType, class FunctorType, class CombineType>
+  ResultType reduce(const FunctorType& functor, const CombineType& combine) const
+  {
+    std::vector<ResultType> partial_results(num_blocks_);
+    for_each_block([&](const size_t bb) { partial_results[bb] = functor(begin(bb), end(bb)); });
+    ResultType result = partial_results[0];
+    for (size_t bb = 1; bb < num_blocks_; ++bb)
+      result = combine(result, partial_results[bb]);
+    return result;
+  } // ... reduce(...)
+
+private:
+  template <class FunctorType>
+  void for_each_block(const FunctorType& functor) const
+  {
+#if HAVE_TBB
+    if (num_blocks_ > 1) {
+      tbb::parallel_for(size_t(0), num_blocks_, functor);
+      return;
+    }
+#endif
+    for (size_t bb = 0; bb < num_blocks_; ++bb)
+      functor(bb);
+  } // ... for_each_block(...)
+
+  const size_t size_;
+  const size_t num_blocks_;
+}; // class RowBlocks
+
+/**
+ * \brief Row block parallel kernels for the dune-istl containers.
+ *
+ *        The vector kernels work on the contiguous entries of a BlockVector< FieldVector< S, 1 > >, the matrix kernels
+ *        on the rows of a BCRSMatrix< FieldMatrix< S, 1, 1 > >. Like their dune-istl counterparts, dot() does not
+ *        conjugate. The matrix kernels require yy and xx to be distinct.
+ * \note  The kernels do not place memory on NUMA nodes: BlockVector value-initializes its entries on the allocating
+ *        thread, so the pages are first touched there, whoever writes them later.
+ */
+template <class S>
+struct IstlKernels
+{
+  typedef typename Dune::FieldTraits<S>::real_type R;
+
+  //! the first entry of a BlockVector< FieldVector< S, 1 > >, nullptr if it is empty
+  template <class VectorType>
+  static S* entries(VectorType& vector)
+  {
+    return vector.N() > 0 ? &(vector[0][0]) : nullptr;
+  }
+
+  template <class VectorType>
+  static const S* entries(const VectorType& vector)
+  {
+    return vector.N() > 0 ? &(vector[0][0]) : nullptr;
+  }
+
+  //! xx[ii] = value
+  static void fill(const size_t size, const S& value, S* xx)
+  {
+    RowBlocks(size).apply([&](const size_t first, const size_t last) { std::fill(xx + first, xx + last, value); });
+  }
+
+  //! xx *= alpha
+  static void scal(const size_t size, const S& alpha, S* xx)
+  {
+    RowBlocks(size).apply([&](const size_t first, const size_t last) {
+      for (size_t ii = first; ii < last; ++ii)
+        xx[ii] *= alpha;
+    });
+  }
+
+  //! yy += alpha * xx
+  static void axpy(const size_t size, const S& alpha, const S* xx, S* yy)
+  {
+    RowBlocks(size).apply([&](const size_t first, const size_t last) {
+      for (size_t ii = first; ii < last; ++ii)
+        yy[ii] += alpha * xx[ii];
+    });
+  }
+
+  //! result = xx + alpha * yy, result may be xx or yy
+  static void add(const size_t size, const S* xx, const S& alpha, const S* yy, S* result)
+  {
+    RowBlocks(size).apply([&](const size_t first, const size_t last) {
+      for (size_t ii = first; ii < last; ++ii)
+        result[ii] = xx[ii] + alpha * yy[ii];
+    });
+  }
+
+  static S dot(const size_t size, const S* xx, const S* yy)
+  {
+    return RowBlocks(size).template reduce<S>(
+        [&](const size_t first, const size_t last) {
+          S sum(0);
+          for (size_t ii = first; ii < last; ++ii)
+            sum += xx[ii] * yy[ii];
+          return sum;
+        },
+        std::plus<S>());
+  } // ... dot(...)
+
+  static R l1_norm(const size_t size, const S* xx)
+  {
+    return RowBlocks(size).template reduce<R>(
+        [&](const size_t first, const size_t last) {
+          R sum(0);
+          for (size_t ii = first; ii < last; ++ii)
+            sum += std::abs(xx[ii]);
+          return sum;
+        },
+        std::plus<R>());
+  } // ... l1_norm(...)
+
+  static R l2_norm(const size_t size, const S* xx)
+  {
+    return std::sqrt(RowBlocks(size).template reduce<R>(
+        [&](const size_t first, const size_t last) {
+          R sum(0);
+          for (size_t ii = first; ii < last; ++ii)
+            sum += std::norm(xx[ii]);
+          return sum;
+        },
+        std::plus<R>()));
+  } // ... l2_norm(...)
+
+  //! NaN if any entry is NaN, so that checks of residuals catch it
+  static R sup_norm(const size_t size, const S* xx)
+  {
+    return RowBlocks(size).template reduce<R>(
+        [&](const size_t first, const size_t last) {
+          R max(0);
+          for (size_t ii = first; ii < last; ++ii)
+            max = nan_max(max, R(std::abs(xx[ii])));
+          return max;
+        },
+        nan_max);
+  } // ... sup_norm(...)
+
+  //! yy = A * xx
+  template <class MatrixType>
+  static void mv(const MatrixType& matrix, const S* xx, S* yy)
+  {
+    RowBlocks(matrix.N()).apply([&](const size_t first, const size_t last) {
+      for (size_t ii = first; ii < last; ++ii)
+        yy[ii] = row_times(matrix[ii], xx);
+    });
+  }
+
+  //! yy += alpha * A * xx
+  template <class MatrixType>
+  static void usmv(const MatrixType& matrix, const S& alpha, const S* xx, S* yy)
+  {
+    RowBlocks(matrix.N()).apply([&](const size_t first, const size_t last) {
+      for (size_t ii = first; ii < last; ++ii)
+        yy[ii] += alpha * row_times(matrix[ii], xx);
+    });
+  }
+
+private:
+  //! std::max drops NaNs, depending on the order of the arguments
+  static R nan_max(const R& left, const R& right)
+  {
+    if (std::isnan(left))
+      return left;
+    if (std::isnan(right))
+      return right;
+    return std::max(left, right);
+  }
+
+  template <class RowType>
+  static S row_times(const RowType& row, const S* xx)
+  {
+    S sum(0);
+    for (auto it = row.begin(); it != row.end(); ++it)
+      sum += (*it)[0][0] * xx[it.index()];
+    return sum;
+  }
+}; // struct IstlKernels
+
+} // namespace internal
+} // namespace LA
+} // namespace Stuff
+} // namespace Dune
+
+#endif // DUNE_STUFF_LA_CONTAINER_ISTL_KERNELS_HH
@@ -33,6 +33,7 @@
 #include <dune/stuff/common/math.hh>
 
 #include "interfaces.hh"
+#include "istl-kernels.hh"
 #include "pattern.hh"
 
 namespace Dune {
@@ -88,6 +89,7 @@ class IstlDenseVector : public VectorInterface<internal::IstlDenseVectorTraits<S
 {
   typedef IstlDenseVector<ScalarImp> ThisType;
   typedef VectorInterface<internal::IstlDenseVectorTraits<ScalarImp>, ScalarImp> VectorInterfaceType;
+  typedef internal::IstlKernels<ScalarImp> Kernels;
   static_assert(!std::is_same<DUNE_STUFF_SSIZE_T, int>::value,
                 "You have to manually disable the constructor below which uses DUNE_STUFF_SSIZE_T!");
 
@@ -100,7 +102,7 @@ public:
   explicit IstlDenseVector(const size_t ss = 0, const ScalarType value = ScalarType(0))
     : backend_(new BackendType(ss))
   {
-    backend_->operator=(value);
+    Kernels::fill(ss, value, entries());
   }
 
   /// This constructor is needed for the python bindings.
@@ -211,7 +213,7 @@ public:
 
   void scal(const ScalarType& alpha)
   {
-    backend() *= alpha;
+    Kernels::scal(size(), alpha, entries());
   }
 
   void axpy(const ScalarType& alpha, const ThisType& xx)
@@ -219,7 +221,7 @@ public:
     if (xx.size() != size())
       DUNE_THROW(Exceptions::shapes_do_not_match,
                  "The size of x (" << xx.size() << ") does not match the size of this (" << size() << ")!");
-    backend().axpy(alpha, *(xx.backend_));
+    Kernels::axpy(size(), alpha, xx.entries(), entries());
   }
 
   bool has_equal_shape(const ThisType& other) const
@@ -268,6 +270,17 @@ private:
     return backend_->operator[](ii)[0];
   }
 
+  //! the entries of a BlockVector< FieldVector< S, 1 > > are contiguous, see ProvidesDataAccess
+  inline ScalarType* entries()
+  {
+    return size() > 0 ? &(backend()[0][0]) : nullptr;
+  }
+
+  inline const ScalarType* entries() const
+  {
+    return size() > 0 ? &(backend_->operator[](0)[0]) : nullptr;
+  }
+
 public:
   /// \}
   /// \name These methods override default implementations from VectorInterface..
@@ -278,22 +291,22 @@ public:
     if (other.size() != size())
       DUNE_THROW(Exceptions::shapes_do_not_match,
                  "The size of other (" << other.size() << ") does not match the size of this (" << size() << ")!");
-    return backend_->dot(*(other.backend_));
+    return Kernels::dot(size(), entries(), other.entries());
   } // ... dot(...)
 
   virtual RealType l1_norm() const override final
   {
-    return backend_->one_norm();
+    return Kernels::l1_norm(size(), entries());
   }
 
   virtual RealType l2_norm() const override final
   {
-    return backend_->two_norm();
+    return Kernels::l2_norm(size(), entries());
   }
 
   virtual RealType sup_norm() const override final
   {
-    return backend_->infinity_norm();
+    return Kernels::sup_norm(size(), entries());
   }
 
   virtual void add(const ThisType& other, ThisType& result) const override final
@@ -304,8 +317,7 @@ public:
     if (result.size() != size())
       DUNE_THROW(Exceptions::shapes_do_not_match,
                  "The size of result (" << result.size() << ") does not match the size of this (" << size() << ")!");
-    result.backend() = *(backend_);
-    result.backend() += *(other.backend_);
+    Kernels::add(size(), entries(), ScalarType(1), other.entries(), result.entries());
   } // ... add(...)
 
   virtual ThisType add(const ThisType& other) const override final
@@ -313,8 +325,8 @@ public:
     if (other.size() != size())
       DUNE_THROW(Exceptions::shapes_do_not_match,
                  "The size of other (" << other.size() << ") does not match the size of this (" << size() << ")!");
-    ThisType result = copy();
-    result.backend_->operator+=(*(other.backend_));
+    ThisType result(size());
+    Kernels::add(size(), entries(), ScalarType(1), other.entries(), result.entries());
     return result;
   } // ... add(...)
 
@@ -323,7 +335,7 @@ public:
     if (other.size() != size())
       DUNE_THROW(Exceptions::shapes_do_not_match,
                  "The size of other (" << other.size() << ") does not match the size of this (" << size() << ")!");
-    backend() += *(other.backend_);
+    Kernels::axpy(size(), ScalarType(1), other.entries(), entries());
   } // ... iadd(...)
 
   virtual void sub(const ThisType& other, ThisType& result) const override final
@@ -334,8 +346,7 @@ public:
     if (result.size() != size())
       DUNE_THROW(Exceptions::shapes_do_not_match,
                  "The size of result (" << result.size() << ") does not match the size of this (" << size() << ")!");
-    result.backend() = *(backend_);
-    result.backend() -= *(other.backend_);
+    Kernels::add(size(), entries(), ScalarType(-1), other.entries(), result.entries());
   } // ... sub(...)
 
   virtual ThisType sub(const ThisType& other) const override final
@@ -343,8 +354,8 @@ public:
     if (other.size() != size())
       DUNE_THROW(Exceptions::shapes_do_not_match,
                  "The size of other (" << other.size() << ") does not match the size of this (" << size() << ")!");
-    ThisType result = copy();
-    result.backend_->operator-=(*(other.backend_));
+    ThisType result(size());
+    Kernels::add(size(), entries(), ScalarType(-1), other.entries(), result.entries());
     return result;
   } // ... sub(...)
 
@@ -353,7 +364,7 @@ public:
     if (other.size() != size())
       DUNE_THROW(Exceptions::shapes_do_not_match,
                  "The size of other (" << other.size() << ") does not match the size of this (" << size() << ")!");
-    backend() -= (*(other.backend_));
+    Kernels::axpy(size(), ScalarType(-1), other.entries(), entries());
   } // ... isub(...)
 
   /// \}
@@ -409,6 +420,17 @@ public:
     backend_->operator*=(ScalarType(0));
   } // ... IstlRowMajorSparseMatrix(...)
 
+  //! creates the sparse matrix from the CSR arrays of patt, see SparsityPatternBuilder
+  IstlRowMajorSparseMatrix(const size_t rr, const size_t cc, const SparsityPatternCSR& patt)
+  {
+    if (patt.size() != rr)
+      DUNE_THROW(Exceptions::shapes_do_not_match,
+                 "The size of the pattern (" << patt.size() << ") does not match the number of rows of this (" << rr
+                                             << ")!");
+    build_sparse_matrix(rr, cc, patt);
+    backend_->operator*=(ScalarType(0));
+  } // ... IstlRowMajorSparseMatrix(...)
+
   explicit IstlRowMajorSparseMatrix(const size_t rr = 0, const size_t cc = 0)
     : backend_(new BackendType(rr, cc, BackendType::row_wise))
   {
@@ -540,8 +562,9 @@ public:
 
   inline void mv(const IstlDenseVector<ScalarType>& xx, IstlDenseVector<ScalarType>& yy) const
   {
-    DUNE_STUFF_PROFILE_SCOPE(static_id() + ".mv");
-    backend_->mv(*(xx.backend_), yy.backend());
+    DUNE_STUFF_PROFILE_SCOPE_STATIC(static_id() + ".mv");
+    assert(xx.size() == cols() && yy.size() == rows());
+    internal::IstlKernels<ScalarType>::mv(*backend_, xx.entries(), yy.entries());
   }
 
   void add_to_entry(const size_t ii, const size_t jj, const ScalarType& value)
@@ -681,7 +704,7 @@ public:
 private:
   void build_sparse_matrix(const size_t rr, const size_t cc, const SparsityPatternDefault& patt)
   {
-    DUNE_STUFF_PROFILE_SCOPE(static_id() + ".build");
+    DUNE_STUFF_PROFILE_SCOPE_STATIC(static_id() + ".build");
     backend_ = std::make_shared<BackendType>(rr, cc, BackendType::random);
     for (size_t ii = 0; ii < patt.size(); ++ii)
       backend_->setrowsize(ii, patt.inner(ii).size());
@@ -692,6 +715,21 @@ private:
     backend_->endindices();
   } // ... build_sparse_matrix(...)
 
+  void build_sparse_matrix(const size_t rr, const size_t cc, const SparsityPatternCSR& patt)
+  {
+    DUNE_STUFF_PROFILE_SCOPE_STATIC(static_id() + ".build");
+    const auto& row_ptr = patt.row_ptr();
+    backend_ = std::make_shared<BackendType>(rr, cc, BackendType::random);
+    for (size_t ii = 0; ii < rr; ++ii)
+      backend_->setrowsize(ii, row_ptr[ii + 1] - row_ptr[ii]);
+    backend_->endrowsizes();
+    // the columns are sorted already, so each addindex() only appends
+    for (size_t ii = 0; ii < rr; ++ii)
+      for (auto it = patt.begin(ii); it != patt.end(ii); ++it)
+        backend_->addindex(ii, *it);
+    backend_->endindices();
+  } // ... build_sparse_matrix(...)
+
   SparsityPatternDefault
   pruned_pattern_from_backend(const BackendType& mat,
                               const typename Common::FloatCmp::DefaultEpsilon<ScalarType>::Type eps =
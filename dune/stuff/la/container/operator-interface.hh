@@ -0,0 +1,96 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#ifndef DUNE_STUFF_LA_CONTAINER_OPERATOR_INTERFACE_HH
+#define DUNE_STUFF_LA_CONTAINER_OPERATOR_INTERFACE_HH
+
+#include <cstddef>
+
+namespace Dune {
+namespace Stuff {
+namespace LA {
+
+/**
+ * \brief Interface for linear operators which are only known by their application to a vector.
+ *
+ *        Stencil or sum factorized operators implement apply() without ever assembling a matrix. The iterative solvers
+ *        of LA::Solver< LinearOperatorInterface< VectorType > > (see la/solver/istl.hh and la/solver/eigen.hh) only
+ *        call apply(), so for
+\code
+class Laplace1d : public LinearOperatorInterface<EigenDenseVector<double>>
+{
+  ...
+  void apply(const VectorType& xx, VectorType& yy) const override final { ... }
+};
+\endcode
+ *        the system can be solved by Solver<LinearOperatorInterface<EigenDenseVector<double>>>(laplace).apply(rhs, x).
+ */
+template <class VectorImp>
+class LinearOperatorInterface
+{
+public:
+  typedef VectorImp VectorType;
+  typedef typename VectorType::ScalarType ScalarType;
+  typedef typename VectorType::RealType RealType;
+
+  virtual ~LinearOperatorInterface()
+  {
+  }
+
+  virtual size_t rows() const = 0;
+
+  virtual size_t cols() const = 0;
+
+  /**
+   * \brief computes yy = A xx, where yy is already of the correct size
+   * \note  yy is to be written in place (e.g. by yy[ii] = ... or yy.backend() = ...), assigning another vector to yy
+   *        may only rebind its storage, which the solver adapters then have to copy back.
+   */
+  virtual void apply(const VectorType& xx, VectorType& yy) const = 0;
+}; // class LinearOperatorInterface
+
+/**
+ * \brief Presents an assembled matrix as a LinearOperatorInterface, e.g. to compare a matrix-free operator with it.
+ */
+template <class MatrixImp, class VectorImp>
+class MatrixOperator : public LinearOperatorInterface<VectorImp>
+{
+  typedef LinearOperatorInterface<VectorImp> BaseType;
+
+public:
+  typedef MatrixImp MatrixType;
+  using typename BaseType::VectorType;
+
+  explicit MatrixOperator(const MatrixType& matrix)
+    : matrix_(matrix)
+  {
+  }
+
+  virtual size_t rows() const override final
+  {
+    return matrix_.rows();
+  }
+
+  virtual size_t cols() const override final
+  {
+    return matrix_.cols();
+  }
+
+  virtual void apply(const VectorType& xx, VectorType& yy) const override final
+  {
+    matrix_.mv(xx, yy);
+  }
+
+private:
+  const MatrixType& matrix_;
+}; // class MatrixOperator
+
+} // namespace LA
+} // namespace Stuff
+} // namespace Dune
+
+#endif // DUNE_STUFF_LA_CONTAINER_OPERATOR_INTERFACE_HH
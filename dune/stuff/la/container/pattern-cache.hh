@@ -0,0 +1,116 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#ifndef DUNE_STUFF_LA_CONTAINER_PATTERN_CACHE_HH
+#define DUNE_STUFF_LA_CONTAINER_PATTERN_CACHE_HH
+
+#include <list>
+#include <mutex>
+#include <type_traits>
+
+#include <boost/noncopyable.hpp>
+
+#include <dune/common/unused.hh>
+
+#include "pattern.hh"
+
+namespace Dune {
+namespace Stuff {
+namespace LA {
+
+/**
+ * \brief Creates matrices from sparsity patterns, building the index structure only once for equal patterns.
+ *
+ *        Deriving the index structure of a sparse backend from a pattern dominates the construction of small matrices,
+ *        while e.g. local problems of multiscale methods use the same pattern over and over. create() recognizes equal
+ *        patterns by their fingerprint (and a full comparison) and returns a copy of a zero prototype matrix for known
+ *        ones. The copy shares the backend of the prototype until it is first written to, when the container copies
+ *        the backend (see ensure_uniqueness() of the containers), allocating its own values and copying the index
+ *        structure in one go instead of rebuilding it. The max_size most recently used patterns are kept.
+\code
+MatrixPatternCache<IstlRowMajorSparseMatrix<double>> cache;
+for (...) {
+  auto local_matrix = cache.create(rows, cols, local_pattern);
+  ...
+}
+\endcode
+ * \note create() is thread safe.
+ */
+template <class MatrixImp>
+class MatrixPatternCache : public boost::noncopyable
+{
+public:
+  typedef MatrixImp MatrixType;
+
+  explicit MatrixPatternCache(const size_t max_size = 16)
+    : max_size_(max_size)
+  {
+  }
+
+  template <class PatternType>
+  MatrixType create(const size_t rr, const size_t cc, const PatternType& pattern)
+  {
+    static_assert(std::is_same<PatternType, SparsityPatternDefault>::value
+                      || std::is_same<PatternType, SparsityPatternCSR>::value,
+                  "PatternType has to be a SparsityPatternDefault or a SparsityPatternCSR!");
+    const bool from_csr = std::is_same<PatternType, SparsityPatternCSR>::value;
+    SparsityPatternCSR csr_pattern(pattern);
+    const size_t fingerprint = csr_pattern.fingerprint();
+    {
+      std::lock_guard<std::mutex> DUNE_UNUSED(guard)(mutex_);
+      for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->fingerprint == fingerprint && it->rows == rr && it->cols == cc && it->from_csr == from_csr
+            && it->pattern == csr_pattern) {
+          entries_.splice(entries_.begin(), entries_, it);
+          return MatrixType(entries_.front().prototype);
+        }
+      }
+    }
+    Entry entry{fingerprint, rr, cc, from_csr, std::move(csr_pattern), MatrixType(rr, cc, pattern)};
+    MatrixType ret(entry.prototype);
+    std::lock_guard<std::mutex> DUNE_UNUSED(guard)(mutex_);
+    entries_.push_front(std::move(entry));
+    if (entries_.size() > max_size_)
+      entries_.pop_back();
+    return ret;
+  } // ... create(...)
+
+  size_t size() const
+  {
+    std::lock_guard<std::mutex> DUNE_UNUSED(guard)(mutex_);
+    return entries_.size();
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> DUNE_UNUSED(guard)(mutex_);
+    entries_.clear();
+  }
+
+private:
+  struct Entry
+  {
+    size_t fingerprint;
+    size_t rows;
+    size_t cols;
+    //! the Eigen backend treats empty rows of both pattern types differently
+    bool from_csr;
+    SparsityPatternCSR pattern;
+    MatrixType prototype;
+  };
+
+  const size_t max_size_;
+  //! most recently used first
+  std::list<Entry> entries_;
+  mutable std::mutex mutex_;
+}; // class MatrixPatternCache
+
+} // namespace LA
+} // namespace Stuff
+} // namespace Dune
+
+#endif // DUNE_STUFF_LA_CONTAINER_PATTERN_CACHE_HH
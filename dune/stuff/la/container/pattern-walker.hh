@@ -0,0 +1,113 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#ifndef DUNE_STUFF_LA_CONTAINER_PATTERN_WALKER_HH
+#define DUNE_STUFF_LA_CONTAINER_PATTERN_WALKER_HH
+
+// nothing here will compile w/o grid present
+#if HAVE_DUNE_GRID
+
+#include <functional>
+
+#include <dune/stuff/grid/walker/functors.hh>
+
+#include "pattern.hh"
+
+namespace Dune {
+namespace Stuff {
+namespace Grid {
+namespace Functor {
+
+/**
+ * \brief Assembles a sparsity pattern in a (parallel) walk, see LA::ParallelSparsityPatternBuilder.
+ *
+ *        The given lambdas insert the couplings of each entity and intersection into the builder. The functor is shared
+ *        by all workers of a parallel walk, so the pattern can be built in the same traversal as other quantities. It
+ *        is available as pattern() after the walk.
+\code
+typedef Functor::SparsityPattern<GridViewType> PatternFunctorType;
+PatternFunctorType pattern_functor(mapper.size(),
+                                   [&](const EntityType& entity, PatternFunctorType::BuilderType& builder) {
+                                     const auto indices = mapper.globalIndices(entity);
+                                     for (const auto& ii : indices)
+                                       builder.insert(ii, indices.begin(), indices.end());
+                                   });
+walker.add(pattern_functor);
+walker.walk(true);
+\endcode
+ */
+template <class GridViewImp>
+class SparsityPattern : public Codim0And1<GridViewImp>
+{
+  typedef Codim0And1<GridViewImp> BaseType;
+
+public:
+  typedef typename BaseType::GridViewType GridViewType;
+  typedef typename BaseType::EntityType EntityType;
+  typedef typename BaseType::IntersectionType IntersectionType;
+  typedef LA::ParallelSparsityPatternBuilder BuilderType;
+  typedef std::function<void(const EntityType&, BuilderType&)> EntityLambdaType;
+  typedef std::function<void(const IntersectionType&, const EntityType&, const EntityType&, BuilderType&)>
+      IntersectionLambdaType;
+
+  SparsityPattern(const size_t rows, EntityLambdaType entity_lambda,
+                  IntersectionLambdaType intersection_lambda = IntersectionLambdaType())
+    : builder_(rows)
+    , entity_lambda_(entity_lambda)
+    , intersection_lambda_(intersection_lambda)
+    , pattern_(rows)
+    , finalized_(true)
+  {
+  }
+
+  virtual void prepare() override
+  {
+    finalized_ = false;
+  }
+
+  virtual void apply_local(const EntityType& entity) override
+  {
+    if (entity_lambda_)
+      entity_lambda_(entity, builder_);
+  }
+
+  virtual void apply_local(const IntersectionType& intersection, const EntityType& inside_entity,
+                           const EntityType& outside_entity) override
+  {
+    if (intersection_lambda_)
+      intersection_lambda_(intersection, inside_entity, outside_entity, builder_);
+  }
+
+  //! \note called twice by the Walker (for codim 0 and codim 1)
+  virtual void finalize() override
+  {
+    if (!finalized_)
+      pattern_ = builder_.finalize();
+    finalized_ = true;
+  }
+
+  const LA::SparsityPatternCSR& pattern() const
+  {
+    return pattern_;
+  }
+
+private:
+  BuilderType builder_;
+  const EntityLambdaType entity_lambda_;
+  const IntersectionLambdaType intersection_lambda_;
+  LA::SparsityPatternCSR pattern_;
+  bool finalized_;
+}; // class SparsityPattern
+
+} // namespace Functor
+} // namespace Grid
+} // namespace Stuff
+} // namespace Dune
+
+#endif // HAVE_DUNE_GRID
+
+#endif // DUNE_STUFF_LA_CONTAINER_PATTERN_WALKER_HH
@@ -11,10 +11,34 @@
 
 #include <cassert>
 #include <algorithm>
+#include <utility>
+
+#include <boost/functional/hash.hpp>
+
+#if HAVE_TBB
+#include <tbb/parallel_for.h>
+#endif
+
+#include <dune/stuff/common/parallel/threadmanager.hh>
 
 namespace Dune {
 namespace Stuff {
 namespace LA {
+namespace internal {
+
+//! calls functor(ii) for ii in [0, size), in parallel if TBB is available
+template <class FunctorType>
+static void parallel_for_each_index(const size_t size, const FunctorType& functor)
+{
+#if HAVE_TBB
+  tbb::parallel_for(size_t(0), size, functor);
+#else
+  for (size_t ii = 0; ii < size; ++ii)
+    functor(ii);
+#endif
+}
+
+} // namespace internal
 
 // ================================
 // ==== SparsityPatternDefault ====
@@ -81,6 +105,211 @@ void SparsityPatternDefault::sort()
     std::sort(inner_vector.begin(), inner_vector.end());
 }
 
+size_t SparsityPatternDefault::fingerprint() const
+{
+  return SparsityPatternCSR(*this).fingerprint();
+}
+
+// ============================
+// ==== SparsityPatternCSR ====
+// ============================
+SparsityPatternCSR::SparsityPatternCSR(const size_t _size)
+  : row_ptr_(_size + 1, 0)
+{
+}
+
+SparsityPatternCSR::SparsityPatternCSR(IndicesType&& _row_ptr, IndicesType&& _col_idx)
+  : row_ptr_(std::move(_row_ptr))
+  , col_idx_(std::move(_col_idx))
+{
+  if (row_ptr_.empty() || row_ptr_.front() != 0 || row_ptr_.back() != col_idx_.size())
+    DUNE_THROW(Exceptions::wrong_input_given,
+               "row_ptr has to start with 0 and end with the size of col_idx (" << col_idx_.size() << ")!");
+  assert(std::is_sorted(row_ptr_.begin(), row_ptr_.end()));
+}
+
+SparsityPatternCSR::SparsityPatternCSR(const SparsityPatternDefault& other)
+  : row_ptr_(other.size() + 1, 0)
+{
+  for (size_t ii = 0; ii < other.size(); ++ii)
+    row_ptr_[ii + 1] = row_ptr_[ii] + other.inner(ii).size();
+  col_idx_.resize(row_ptr_.back());
+  for (size_t ii = 0; ii < other.size(); ++ii) {
+    const auto row_begin = col_idx_.begin() + row_ptr_[ii];
+    std::copy(other.inner(ii).begin(), other.inner(ii).end(), row_begin);
+    std::sort(row_begin, col_idx_.begin() + row_ptr_[ii + 1]);
+  }
+} // SparsityPatternCSR(...)
+
+size_t SparsityPatternCSR::size() const
+{
+  return row_ptr_.size() - 1;
+}
+
+size_t SparsityPatternCSR::nonzeros() const
+{
+  return col_idx_.size();
+}
+
+const typename SparsityPatternCSR::IndicesType& SparsityPatternCSR::row_ptr() const
+{
+  return row_ptr_;
+}
+
+const typename SparsityPatternCSR::IndicesType& SparsityPatternCSR::col_idx() const
+{
+  return col_idx_;
+}
+
+typename SparsityPatternCSR::ConstInnerIteratorType SparsityPatternCSR::begin(const size_t ii) const
+{
+  assert(ii < size() && "Wrong index requested!");
+  return col_idx_.begin() + row_ptr_[ii];
+}
+
+typename SparsityPatternCSR::ConstInnerIteratorType SparsityPatternCSR::end(const size_t ii) const
+{
+  assert(ii < size() && "Wrong index requested!");
+  return col_idx_.begin() + row_ptr_[ii + 1];
+}
+
+size_t SparsityPatternCSR::fingerprint() const
+{
+  size_t seed = boost::hash_range(row_ptr_.begin(), row_ptr_.end());
+  boost::hash_combine(seed, boost::hash_range(col_idx_.begin(), col_idx_.end()));
+  return seed;
+}
+
+bool SparsityPatternCSR::operator==(const SparsityPatternCSR& other) const
+{
+  return row_ptr_ == other.row_ptr_ && col_idx_ == other.col_idx_;
+}
+
+bool SparsityPatternCSR::operator!=(const SparsityPatternCSR& other) const
+{
+  return !(*this == other);
+}
+
+// ================================
+// ==== SparsityPatternBuilder ====
+// ================================
+SparsityPatternBuilder::SparsityPatternBuilder(const size_t _size)
+  : row_ptr_(_size + 1, 0)
+  , allocated_(false)
+{
+}
+
+size_t SparsityPatternBuilder::size() const
+{
+  return row_ptr_.size() - 1;
+}
+
+void SparsityPatternBuilder::count(const size_t row, const size_t num_entries)
+{
+  assert(!allocated_ && "Counting is over after allocate()!");
+  assert(row < size() && "Wrong index requested!");
+  row_ptr_[row + 1] += num_entries;
+}
+
+void SparsityPatternBuilder::allocate()
+{
+  assert(!allocated_ && "Call allocate() only once!");
+  for (size_t ii = 0; ii < size(); ++ii)
+    row_ptr_[ii + 1] += row_ptr_[ii];
+  col_idx_.resize(row_ptr_.back());
+  fill_.assign(row_ptr_.begin(), row_ptr_.end() - 1);
+  allocated_ = true;
+} // ... allocate(...)
+
+SparsityPatternCSR SparsityPatternBuilder::finalize()
+{
+  if (!allocated_)
+    allocate();
+  // rows only shrink, so each one can be moved to its final position in place
+  size_t next = 0;
+  for (size_t ii = 0; ii < size(); ++ii) {
+    const auto row_begin = col_idx_.begin() + row_ptr_[ii];
+    std::sort(row_begin, col_idx_.begin() + fill_[ii]);
+    const auto row_end = std::unique(row_begin, col_idx_.begin() + fill_[ii]);
+    row_ptr_[ii]       = next;
+    next = std::copy(row_begin, row_end, col_idx_.begin() + next) - col_idx_.begin();
+  }
+  row_ptr_.back() = next;
+  col_idx_.resize(next);
+  col_idx_.shrink_to_fit();
+  fill_.clear();
+  allocated_ = false;
+  SparsityPatternCSR ret(std::move(row_ptr_), std::move(col_idx_));
+  row_ptr_.assign(ret.size() + 1, 0);
+  col_idx_.clear();
+  return ret;
+} // ... finalize(...)
+
+// ========================================
+// ==== ParallelSparsityPatternBuilder ====
+// ========================================
+ParallelSparsityPatternBuilder::ParallelSparsityPatternBuilder(const size_t _size)
+  : size_(_size)
+  , fragments_(FragmentsType())
+{
+}
+
+size_t ParallelSparsityPatternBuilder::size() const
+{
+  return size_;
+}
+
+SparsityPatternCSR ParallelSparsityPatternBuilder::finalize()
+{
+  std::vector<FragmentsType*> fragments;
+  fragments_.for_each([&](FragmentsType& thread_fragments) {
+    if (!thread_fragments.empty())
+      fragments.push_back(&thread_fragments);
+  });
+  // sort each buffer by rows and columns
+  internal::parallel_for_each_index(fragments.size(), [&](const size_t ff) {
+    auto& thread_fragments = *fragments[ff];
+    std::sort(thread_fragments.begin(), thread_fragments.end());
+    thread_fragments.erase(std::unique(thread_fragments.begin(), thread_fragments.end()), thread_fragments.end());
+  });
+  // merge the buffers by blocks of rows, each block finds its part of each buffer by bisection
+  const size_t num_blocks = std::min(size_, 4 * threadManager().max_threads());
+  std::vector<std::vector<size_t>> block_columns(num_blocks);
+  std::vector<size_t> row_ptr(size_ + 1, 0);
+  const auto block_begin = [&](const size_t bb) { return (size_ * bb) / num_blocks; };
+  internal::parallel_for_each_index(num_blocks, [&](const size_t bb) {
+    const size_t first_row = block_begin(bb);
+    const size_t last_row  = block_begin(bb + 1);
+    std::vector<FragmentsType::const_iterator> positions;
+    for (const auto& thread_fragments : fragments)
+      positions.push_back(std::lower_bound(
+          thread_fragments->begin(), thread_fragments->end(), std::make_pair(first_row, size_t(0))));
+    auto& columns = block_columns[bb];
+    for (size_t row = first_row; row < last_row; ++row) {
+      const size_t row_begin = columns.size();
+      for (size_t ff = 0; ff < fragments.size(); ++ff) {
+        auto& position = positions[ff];
+        for (; position != fragments[ff]->end() && position->first == row; ++position)
+          columns.push_back(position->second);
+      }
+      if (fragments.size() > 1) {
+        std::sort(columns.begin() + row_begin, columns.end());
+        columns.erase(std::unique(columns.begin() + row_begin, columns.end()), columns.end());
+      }
+      row_ptr[row + 1] = columns.size() - row_begin;
+    }
+  });
+  for (size_t ii = 0; ii < size_; ++ii)
+    row_ptr[ii + 1] += row_ptr[ii];
+  std::vector<size_t> col_idx(row_ptr.back());
+  internal::parallel_for_each_index(num_blocks, [&](const size_t bb) {
+    std::copy(block_columns[bb].begin(), block_columns[bb].end(), col_idx.begin() + row_ptr[block_begin(bb)]);
+    std::vector<size_t>().swap(block_columns[bb]);
+  });
+  fragments_.for_each([](FragmentsType& thread_fragments) { FragmentsType().swap(thread_fragments); });
+  return SparsityPatternCSR(std::move(row_ptr), std::move(col_idx));
+} // ... finalize(...)
+
 } // namespace LA
 } // namespace Stuff
 } // namespace Dune
@@ -10,10 +10,15 @@
 #ifndef DUNE_STUFF_LA_CONTAINER_PATTERN_HH
 #define DUNE_STUFF_LA_CONTAINER_PATTERN_HH
 
+#include <cassert>
 #include <cstddef>
+#include <utility>
 #include <vector>
 #include <set>
 
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/common/parallel/threadstorage.hh>
+
 namespace Dune {
 namespace Stuff {
 namespace LA {
@@ -49,10 +54,161 @@ public:
 
   void sort();
 
+  //! a hash of the content, equal for patterns with the same columns in each row (in any order)
+  size_t fingerprint() const;
+
 private:
   BaseType vector_of_vectors_;
 }; // class SparsityPatternDefault
 
+/**
+ * \brief A sparsity pattern in compressed sparse row (CSR) format.
+ *
+ *        The columns of row ii are col_idx()[row_ptr()[ii]], ..., col_idx()[row_ptr()[ii + 1] - 1], sorted and without
+ *        duplicates. The sparse matrices of this module can be created from these arrays directly, use
+ *        SparsityPatternBuilder to assemble them.
+ */
+class SparsityPatternCSR
+{
+public:
+  typedef std::vector<size_t> IndicesType;
+  typedef IndicesType::const_iterator ConstInnerIteratorType;
+
+  //! a pattern of _size empty rows
+  explicit SparsityPatternCSR(const size_t _size = 0);
+
+  //! \attention the columns of each row have to be sorted and unique
+  SparsityPatternCSR(IndicesType&& _row_ptr, IndicesType&& _col_idx);
+
+  explicit SparsityPatternCSR(const SparsityPatternDefault& other);
+
+  size_t size() const;
+
+  size_t nonzeros() const;
+
+  const IndicesType& row_ptr() const;
+
+  const IndicesType& col_idx() const;
+
+  ConstInnerIteratorType begin(const size_t ii) const;
+
+  ConstInnerIteratorType end(const size_t ii) const;
+
+  //! \see SparsityPatternDefault::fingerprint()
+  size_t fingerprint() const;
+
+  bool operator==(const SparsityPatternCSR& other) const;
+
+  bool operator!=(const SparsityPatternCSR& other) const;
+
+private:
+  IndicesType row_ptr_;
+  IndicesType col_idx_;
+}; // class SparsityPatternCSR
+
+/**
+ * \brief Assembles a SparsityPatternCSR in two passes, without any allocation per entry.
+ *
+ *        SparsityPatternDefault::insert() searches the row for each new entry and grows one vector per row. Here, the
+ *        first pass only count()s (an upper bound of) the number of entries of each row, duplicates included.
+ *        allocate() then reserves one flat array for all rows, which the second pass fills by insert(). finalize()
+ *        sorts each row, removes the duplicates and compacts the rows into the CSR arrays.
+\code
+SparsityPatternBuilder builder(rows);
+for (...)
+  builder.count(row, num_columns);
+builder.allocate();
+for (...)
+  builder.insert(row, column);
+const SparsityPatternCSR pattern = builder.finalize();
+\endcode
+ */
+class SparsityPatternBuilder
+{
+public:
+  explicit SparsityPatternBuilder(const size_t _size);
+
+  size_t size() const;
+
+  //! first pass: announces num_entries more entries in row
+  void count(const size_t row, const size_t num_entries = 1);
+
+  void allocate();
+
+  //! second pass
+  void insert(const size_t row, const size_t column)
+  {
+    assert(allocated_ && "Call allocate() first!");
+    assert(row < size() && "Wrong index requested!");
+    if (fill_[row] == row_ptr_[row + 1])
+      DUNE_THROW(Exceptions::index_out_of_range,
+                 "More entries were inserted into row " << row << " than announced by count()!");
+    col_idx_[fill_[row]++] = column;
+  } // ... insert(...)
+
+  template <class InputIteratorType>
+  void insert(const size_t row, InputIteratorType first, const InputIteratorType last)
+  {
+    for (; first != last; ++first)
+      insert(row, *first);
+  }
+
+  //! \note leaves the builder empty
+  SparsityPatternCSR finalize();
+
+private:
+  //! the number of entries per row, shifted by one, before allocate(), the offsets of the rows afterwards
+  std::vector<size_t> row_ptr_;
+  //! the next free position in col_idx_ per row
+  std::vector<size_t> fill_;
+  std::vector<size_t> col_idx_;
+  bool allocated_;
+}; // class SparsityPatternBuilder
+
+/**
+ * \brief Assembles a SparsityPatternCSR from concurrent insertions, e.g. during a parallel grid walk.
+ *
+ *        insert() appends the entry to a buffer of the calling thread, so it may be called concurrently without any
+ *        locking and without knowing the number of entries per row in advance. finalize() sorts and deduplicates the
+ *        buffers of all threads and merges them by blocks of rows, both in parallel (if TBB is available).
+ *        See Grid::Functor::SparsityPattern to assemble a pattern in a Walker.
+ * \note  Each insertion occupies two indices until finalize(), use SparsityPatternBuilder if the rows can be counted.
+ */
+class ParallelSparsityPatternBuilder
+{
+  typedef std::vector<std::pair<size_t, size_t>> FragmentsType;
+
+public:
+  explicit ParallelSparsityPatternBuilder(const size_t _size);
+
+  size_t size() const;
+
+  //! thread safe
+  void insert(const size_t row, const size_t column)
+  {
+    assert(row < size_ && "Wrong index requested!");
+    fragments_->emplace_back(row, column);
+  }
+
+  //! thread safe
+  template <class InputIteratorType>
+  void insert(const size_t row, InputIteratorType first, const InputIteratorType last)
+  {
+    auto& fragments = *fragments_;
+    for (; first != last; ++first)
+      fragments.emplace_back(row, *first);
+  }
+
+  /**
+   * \note Must not be called concurrently to insert(), leaves the builder empty.
+   */
+  SparsityPatternCSR finalize();
+
+private:
+  const size_t size_;
+  PerThreadValue<FragmentsType> fragments_;
+}; // class ParallelSparsityPatternBuilder
+
 } // namespace LA
 } // namespace Stuff
 } // namespace Dune
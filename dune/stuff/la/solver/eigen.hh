@@ -40,9 +40,129 @@
 #include <dune/stuff/common/exceptions.hh>
 #include <dune/stuff/common/configuration.hh>
 #include <dune/stuff/la/container/eigen.hh>
+#include <dune/stuff/la/container/operator-interface.hh>
 
 #include "../solver.hh"
 
+#if HAVE_EIGEN
+#if EIGEN_VERSION_AT_LEAST(3, 3, 0)
+
+namespace Dune {
+namespace Stuff {
+namespace LA {
+namespace internal {
+
+template <class S>
+class EigenOperatorWrapper;
+
+} // namespace internal
+} // namespace LA
+} // namespace Stuff
+} // namespace Dune
+namespace Eigen {
+namespace internal {
+
+template <class S>
+struct traits<Dune::Stuff::LA::internal::EigenOperatorWrapper<S>> : public traits<SparseMatrix<S>>
+{
+};
+
+} // namespace internal
+} // namespace Eigen
+namespace Dune {
+namespace Stuff {
+namespace LA {
+namespace internal {
+
+/**
+ * \brief Presents a LinearOperatorInterface to the iterative solvers of Eigen, see
+ *        http://eigen.tuxfamily.org/dox/group__MatrixfreeSolverExample.html
+ */
+template <class S>
+class EigenOperatorWrapper : public ::Eigen::EigenBase<EigenOperatorWrapper<S>>
+{
+  typedef EigenDenseVector<S> VectorType;
+
+public:
+  typedef LinearOperatorInterface<VectorType> OperatorType;
+  typedef S Scalar;
+  typedef typename VectorType::RealType RealScalar;
+  typedef int StorageIndex;
+  typedef ::Eigen::Index Index;
+
+  enum
+  {
+    ColsAtCompileTime    = ::Eigen::Dynamic,
+    MaxColsAtCompileTime = ::Eigen::Dynamic,
+    IsRowMajor           = false
+  };
+
+  explicit EigenOperatorWrapper(const OperatorType& op)
+    : operator_(op)
+    , xx_(op.cols())
+    , yy_(op.rows())
+  {
+  }
+
+  Index rows() const
+  {
+    return ::Eigen::Index(operator_.rows());
+  }
+
+  Index cols() const
+  {
+    return ::Eigen::Index(operator_.cols());
+  }
+
+  template <class Rhs>
+  ::Eigen::Product<EigenOperatorWrapper, Rhs, ::Eigen::AliasFreeProduct>
+  operator*(const ::Eigen::MatrixBase<Rhs>& xx) const
+  {
+    return ::Eigen::Product<EigenOperatorWrapper, Rhs, ::Eigen::AliasFreeProduct>(*this, xx.derived());
+  }
+
+  //! computes dst += alpha * A rhs
+  template <class Dest, class Rhs>
+  void scale_and_add_to(Dest& dst, const Rhs& rhs, const Scalar& alpha) const
+  {
+    xx_.backend() = rhs;
+    operator_.apply(xx_, yy_);
+    dst += alpha * yy_.backend();
+  }
+
+private:
+  const OperatorType& operator_;
+  mutable VectorType xx_;
+  mutable VectorType yy_;
+}; // class EigenOperatorWrapper
+
+} // namespace internal
+} // namespace LA
+} // namespace Stuff
+} // namespace Dune
+namespace Eigen {
+namespace internal {
+
+template <class S, class Rhs>
+struct generic_product_impl<Dune::Stuff::LA::internal::EigenOperatorWrapper<S>, Rhs, SparseShape, DenseShape,
+                            GemvProduct>
+    : generic_product_impl_base<Dune::Stuff::LA::internal::EigenOperatorWrapper<S>, Rhs,
+                                generic_product_impl<Dune::Stuff::LA::internal::EigenOperatorWrapper<S>, Rhs>>
+{
+  template <class Dest>
+  static void scaleAndAddTo(Dest& dst, const Dune::Stuff::LA::internal::EigenOperatorWrapper<S>& lhs, const Rhs& rhs,
+                            const S& alpha)
+  {
+    lhs.scale_and_add_to(dst, rhs, alpha);
+  }
+};
+
+} // namespace internal
+} // namespace Eigen
+
+#endif // EIGEN_VERSION_AT_LEAST(3, 3, 0)
+#endif // HAVE_EIGEN
+
 namespace Dune {
 namespace Stuff {
 namespace LA {
@@ -579,6 +699,128 @@ private:
   const MatrixType& matrix_;
 }; // class Solver
 
+#if EIGEN_VERSION_AT_LEAST(3, 3, 0)
+
+/**
+ * \brief Iterative solvers for matrix-free operators, see LinearOperatorInterface.
+ * \note  Since there is no matrix to build one from, no preconditioner is used.
+ */
+template <class S, class CommunicatorType>
+class Solver<LinearOperatorInterface<EigenDenseVector<S>>, CommunicatorType> : protected SolverUtils
+{
+public:
+  typedef LinearOperatorInterface<EigenDenseVector<S>> OperatorType;
+  typedef typename OperatorType::RealType R;
+
+  Solver(const OperatorType& op)
+    : operator_(op)
+  {
+  }
+
+  Solver(const OperatorType& op, const CommunicatorType& /*communicator*/)
+    : operator_(op)
+  {
+  }
+
+  static std::vector<std::string> types()
+  {
+    return {"bicgstab", "cg" /* <- does only work with symmetric operators */};
+  }
+
+  static Common::Configuration options(const std::string type = "")
+  {
+    const std::string tp = !type.empty() ? type : types()[0];
+    SolverUtils::check_given(tp, types());
+    Common::Configuration default_options({"type", "post_check_solves_system"}, {tp, "1e-5"});
+    Common::Configuration iterative_options({"max_iter", "precision"}, {"10000", "1e-10"});
+    iterative_options += default_options;
+    return iterative_options;
+  } // ... options(...)
+
+  void apply(const EigenDenseVector<S>& rhs, EigenDenseVector<S>& solution) const
+  {
+    apply(rhs, solution, types()[0]);
+  }
+
+  void apply(const EigenDenseVector<S>& rhs, EigenDenseVector<S>& solution, const std::string& type) const
+  {
+    apply(rhs, solution, options(type));
+  }
+
+  void apply(const EigenDenseVector<S>& rhs, EigenDenseVector<S>& solution, const Common::Configuration& opts) const
+  {
+    typedef internal::EigenOperatorWrapper<S> WrapperType;
+    if (!opts.has_key("type"))
+      DUNE_THROW(Exceptions::configuration_error,
+                 "Given options (see below) need to have at least the key 'type' set!\n\n" << opts);
+    const auto type = opts.get<std::string>("type");
+    SolverUtils::check_given(type, types());
+    const Common::Configuration default_opts = options(type);
+    const WrapperType wrapper(operator_);
+    ::Eigen::ComputationInfo info;
+    if (type == "bicgstab") {
+      ::Eigen::BiCGSTAB<WrapperType, ::Eigen::IdentityPreconditioner> solver(wrapper);
+      solver.setMaxIterations(opts.get("max_iter", default_opts.get<int>("max_iter")));
+      solver.setTolerance(opts.get("precision", default_opts.get<R>("precision")));
+      solution.backend() = solver.solve(rhs.backend());
+      info = solver.info();
+    } else if (type == "cg") {
+      // Lower | Upper since there is no triangular part of the operator to restrict to
+      ::Eigen::ConjugateGradient<WrapperType, ::Eigen::Lower | ::Eigen::Upper, ::Eigen::IdentityPreconditioner> solver(
+          wrapper);
+      solver.setMaxIterations(opts.get("max_iter", default_opts.get<int>("max_iter")));
+      solver.setTolerance(opts.get("precision", default_opts.get<R>("precision")));
+      solution.backend() = solver.solve(rhs.backend());
+      info = solver.info();
+    } else
+      DUNE_THROW(Exceptions::internal_error,
+                 "Given type '" << type << "' is not supported, although it was reported by types()!");
+    if (info == ::Eigen::NoConvergence)
+      DUNE_THROW(Exceptions::linear_solver_failed_bc_it_did_not_converge,
+                 "The eigen backend reported 'NoConvergence'!\n"
+                     << "Those were the given options:\n\n"
+                     << opts);
+    else if (info != ::Eigen::Success)
+      DUNE_THROW(Exceptions::linear_solver_failed,
+                 "The eigen backend reported an error (" << int(info) << ")!\n"
+                                                         << "Those were the given options:\n\n"
+                                                         << opts);
+    // check
+    const R post_check_solves_system_threshold =
+        opts.get("post_check_solves_system", default_opts.get<R>("post_check_solves_system"));
+    if (post_check_solves_system_threshold > 0) {
+      EigenDenseVector<S> tmp(rhs.size());
+      operator_.apply(solution, tmp);
+      tmp -= rhs;
+      const R sup_norm = tmp.sup_norm();
+      if (sup_norm > post_check_solves_system_threshold || DSC::isnan(sup_norm) || DSC::isinf(sup_norm))
+        DUNE_THROW(Exceptions::linear_solver_failed_bc_the_solution_does_not_solve_the_system,
+                   "The computed solution does not solve the system (although the eigen backend reported "
+                       << "'Success') and you requested checking (see options below)!\n"
+                       << "If you want to disable this check, set 'post_check_solves_system = 0' in the options."
+                       << "\n\n"
+                       << "  (A * x - b).sup_norm() = "
+                       << sup_norm
+                       << "\n\n"
+                       << "Those were the given options:\n\n"
+                       << opts);
+    }
+  } // ... apply(...)
+
+private:
+  const OperatorType& operator_;
+}; // class Solver
+
+#else // EIGEN_VERSION_AT_LEAST(3, 3, 0)
+
+template <class S, class CommunicatorType>
+class Solver<LinearOperatorInterface<EigenDenseVector<S>>, CommunicatorType>
+{
+  static_assert(Dune::AlwaysFalse<S>::value, "Matrix-free operators need Eigen >= 3.3!");
+};
+
+#endif // EIGEN_VERSION_AT_LEAST(3, 3, 0)
+
 #else // HAVE_EIGEN
 
 template <class S>
@@ -593,6 +835,12 @@ class Solver<EigenRowMajorSparseMatrix<S>>
   static_assert(Dune::AlwaysFalse<S>::value, "You are missing Eigen!");
 };
 
+template <class S>
+class Solver<LinearOperatorInterface<EigenDenseVector<S>>>
+{
+  static_assert(Dune::AlwaysFalse<S>::value, "You are missing Eigen!");
+};
+
 #endif // HAVE_EIGEN
 
 } // namespace LA
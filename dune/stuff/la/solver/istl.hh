@@ -13,10 +13,12 @@
 
 #include <type_traits>
 #include <cmath>
+#include <memory>
 
 #if HAVE_DUNE_ISTL
 #include <dune/istl/operators.hh>
 #include <dune/istl/preconditioners.hh>
+#include <dune/istl/scalarproducts.hh>
 #include <dune/istl/solvers.hh>
 #include <dune/istl/umfpack.hh>
 #include <dune/istl/superlu.hh>
@@ -26,6 +28,7 @@
 #include <dune/stuff/common/configuration.hh>
 #include <dune/stuff/common/memory.hh>
 #include <dune/stuff/la/container/istl.hh>
+#include <dune/stuff/la/container/operator-interface.hh>
 #include <dune/stuff/la/solver/istl_amg.hh>
 
 #include <dune/common/version.hh>
@@ -38,6 +41,84 @@ namespace LA {
 
 #if HAVE_DUNE_ISTL
 
+namespace internal {
+
+/**
+ * \brief A sequential dune-istl matrix operator using the row block parallel kernels of IstlKernels.
+ */
+template <class S>
+class IstlParallelMatrixAdapter
+    : public AssembledLinearOperator<typename IstlRowMajorSparseMatrix<S>::BackendType,
+                                     typename IstlDenseVector<S>::BackendType, typename IstlDenseVector<S>::BackendType>
+{
+  typedef IstlKernels<S> Kernels;
+
+public:
+  typedef typename IstlRowMajorSparseMatrix<S>::BackendType matrix_type;
+  typedef typename IstlDenseVector<S>::BackendType domain_type;
+  typedef domain_type range_type;
+  typedef typename domain_type::field_type field_type;
+
+  enum
+  {
+    category = SolverCategory::sequential
+  };
+
+  explicit IstlParallelMatrixAdapter(const matrix_type& matrix)
+    : matrix_(matrix)
+  {
+  }
+
+  virtual void apply(const domain_type& xx, range_type& yy) const override final
+  {
+    Kernels::mv(matrix_, Kernels::entries(xx), Kernels::entries(yy));
+  }
+
+  virtual void applyscaleadd(field_type alpha, const domain_type& xx, range_type& yy) const override final
+  {
+    Kernels::usmv(matrix_, alpha, Kernels::entries(xx), Kernels::entries(yy));
+  }
+
+  virtual const matrix_type& getmat() const override final
+  {
+    return matrix_;
+  }
+
+private:
+  const matrix_type& matrix_;
+}; // class IstlParallelMatrixAdapter
+
+/**
+ * \brief A sequential dune-istl scalar product using the row block parallel kernels of IstlKernels.
+ */
+template <class S>
+class IstlParallelScalarProduct : public ScalarProduct<typename IstlDenseVector<S>::BackendType>
+{
+  typedef IstlKernels<S> Kernels;
+
+public:
+  typedef typename IstlDenseVector<S>::BackendType domain_type;
+  typedef typename domain_type::field_type field_type;
+  typedef typename FieldTraits<field_type>::real_type real_type;
+
+  enum
+  {
+    category = SolverCategory::sequential
+  };
+
+  virtual field_type dot(const domain_type& xx, const domain_type& yy) override final
+  {
+    return Kernels::dot(xx.N(), Kernels::entries(xx), Kernels::entries(yy));
+  }
+
+  virtual real_type norm(const domain_type& xx) override final
+  {
+    return Kernels::l2_norm(xx.N(), Kernels::entries(xx));
+  }
+}; // class IstlParallelScalarProduct
+
+} // namespace internal
+
 /**
  * \not
  **/
@@ -74,8 +155,8 @@ struct IstlSolverTraits<S, SequentialCommunication>
 {
   typedef typename IstlDenseVector<S>::BackendType IstlVectorType;
   typedef typename IstlRowMajorSparseMatrix<S>::BackendType IstlMatrixType;
-  typedef MatrixAdapter<IstlMatrixType, IstlVectorType, IstlVectorType> MatrixOperatorType;
-  typedef SeqScalarProduct<IstlVectorType> ScalarproductType;
+  typedef internal::IstlParallelMatrixAdapter<S> MatrixOperatorType;
+  typedef internal::IstlParallelScalarProduct<S> ScalarproductType;
 
   static MatrixOperatorType make_operator(const IstlMatrixType& matrix, const SequentialCommunication& /*communicator*/)
   {
@@ -306,6 +387,178 @@ private:
   const Common::ConstStorageProvider<CommunicatorType> communicator_;
 }; // class Solver
 
+namespace internal {
+
+/**
+ * \brief Presents a LinearOperatorInterface as a sequential dune-istl operator.
+ *
+ *        The dune-istl vectors are wrapped into IstlDenseVectors without copying them (the wrappers do not own them).
+ */
+template <class S>
+class IstlOperatorAdapter
+    : public Dune::LinearOperator<typename IstlDenseVector<S>::BackendType, typename IstlDenseVector<S>::BackendType>
+{
+  typedef IstlDenseVector<S> VectorType;
+  typedef typename VectorType::BackendType IstlVectorType;
+
+public:
+  typedef LinearOperatorInterface<VectorType> OperatorType;
+  typedef IstlVectorType domain_type;
+  typedef IstlVectorType range_type;
+  typedef typename IstlVectorType::field_type field_type;
+
+  enum
+  {
+    category = SolverCategory::sequential
+  };
+
+  explicit IstlOperatorAdapter(const OperatorType& op)
+    : operator_(op)
+    , tmp_(op.rows())
+  {
+  }
+
+  virtual void apply(const IstlVectorType& xx, IstlVectorType& yy) const override final
+  {
+    // xx is only ever read through the const wrapper
+    const auto no_deleter = [](IstlVectorType*) {};
+    const VectorType xx_wrapper(std::shared_ptr<IstlVectorType>(const_cast<IstlVectorType*>(&xx), no_deleter));
+    VectorType yy_wrapper(std::shared_ptr<IstlVectorType>(&yy, no_deleter));
+    operator_.apply(xx_wrapper, yy_wrapper);
+    // an operator assigning to yy replaces the backend of the wrapper instead of writing into yy
+    if (&yy_wrapper.backend() != &yy)
+      yy = yy_wrapper.backend();
+  }
+
+  virtual void applyscaleadd(field_type alpha, const IstlVectorType& xx, IstlVectorType& yy) const override final
+  {
+    apply(xx, tmp_);
+    IstlKernels<S>::axpy(yy.N(), alpha, IstlKernels<S>::entries(tmp_), IstlKernels<S>::entries(yy));
+  }
+
+private:
+  const OperatorType& operator_;
+  mutable IstlVectorType tmp_;
+}; // class IstlOperatorAdapter
+
+} // namespace internal
+
+/**
+ * \brief Iterative solvers for matrix-free operators, see LinearOperatorInterface.
+ * \note  Since there is no matrix to build one from, no preconditioner is used.
+ */
+template <class S, class CommunicatorType>
+class Solver<LinearOperatorInterface<IstlDenseVector<S>>, CommunicatorType> : protected SolverUtils
+{
+  static_assert(std::is_same<CommunicatorType, SequentialCommunication>::value,
+                "Matrix-free operators are only supported sequentially!");
+
+public:
+  typedef LinearOperatorInterface<IstlDenseVector<S>> OperatorType;
+  typedef typename OperatorType::RealType R;
+
+  Solver(const OperatorType& op)
+    : operator_(op)
+  {
+  }
+
+  Solver(const OperatorType& op, const CommunicatorType& /*communicator*/)
+    : operator_(op)
+  {
+  }
+
+  static std::vector<std::string> types()
+  {
+    return {"bicgstab", "cg" /* <- does only work with symmetric operators */};
+  }
+
+  static Common::Configuration options(const std::string type = "")
+  {
+    const std::string tp = !type.empty() ? type : types()[0];
+    SolverUtils::check_given(tp, types());
+    Common::Configuration general_opts({"type", "post_check_solves_system", "verbose"}, {tp, "1e-5", "0"});
+    Common::Configuration iterative_options({"max_iter", "precision"}, {"10000", "1e-10"});
+    iterative_options += general_opts;
+    return iterative_options;
+  } // ... options(...)
+
+  void apply(const IstlDenseVector<S>& rhs, IstlDenseVector<S>& solution) const
+  {
+    apply(rhs, solution, types()[0]);
+  }
+
+  void apply(const IstlDenseVector<S>& rhs, IstlDenseVector<S>& solution, const std::string& type) const
+  {
+    apply(rhs, solution, options(type));
+  }
+
+  /**
+   *  \note does a copy of the rhs
+   */
+  void apply(const IstlDenseVector<S>& rhs, IstlDenseVector<S>& solution, const Common::Configuration& opts) const
+  {
+    typedef internal::IstlOperatorAdapter<S> OperatorAdapterType;
+    typedef typename OperatorAdapterType::domain_type IstlVectorType;
+    InverseOperatorResult solver_result;
+    try {
+      if (!opts.has_key("type"))
+        DUNE_THROW(Exceptions::configuration_error,
+                   "Given options (see below) need to have at least the key 'type' set!\n\n" << opts);
+      const auto type = opts.get<std::string>("type");
+      SolverUtils::check_given(type, types());
+      const Common::Configuration default_opts = options(type);
+      IstlDenseVector<S> writable_rhs          = rhs.copy();
+      OperatorAdapterType istl_operator(operator_);
+      internal::IstlParallelScalarProduct<S> scalar_product;
+      IdentityPreconditioner<OperatorAdapterType, SolverCategory::sequential> preconditioner;
+      const R precision   = opts.get("precision", default_opts.get<R>("precision"));
+      const int max_iter  = opts.get("max_iter", default_opts.get<int>("max_iter"));
+      const int verbosity = opts.get("verbose", default_opts.get<int>("verbose"));
+
+      if (type == "bicgstab") {
+        BiCGSTABSolver<IstlVectorType> solver(
+            istl_operator, scalar_product, preconditioner, precision, max_iter, verbosity);
+        solver.apply(solution.backend(), writable_rhs.backend(), solver_result);
+      } else if (type == "cg") {
+        CGSolver<IstlVectorType> solver(istl_operator, scalar_product, preconditioner, precision, max_iter, verbosity);
+        solver.apply(solution.backend(), writable_rhs.backend(), solver_result);
+      } else
+        DUNE_THROW(Exceptions::internal_error,
+                   "Given type '" << type << "' is not supported, although it was reported by types()!");
+      if (!solver_result.converged)
+        DUNE_THROW(Exceptions::linear_solver_failed_bc_it_did_not_converge,
+                   "The dune-istl backend reported 'InverseOperatorResult.converged == false'!\n"
+                       << "Those were the given options:\n\n"
+                       << opts);
+
+      // check (use writable_rhs as tmp)
+      const R post_check_solves_system_threshold =
+          opts.get("post_check_solves_system", default_opts.get<R>("post_check_solves_system"));
+      if (post_check_solves_system_threshold > 0) {
+        operator_.apply(solution, writable_rhs);
+        writable_rhs -= rhs;
+        const R sup_norm = writable_rhs.sup_norm();
+        if (sup_norm > post_check_solves_system_threshold || DSC::isnan(sup_norm) || DSC::isinf(sup_norm))
+          DUNE_THROW(Exceptions::linear_solver_failed_bc_the_solution_does_not_solve_the_system,
+                     "The computed solution does not solve the system (although the dune-istl backend "
+                         << "reported no error) and you requested checking (see options below)!\n"
+                         << "If you want to disable this check, set 'post_check_solves_system = 0' in the options."
+                         << "\n\n"
+                         << "  (A * x - b).sup_norm() = "
+                         << sup_norm
+                         << "\n\n"
+                         << "Those were the given options:\n\n"
+                         << opts);
+      }
+    } catch (ISTLError& e) {
+      DUNE_THROW(Exceptions::linear_solver_failed, "The dune-istl backend reported: " << e.what());
+    }
+  } // ... apply(...)
+
+private:
+  const OperatorType& operator_;
+}; // class Solver
+
 #else // HAVE_DUNE_ISTL
 
 template <class S, class CommunicatorType>
@@ -314,6 +567,12 @@ class Solver<IstlRowMajorSparseMatrix<S>, CommunicatorType>
   static_assert(Dune::AlwaysFalse<S>::value, "You are missing dune-istl!");
 };
 
+template <class S, class CommunicatorType>
+class Solver<LinearOperatorInterface<IstlDenseVector<S>>, CommunicatorType>
+{
+  static_assert(Dune::AlwaysFalse<S>::value, "You are missing dune-istl!");
+};
+
 #endif // HAVE_DUNE_ISTL
 
 } // namespace LA
@@ -0,0 +1,90 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#include "main.hxx"
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/stuff/common/mapped_binary_cache.hh>
+
+using namespace Dune::Stuff::Common;
+
+struct MappedBinaryCacheTest : public testing::Test
+{
+  MappedBinaryCacheTest()
+    : filename((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string())
+  {
+    write({1.5, -2.25, 1e-3, 42});
+  }
+
+  ~MappedBinaryCacheTest()
+  {
+    boost::system::error_code error;
+    boost::filesystem::remove(filename, error);
+    for (auto precision : {MappedBinaryCache::Precision::float32, MappedBinaryCache::Precision::float64})
+      boost::filesystem::remove(MappedBinaryCache::cache_filename(filename, precision), error);
+  }
+
+  void write(const std::vector<double>& values)
+  {
+    std::ofstream file(filename);
+    for (const auto& value : values)
+      file << value << "\n   ";
+  }
+
+  const std::string filename;
+};
+
+TEST_F(MappedBinaryCacheTest, double_precision)
+{
+  EXPECT_TRUE(MappedBinaryCache::convert(filename));
+  const auto cache = MappedBinaryCache::cache_filename(filename, MappedBinaryCache::Precision::float64);
+  EXPECT_TRUE(boost::filesystem::exists(cache));
+  const MappedBinaryCache values(filename);
+#if HAVE_SYS_MMAN_H
+  EXPECT_TRUE(values.mapped());
+#endif
+  ASSERT_EQ(4u, values.size());
+  EXPECT_EQ(1.5, values[0]);
+  EXPECT_EQ(-2.25, values[1]);
+  EXPECT_EQ(1e-3, values[2]);
+  EXPECT_EQ(42, values[3]);
+}
+
+TEST_F(MappedBinaryCacheTest, single_precision)
+{
+  const MappedBinaryCache values(filename, MappedBinaryCache::Precision::float32);
+  ASSERT_EQ(4u, values.size());
+  EXPECT_EQ(1.5, values[0]);
+  EXPECT_EQ(float(1e-3), values[2]);
+}
+
+TEST_F(MappedBinaryCacheTest, rebuilds_outdated_cache)
+{
+  {
+    const MappedBinaryCache values(filename);
+    EXPECT_EQ(4u, values.size());
+  }
+  write({1, 2, 3, 4, 5, 6});
+  const MappedBinaryCache values(filename);
+  ASSERT_EQ(6u, values.size());
+  EXPECT_EQ(6, values[5]);
+}
+
+TEST_F(MappedBinaryCacheTest, uses_cache_without_data)
+{
+  EXPECT_TRUE(MappedBinaryCache::convert(filename));
+  boost::filesystem::remove(filename);
+  const MappedBinaryCache values(filename);
+  ASSERT_EQ(4u, values.size());
+  EXPECT_EQ(42, values[3]);
+  EXPECT_THROW(MappedBinaryCache(filename, MappedBinaryCache::Precision::float32), Dune::IOError);
+}
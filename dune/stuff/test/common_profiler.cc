@@ -7,11 +7,20 @@
 //   Rene Milk       (2012 - 2015)
 //   Tobias Leibner  (2014)
 
+// for DUNE_STUFF_PROFILE_SCOPE
+#define DUNE_STUFF_DO_PROFILE 1
+
 #include "main.hxx"
 
+#include <chrono>
+#include <thread>
+#include <sstream>
+#include <algorithm>
+
 #include <dune/stuff/common/profiler.hh>
 #include <dune/stuff/common/math.hh>
 #include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/common/string.hh>
 
 using namespace Dune::Stuff::Common;
 const size_t wait_ms = 142;
@@ -73,3 +82,144 @@ TEST(ProfilerTest, NestedTiming)
   auto outer = prof.getTiming("NestedTiming.Outer");
   EXPECT_GT(outer, inner);
 }
+
+TEST(ProfilerTest, AddTiming)
+{
+  auto& prof = DSC_PROFILER;
+  prof.reset(1);
+  prof.addTiming("ProfilerTest.AddTiming", {{wait_ms, 0, 0}});
+  prof.addTiming("ProfilerTest.AddTiming", {{wait_ms, 0, 0}});
+  EXPECT_EQ(long(2 * wait_ms), prof.getTiming("ProfilerTest.AddTiming"));
+}
+
+TEST(ProfilerTest, Items)
+{
+  auto& prof = DSC_PROFILER;
+  prof.reset(1);
+  EXPECT_EQ(size_t(0), prof.getItems("ProfilerTest.Items"));
+  prof.addTiming("ProfilerTest.Items", {{500, 0, 0}});
+  prof.addItems("ProfilerTest.Items", 100);
+  prof.addItems("ProfilerTest.Items", 200);
+  EXPECT_EQ(size_t(300), prof.getItems("ProfilerTest.Items"));
+  std::stringstream out;
+  prof.outputTimingsAll(out);
+  std::string header, values;
+  std::getline(out, header);
+  std::getline(out, values);
+  const auto columns = tokenize(header, ",");
+  const auto column  = std::find(columns.begin(), columns.end(), "ProfilerTest.Items_items_per_sec");
+  ASSERT_NE(columns.end(), column);
+  // 300 items in 500ms
+  EXPECT_EQ("600", tokenize(values, ",").at(std::distance(columns.begin(), column)));
+  prof.nextRun();
+  EXPECT_EQ(size_t(0), prof.getItems("ProfilerTest.Items"));
+}
+
+TEST(ProfilerTest, SectionId)
+{
+  auto& prof    = DSC_PROFILER;
+  const auto id = prof.sectionId("ProfilerTest.SectionId");
+  EXPECT_EQ(id, prof.sectionId("ProfilerTest.SectionId"));
+  prof.reset(1);
+  for (auto DUNE_UNUSED(i) : valueRange(3)) {
+    ScopedTiming DUNE_UNUSED(scopedTiming)(id);
+    busywait(wait_ms);
+  }
+  EXPECT_GE(prof.getTiming("ProfilerTest.SectionId"), long(3 * wait_ms * confidence_margin()));
+  EXPECT_EQ(0, prof.stopTiming(id));
+}
+
+TEST(ProfilerTest, ScopeMacros)
+{
+  auto& prof = DSC_PROFILER;
+  prof.reset(1);
+  // the name of a scope may change between executions, unless the scope is static
+  for (const std::string name : {"ProfilerTest.Scope.First", "ProfilerTest.Scope.Second"}) {
+    DUNE_STUFF_PROFILE_SCOPE(name);
+    busywait(wait_ms);
+  }
+  for (auto DUNE_UNUSED(i) : valueRange(2)) {
+    DUNE_STUFF_PROFILE_SCOPE_STATIC("ProfilerTest.Scope.Static");
+    busywait(wait_ms);
+  }
+  EXPECT_GE(prof.getTiming("ProfilerTest.Scope.First"), long(wait_ms * confidence_margin()));
+  EXPECT_GE(prof.getTiming("ProfilerTest.Scope.Second"), long(wait_ms * confidence_margin()));
+  EXPECT_LT(prof.getTiming("ProfilerTest.Scope.First"), long(2 * wait_ms * confidence_margin()));
+  EXPECT_GE(prof.getTiming("ProfilerTest.Scope.Static"), long(2 * wait_ms * confidence_margin()));
+}
+
+TEST(ProfilerTest, Trace)
+{
+  auto& prof = DSC_PROFILER;
+  prof.setTraceCapacity(3);
+  {
+    ScopedTiming DUNE_UNUSED(outer)("Trace.Outer");
+    for (auto DUNE_UNUSED(i) : valueRange(3))
+      scoped_busywait("Trace.Inner", 10);
+  }
+  std::stringstream trace;
+  prof.outputTrace(trace);
+  const auto trace_str = trace.str();
+  // the first inner section was dropped from the ring buffer
+  size_t events = 0;
+  for (auto pos = trace_str.find("\"ph\""); pos != std::string::npos; pos = trace_str.find("\"ph\"", pos + 1))
+    ++events;
+  EXPECT_EQ(3, events);
+  EXPECT_NE(std::string::npos, trace_str.find("\"name\":\"Trace.Outer\""));
+  std::stringstream flamegraph;
+  prof.outputFlamegraph(flamegraph);
+  EXPECT_NE(std::string::npos, flamegraph.str().find("Trace.Outer;Trace.Inner "));
+  prof.setTraceCapacity(0);
+}
+
+TEST(ProfilerTest, TraceKeepsResolution)
+{
+  auto& prof = DSC_PROFILER;
+  prof.setTraceCapacity(1);
+  // timestamps beyond 1e6 microseconds used to be printed with 6 significant digits only
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  scoped_busywait("Trace.Late", 1);
+  std::stringstream trace;
+  prof.outputTrace(trace);
+  const auto trace_str = trace.str();
+  const auto ts_pos    = trace_str.find("\"ts\":");
+  ASSERT_NE(std::string::npos, ts_pos);
+  const auto ts_str = trace_str.substr(ts_pos + 5, trace_str.find(',', ts_pos) - ts_pos - 5);
+  EXPECT_EQ(std::string::npos, ts_str.find('e')) << ts_str;
+  EXPECT_EQ(ts_str.size() - 4, ts_str.find('.')) << ts_str;
+  EXPECT_GT(std::stod(ts_str), 1e6);
+  prof.setTraceCapacity(0);
+}
+
+TEST(ProfilerTest, HardwareCounters)
+{
+  auto& prof           = DSC_PROFILER;
+  const bool available = prof.setHardwareCounters(true);
+  prof.reset(1);
+  scoped_busywait("ProfilerTest.HardwareCounters", 10);
+  const auto counters = prof.getCounters("ProfilerTest.HardwareCounters");
+  if (available) {
+    EXPECT_GT(counters[PerfCounters::cycles], 0u);
+    EXPECT_GT(counters[PerfCounters::instructions], 0u);
+  } else {
+    for (auto count : counters)
+      EXPECT_EQ(0u, count);
+  }
+  prof.setDofs("ProfilerTest.HardwareCounters", 100);
+  prof.outputTimingsAll(DSC::dev_null);
+  prof.setHardwareCounters(false);
+}
+
+#if HAVE_TBB
+TEST(ProfilerTest, Threaded)
+{
+  auto& prof = DSC_PROFILER;
+  prof.reset(1);
+  std::vector<std::thread> threads;
+  for (auto DUNE_UNUSED(i) : valueRange(4))
+    threads.emplace_back([] { scoped_busywait("ProfilerTest.Threaded", wait_ms); });
+  for (auto&& thread : threads)
+    thread.join();
+  EXPECT_GE(prof.getTiming("ProfilerTest.Threaded"), long(4 * wait_ms * confidence_margin()));
+}
+#endif // HAVE_TBB
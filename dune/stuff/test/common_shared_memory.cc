@@ -0,0 +1,123 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#include "main.hxx"
+
+#include <chrono>
+#include <stdexcept>
+
+#if HAVE_SYS_MMAN_H
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#include <boost/filesystem.hpp>
+
+#include <dune/stuff/common/shared_memory.hh>
+
+using namespace Dune::Stuff::Common;
+
+struct SharedMemoryTest : public testing::Test
+{
+  SharedMemoryTest()
+    : key("test." + boost::filesystem::unique_path().string())
+  {
+  }
+
+  static void fill(double* values)
+  {
+    for (size_t ii = 0; ii < 1000; ++ii)
+      values[ii] = 0.5 * ii;
+  }
+
+  const std::string key;
+};
+
+TEST_F(SharedMemoryTest, shares_within_process)
+{
+  size_t calls = 0;
+  const std::function<void(double*)> counting_fill = [&](double* values) {
+    ++calls;
+    fill(values);
+  };
+  const auto values = make_shared_array<double>(key, 1000, counting_fill);
+  const auto again  = make_shared_array<double>(key, 1000, counting_fill);
+  EXPECT_EQ(1u, calls);
+  EXPECT_EQ(values.get(), again.get());
+  EXPECT_EQ(499.5, values.get()[999]);
+  const auto other = make_shared_array<double>(key + ".other", 1000, counting_fill);
+  EXPECT_EQ(2u, calls);
+  EXPECT_NE(values.get(), other.get());
+}
+
+TEST_F(SharedMemoryTest, propagates_fill_errors)
+{
+  const std::function<void(double*)> failing_fill = [](double*) { throw std::runtime_error("no data"); };
+  EXPECT_THROW(make_shared_array<double>(key, 1000, failing_fill), std::runtime_error);
+  const auto values = make_shared_array<double>(key, 1000, std::function<void(double*)>(fill));
+  EXPECT_EQ(1.5, values.get()[3]);
+}
+
+#if HAVE_SYS_MMAN_H
+TEST_F(SharedMemoryTest, shares_across_processes)
+{
+  int pipe_fds[2];
+  ASSERT_EQ(0, ::pipe(pipe_fds));
+  const pid_t child = ::fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    // wait for the parent to fill the segment, which we then attach to
+    char ready;
+    ::close(pipe_fds[1]);
+    if (::read(pipe_fds[0], &ready, 1) != 1)
+      ::_exit(1);
+    bool filled = false;
+    auto segment = SharedMemorySegment::attach(key, 1000 * sizeof(double), [&](void* data) {
+      filled = true;
+      fill(static_cast<double*>(data));
+    });
+    const bool shared = segment->shared() && !filled && static_cast<const double*>(segment->data())[999] == 499.5;
+    // detach, _exit would skip the destructor
+    segment.reset();
+    ::_exit(shared ? 0 : 2);
+  }
+  ::close(pipe_fds[0]);
+  const auto segment = SharedMemorySegment::attach(key, 1000 * sizeof(double), [](void* data) {
+    fill(static_cast<double*>(data));
+  });
+  EXPECT_TRUE(segment->shared());
+  ASSERT_EQ(1, ::write(pipe_fds[1], "x", 1));
+  ::close(pipe_fds[1]);
+  int status = -1;
+  ASSERT_EQ(child, ::waitpid(child, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+}
+
+TEST_F(SharedMemoryTest, takes_over_abandoned_segments)
+{
+  // the child gets killed while filling the segment, which stays behind
+  const pid_t child = ::fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    SharedMemorySegment::attach(key, 1000 * sizeof(double), [](void*) { ::_exit(0); });
+    ::_exit(1);
+  }
+  int status = -1;
+  ASSERT_EQ(child, ::waitpid(child, &status, 0));
+  const auto start = std::chrono::steady_clock::now();
+  bool filled      = false;
+  const auto segment = SharedMemorySegment::attach(key, 1000 * sizeof(double), [&](void* data) {
+    filled = true;
+    fill(static_cast<double*>(data));
+  });
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+  EXPECT_TRUE(filled);
+  EXPECT_TRUE(segment->shared());
+  EXPECT_EQ(499.5, static_cast<const double*>(segment->data())[999]);
+}
+#endif // HAVE_SYS_MMAN_H
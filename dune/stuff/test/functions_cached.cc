@@ -0,0 +1,80 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#include "main.hxx"
+
+#if HAVE_DUNE_GRID
+
+#include <memory>
+
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/functions/cached.hh>
+#include <dune/stuff/functions/checkerboard.hh>
+#include <dune/stuff/functions/expression.hh>
+#include <dune/stuff/grid/entity.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+
+using namespace Dune::Stuff;
+
+struct EntityCachedTest : public ::testing::Test
+{
+  typedef Dune::YaspGrid<2, Dune::EquidistantOffsetCoordinates<double, 2>> GridType;
+  typedef GridType::LeafGridView GridViewType;
+  typedef Grid::Entity<GridViewType>::Type EntityType;
+  typedef Functions::Checkerboard<EntityType, double, 2, double, 1> CheckerboardType;
+  typedef Functions::Expression<EntityType, double, 2, double, 1> ExpressionType;
+  typedef CheckerboardType::RangeType RangeType;
+
+  EntityCachedTest()
+    : grid_provider(0.f, 1.f, 8u)
+  {
+  }
+
+  const Grid::Providers::Cube<GridType> grid_provider;
+};
+
+TEST_F(EntityCachedTest, caches_piecewise_constant_functions)
+{
+  const auto grid_view = grid_provider.grid().leafGridView();
+  const std::shared_ptr<const CheckerboardType> checkerboard(CheckerboardType::create());
+  const Functions::EntityCached<GridViewType, CheckerboardType> cached(grid_view, checkerboard);
+  for (const auto& entity : Common::entityRange(grid_view)) {
+    ASSERT_TRUE(cached.cached(entity));
+    const auto center = entity.geometry().local(entity.geometry().center());
+    RangeType expected, actual;
+    checkerboard->local_function(entity)->evaluate(center, expected);
+    cached.local_function(entity)->evaluate(center, actual);
+    EXPECT_EQ(expected, actual);
+    EXPECT_EQ(expected, cached.value(entity));
+    EXPECT_EQ(0u, cached.local_function(entity)->order());
+  }
+}
+
+TEST_F(EntityCachedTest, forwards_other_functions)
+{
+  const auto grid_view = grid_provider.grid().leafGridView();
+  const ExpressionType expression("x", "x[0]*x[1]", 2);
+  const Functions::EntityCached<GridViewType, ExpressionType> cached(grid_view, expression);
+  for (const auto& entity : Common::entityRange(grid_view)) {
+    EXPECT_FALSE(cached.cached(entity));
+    const auto corner = entity.geometry().local(entity.geometry().corner(0));
+    RangeType expected, actual;
+    expression.local_function(entity)->evaluate(corner, expected);
+    cached.local_function(entity)->evaluate(corner, actual);
+    EXPECT_EQ(expected, actual);
+  }
+}
+
+#else // HAVE_DUNE_GRID
+
+TEST(DISABLED_EntityCachedTest, caches_piecewise_constant_functions)
+{
+}
+
+#endif // HAVE_DUNE_GRID
@@ -10,12 +10,15 @@
 #include "main.hxx"
 #include "functions.hh"
 
+#include <cmath>
 #include <memory>
+#include <thread>
 
 #include <dune/common/exceptions.hh>
 
 #include <dune/stuff/functions/interfaces.hh>
 #include <dune/stuff/functions/expression.hh>
+#include <dune/stuff/functions/expression/mathexpr.hh>
 
 #if HAVE_DUNE_GRID
 #include <dune/grid/yaspgrid.hh>
@@ -36,6 +39,30 @@ struct ExpressionFunctionTest : public DS::FunctionTest<TESTFUNCTIONTYPE>
     const std::unique_ptr<const FunctionType> function2(FunctionType::create(config));
     const std::unique_ptr<const FunctionType> function3(
         new FunctionType("x", "sin(x[0])", 3, FunctionType::static_id(), {"cos(x[0])", "0", "0"}));
+    // batched evaluation
+    std::vector<typename FunctionType::DomainType> points(50, typename FunctionType::DomainType(0));
+    for (size_t ii = 0; ii < points.size(); ++ii)
+      points[ii][0] = 0.1 * ii;
+    std::vector<typename FunctionType::RangeType> values(points.size());
+    function2->evaluate(points, values);
+    typename FunctionType::RangeType expected;
+    for (size_t ii = 0; ii < points.size(); ++ii) {
+      function2->evaluate(points[ii], expected);
+      EXPECT_EQ(expected, values[ii]);
+    }
+    // the bytecode is opt-in and batched, it only differs from mathexpr by rounding
+    config["backend"] = "bytecode";
+    const std::unique_ptr<const FunctionType> function4(FunctionType::create(config));
+    EXPECT_FALSE(function2->supports_batch());
+    EXPECT_TRUE(function4->supports_batch());
+    function4->evaluate(points, values);
+    for (size_t ii = 0; ii < points.size(); ++ii) {
+      function2->evaluate(points[ii], expected);
+      expected -= values[ii];
+      EXPECT_GT(1e-14, expected.infinity_norm());
+    }
+    config["backend"] = "unknown";
+    EXPECT_THROW(FunctionType::create(config), Dune::Stuff::Exceptions::configuration_error);
   }
 };
 
@@ -51,3 +78,169 @@ TEST(DISABLED_ExpressionFunctionTest, provides_required_methods)
 }
 
 #endif // HAVE_DUNE_GRID
+
+TEST(ExpressionBytecode, folds_and_shares_subexpressions)
+{
+  const Dune::Stuff::Functions::ExpressionBytecode bytecode(
+      "x", 2, {{"sin(x[0])*x[1] + sin(x[0])", "sin(x[0])*x[1]"}, {"2*3*4 + sin(x[0])"}});
+  // sin, mul, add
+  EXPECT_EQ(3u, bytecode.num_instructions(0));
+  // sin, add
+  EXPECT_EQ(2u, bytecode.num_instructions(1));
+  auto registers = bytecode.registers();
+  std::vector<double> ret(2);
+  bytecode.evaluate(std::vector<double>{1.0, 2.0}, 2, registers, ret, 0);
+  EXPECT_DOUBLE_EQ(3 * std::sin(1.0), ret[0]);
+  EXPECT_DOUBLE_EQ(2 * std::sin(1.0), ret[1]);
+  bytecode.evaluate(std::vector<double>{1.0, 2.0}, 2, registers, ret, 1);
+  EXPECT_DOUBLE_EQ(24 + std::sin(1.0), ret[0]);
+}
+
+TEST(ExpressionBytecode, matches_mathexpr)
+{
+  const std::vector<std::string> expressions = {"x[0]^x[1]",
+                                                "2^3^2",
+                                                "sqrt(x[0]*x[0] + x[1]*x[1])",
+                                                "exp(-x[0]*x[0])*sin(pi*x[1])",
+                                                "atan(x[0], x[1])",
+                                                "abs(x[1] - 3)/x[0]",
+                                                "ln(x[0]) + E10(x[1])",
+                                                "x[0]/(x[1] - x[1])",
+                                                "sqrt(-1)",
+                                                "y[0]"};
+  const Dune::Stuff::Functions::ExpressionBytecode bytecode("x", 2, {expressions});
+  auto registers = bytecode.registers();
+  double values[2];
+  RVar x_0("x[0]", &values[0]);
+  RVar x_1("x[1]", &values[1]);
+  RVar* variables[2] = {&x_0, &x_1};
+  std::vector<double> ret(expressions.size());
+  for (auto point : {std::vector<double>{0.5, 1.5}, {2, -3}, {0, 0}, {-1, 0.25}}) {
+    values[0] = point[0];
+    values[1] = point[1];
+    bytecode.evaluate(point, 2, registers, ret);
+    // up to rounding, mathexpr evaluates in long double
+    for (size_t ii = 0; ii < expressions.size(); ++ii)
+      EXPECT_DOUBLE_EQ(ROperation(expressions[ii].c_str(), 2, variables).Val(), ret[ii]) << expressions[ii];
+  }
+}
+
+TEST(ExpressionBytecode, derivatives)
+{
+  const Dune::Stuff::Functions::ExpressionBytecode bytecode(
+      "x", 2, {{"x[0]*x[1] + 3", "sin(x[0])", "x[0]^3", "exp(-x[0]*x[0])*sin(pi*x[1])", "atan(x[0], x[1])"}}, true);
+  ASSERT_EQ(2u, bytecode.num_groups());
+  ASSERT_EQ(10u, bytecode.num_outputs(1));
+  auto registers = bytecode.registers();
+  std::vector<double> ret(10);
+  const double x_0 = 0.5;
+  const double x_1 = 1.5;
+  bytecode.evaluate(std::vector<double>{x_0, x_1}, 2, registers, ret, 1);
+  EXPECT_DOUBLE_EQ(x_1, ret[0]);
+  EXPECT_DOUBLE_EQ(x_0, ret[1]);
+  EXPECT_DOUBLE_EQ(std::cos(x_0), ret[2]);
+  EXPECT_DOUBLE_EQ(0, ret[3]);
+  EXPECT_DOUBLE_EQ(3 * x_0 * x_0, ret[4]);
+  EXPECT_DOUBLE_EQ(0, ret[5]);
+  EXPECT_DOUBLE_EQ(-2 * x_0 * std::exp(-x_0 * x_0) * std::sin(M_PI * x_1), ret[6]);
+  EXPECT_DOUBLE_EQ(M_PI * std::exp(-x_0 * x_0) * std::cos(M_PI * x_1), ret[7]);
+  EXPECT_DOUBLE_EQ(x_1 / (x_0 * x_0 + x_1 * x_1), ret[8]);
+  EXPECT_DOUBLE_EQ(-x_0 / (x_0 * x_0 + x_1 * x_1), ret[9]);
+  // the derivatives of the first two expressions are simplified to variables and a subexpression of the values
+  const Dune::Stuff::Functions::ExpressionBytecode simplified("x", 2, {{"x[0]*x[1] + 3", "sin(x[0])"}}, true);
+  EXPECT_EQ(1u, simplified.num_instructions(1));
+}
+
+TEST(ExpressionBytecode, derivative_at_kink)
+{
+  Dune::Stuff::Functions::ExpressionBytecode bytecode("x", 1, {{"abs(x[0] - 0.5)"}}, true);
+  auto registers = bytecode.registers();
+  std::vector<double> ret(1);
+  for (const double x_0 : {0.25, 0.5, 0.75}) {
+    bytecode.evaluate(std::vector<double>{x_0}, 1, registers, ret, 1);
+    EXPECT_DOUBLE_EQ(x_0 < 0.5 ? -1 : (x_0 > 0.5 ? 1 : 0), ret[0]) << x_0;
+  }
+  // the generated code has to know the sign as well
+  if (bytecode.compile_native()) {
+    auto native_registers = bytecode.registers();
+    bytecode.evaluate(std::vector<double>{0.5}, 1, native_registers, ret, 1);
+    EXPECT_DOUBLE_EQ(0, ret[0]);
+  }
+}
+
+TEST(ExpressionBytecode, evaluate_batch)
+{
+  const Dune::Stuff::Functions::ExpressionBytecode bytecode(
+      "x", 2, {{"x[0]*x[1]", "sqrt(x[0])", "exp(-x[0]*x[0])*sin(pi*x[1])", "ln(x[1] - 1)"}});
+  const size_t num_points = 2 * Dune::Stuff::Functions::ExpressionBytecode::batch_size + 3;
+  std::vector<std::vector<double>> points;
+  for (size_t ii = 0; ii < num_points; ++ii)
+    points.emplace_back(std::vector<double>{0.1 * ii - 1.0, 0.05 * ii});
+  auto batch_registers = bytecode.batch_registers();
+  std::vector<std::vector<double>> values(num_points, std::vector<double>(4));
+  bytecode.evaluate_batch(points, 2, batch_registers, values);
+  auto registers = bytecode.registers();
+  std::vector<double> expected(4);
+  for (size_t ii = 0; ii < num_points; ++ii) {
+    bytecode.evaluate(points[ii], 2, registers, expected);
+    for (size_t jj = 0; jj < 4; ++jj)
+      EXPECT_EQ(expected[jj], values[ii][jj]);
+  }
+}
+
+TEST(ExpressionBytecode, compile_native)
+{
+  const std::vector<std::string> expressions = {"x[0]*x[1]", "sqrt(x[0])", "atan(x[0], x[1])", "ln(x[1] - 1)", "-0"};
+  const Dune::Stuff::Functions::ExpressionBytecode bytecode("x", 2, {expressions});
+  Dune::Stuff::Functions::ExpressionBytecode native(bytecode);
+  // there might be no compiler, then native keeps using the bytecode
+  const bool compiled = native.compile_native();
+  EXPECT_EQ(compiled, native.is_native());
+  EXPECT_FALSE(bytecode.is_native());
+  auto registers        = bytecode.registers();
+  auto native_registers = native.registers();
+  std::vector<double> expected(expressions.size());
+  std::vector<double> values(expressions.size());
+  std::vector<std::vector<double>> points;
+  for (size_t ii = 0; ii < 40; ++ii)
+    points.emplace_back(std::vector<double>{0.1 * ii - 1.0, 0.05 * ii});
+  for (const auto& point : points) {
+    bytecode.evaluate(point, 2, registers, expected);
+    native.evaluate(point, 2, native_registers, values);
+    for (size_t ii = 0; ii < expressions.size(); ++ii)
+      EXPECT_EQ(expected[ii], values[ii]);
+  }
+  auto batch_registers = native.batch_registers();
+  std::vector<std::vector<double>> batch_values(points.size(), std::vector<double>(expressions.size()));
+  native.evaluate_batch(points, 2, batch_registers, batch_values);
+  for (size_t pp = 0; pp < points.size(); ++pp) {
+    bytecode.evaluate(points[pp], 2, registers, expected);
+    for (size_t ii = 0; ii < expressions.size(); ++ii)
+      EXPECT_EQ(expected[ii], batch_values[pp][ii]);
+  }
+}
+
+#if HAVE_TBB
+
+TEST(MathExpressionBase, evaluate_concurrently)
+{
+  typedef Dune::Stuff::Functions::MathExpressionBase<double, 2, double, 2> ExpressionType;
+  const ExpressionType expression("x", std::vector<std::string>{"x[0]*x[1]", "x[0]+x[1]"});
+  std::vector<std::thread> threads;
+  std::vector<size_t> failures(4, 0);
+  for (size_t tt = 0; tt < failures.size(); ++tt)
+    threads.emplace_back([&, tt] {
+      Dune::FieldVector<double, 2> ret;
+      for (size_t ii = 0; ii < 10000; ++ii) {
+        expression.evaluate(Dune::FieldVector<double, 2>({double(tt), double(ii)}), ret);
+        if (ret[0] != double(tt * ii) || ret[1] != double(tt + ii))
+          ++failures[tt];
+      }
+    });
+  for (auto&& thread : threads)
+    thread.join();
+  for (auto failure : failures)
+    EXPECT_EQ(0u, failure);
+}
+
+#endif // HAVE_TBB
@@ -0,0 +1,85 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#include "main.hxx"
+
+#if HAVE_DUNE_GRID
+
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/functions/checkerboard.hh>
+#include <dune/stuff/functions/combined.hh>
+#include <dune/stuff/functions/expression.hh>
+#include <dune/stuff/functions/localfunction_pool.hh>
+#include <dune/stuff/grid/entity.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+
+using namespace Dune::Stuff;
+
+struct LocalfunctionPoolTest : public ::testing::Test
+{
+  typedef Dune::YaspGrid<2, Dune::EquidistantOffsetCoordinates<double, 2>> GridType;
+  typedef GridType::LeafGridView GridViewType;
+  typedef Grid::Entity<GridViewType>::Type EntityType;
+  typedef Functions::Checkerboard<EntityType, double, 2, double, 1> CheckerboardType;
+  typedef Functions::Expression<EntityType, double, 2, double, 1> ExpressionType;
+  typedef Functions::Sum<CheckerboardType, ExpressionType> SumType;
+  typedef CheckerboardType::RangeType RangeType;
+
+  LocalfunctionPoolTest()
+    : grid_provider(0.f, 1.f, 4u)
+  {
+  }
+
+  //! the pool has to give the same values as fresh local functions, reusing one local function for all entities
+  template <class FunctionType>
+  void check(const FunctionType& function) const
+  {
+    const auto grid_view = grid_provider.grid().leafGridView();
+    const Functions::LocalfunctionPool<FunctionType> pool(function);
+    const typename FunctionType::LocalfunctionType* first = nullptr;
+    for (const auto& entity : Common::entityRange(grid_view)) {
+      const auto& local_function = pool.bind(entity);
+      if (!first)
+        first = &local_function;
+      EXPECT_EQ(first, &local_function);
+      const auto corner = entity.geometry().local(entity.geometry().corner(0));
+      RangeType expected, actual;
+      function.local_function(entity)->evaluate(corner, expected);
+      local_function.evaluate(corner, actual);
+      EXPECT_EQ(expected, actual);
+    }
+  } // ... check(...)
+
+  const Grid::Providers::Cube<GridType> grid_provider;
+};
+
+TEST_F(LocalfunctionPoolTest, rebinds_checkerboard)
+{
+  check(*CheckerboardType::create());
+}
+
+TEST_F(LocalfunctionPoolTest, rebinds_global_functions)
+{
+  check(ExpressionType("x", "x[0]*x[1]", 2));
+}
+
+TEST_F(LocalfunctionPoolTest, rebinds_combined_functions)
+{
+  const auto checkerboard = CheckerboardType::create();
+  const ExpressionType expression("x", "x[0]*x[1]", 2);
+  check(SumType(*checkerboard, expression));
+}
+
+#else // HAVE_DUNE_GRID
+
+TEST(DISABLED_LocalfunctionPoolTest, rebinds_checkerboard)
+{
+}
+
+#endif // HAVE_DUNE_GRID
@@ -0,0 +1,65 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#include "main.hxx"
+
+#include <algorithm>
+#include <vector>
+
+#include <dune/stuff/common/random.hh>
+#include <dune/stuff/functions/random_ellipsoids_function.hh>
+
+using namespace Dune::Stuff;
+
+typedef Functions::Ellipsoid<2> EllipsoidType;
+typedef EllipsoidType::DomainType DomainType;
+
+TEST(Ellipsoid, intersects_cube)
+{
+  EllipsoidType ellipsoid;
+  ellipsoid.center = DomainType(0.5);
+  ellipsoid.radii  = DomainType{0.2, 0.1};
+  EXPECT_TRUE(ellipsoid.intersects_cube(DomainType(0.), DomainType(1.)));
+  EXPECT_TRUE(ellipsoid.intersects_cube(DomainType{0.6, 0.55}, DomainType(1.)));
+  EXPECT_TRUE(ellipsoid.intersects_cube(DomainType{0.7, 0.}, DomainType(1.)));
+  EXPECT_FALSE(ellipsoid.intersects_cube(DomainType{0.71, 0.}, DomainType(1.)));
+  // overlaps the bounding box of the ellipsoid, but not the ellipsoid itself
+  EXPECT_FALSE(ellipsoid.intersects_cube(DomainType{0.65, 0.58}, DomainType(1.)));
+}
+
+TEST(EllipsoidTree, finds_all_intersecting_ellipsoids)
+{
+  Common::DefaultRNG<double> coordinate_rng(0, 1, 1);
+  Common::DefaultRNG<double> radius_rng(0.001, 0.05, 2);
+  std::vector<EllipsoidType> ellipsoids(1000);
+  for (auto& ellipsoid : ellipsoids) {
+    std::generate(ellipsoid.center.begin(), ellipsoid.center.end(), [&] { return coordinate_rng(); });
+    std::generate(ellipsoid.radii.begin(), ellipsoid.radii.end(), [&] { return radius_rng(); });
+  }
+  const Functions::internal::EllipsoidTree<2, double> tree(ellipsoids);
+  EXPECT_EQ(ellipsoids.size(), tree.size());
+  const auto by_center = [](const EllipsoidType& left, const EllipsoidType& right) {
+    return std::lexicographical_compare(left.center.begin(), left.center.end(), right.center.begin(), right.center.end());
+  };
+  for (size_t ii = 0; ii < 100; ++ii) {
+    DomainType lower_left, upper_right;
+    for (size_t dd = 0; dd < 2; ++dd) {
+      lower_left[dd]  = coordinate_rng();
+      upper_right[dd] = lower_left[dd] + 0.1 * coordinate_rng();
+    }
+    std::vector<EllipsoidType> expected, actual;
+    std::copy_if(ellipsoids.begin(), ellipsoids.end(), std::back_inserter(expected), [&](const EllipsoidType& e) {
+      return e.intersects_cube(lower_left, upper_right);
+    });
+    tree.intersecting(lower_left, upper_right, actual);
+    ASSERT_EQ(expected.size(), actual.size());
+    std::sort(expected.begin(), expected.end(), by_center);
+    std::sort(actual.begin(), actual.end(), by_center);
+    for (size_t jj = 0; jj < expected.size(); ++jj)
+      EXPECT_EQ(expected[jj].center, actual[jj].center);
+  }
+}
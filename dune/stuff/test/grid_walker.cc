@@ -13,6 +13,7 @@
 
 #include <dune/stuff/grid/walker.hh>
 #include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/la/container/pattern-walker.hh>
 #include <dune/stuff/common/parallel/partitioner.hh>
 #include <dune/stuff/common/logstreams.hh>
 
@@ -27,6 +28,44 @@ using namespace std;
 
 typedef testing::Types<Int<1>, Int<2>, Int<3>> GridDims;
 
+//! sums up the volumes of all entities, supports copying for the parallel walk
+template <class GridViewType>
+class VolumeFunctor : public Functor::Codim0<GridViewType>
+{
+  typedef Functor::Codim0<GridViewType> BaseType;
+
+public:
+  typedef typename BaseType::EntityType EntityType;
+
+  VolumeFunctor()
+    : volume_(0)
+  {
+  }
+
+  virtual void apply_local(const EntityType& entity) override
+  {
+    volume_ += entity.geometry().volume();
+  }
+
+  virtual std::unique_ptr<BaseType> copy() const override
+  {
+    return DSC::make_unique<VolumeFunctor<GridViewType>>();
+  }
+
+  virtual void join(BaseType& other) override
+  {
+    volume_ += static_cast<VolumeFunctor<GridViewType>&>(other).volume_;
+  }
+
+  double volume() const
+  {
+    return volume_;
+  }
+
+private:
+  double volume_;
+}; // class VolumeFunctor
+
 template <class T>
 struct GridWalkerTest : public ::testing::Test
 {
@@ -95,13 +134,217 @@ struct GridWalkerTest : public ::testing::Test
     walker.walk();
     EXPECT_EQ(filter_count, all_count);
   }
+
+  void check_reduction()
+  {
+    const auto gv = grid_prv.grid().leafGridView();
+    Walker<GridViewType> walker(gv);
+    VolumeFunctor<GridViewType> serial, first, second;
+    walker.add(serial).walk(false);
+    walker.add(first).walk(true);
+    walker.add(second).walk(true);
+    EXPECT_DOUBLE_EQ(1., serial.volume());
+    EXPECT_DOUBLE_EQ(serial.volume(), first.volume());
+    // the parallel reduction has to be reproducible bit by bit
+    EXPECT_EQ(first.volume(), second.volume());
+
+    SeedPartitioning<GridViewType> partitioning(gv, 7);
+    EXPECT_EQ(size_t(7), partitioning.partitions());
+    VolumeFunctor<GridViewType> partitioned;
+    walker.add(partitioned).walk(partitioning);
+    EXPECT_DOUBLE_EQ(serial.volume(), partitioned.volume());
+    size_t entities = 0;
+    for (size_t pp = 0; pp < partitioning.partitions(); ++pp)
+      entities += partitioning.size(pp);
+    EXPECT_EQ(size_t(gv.size(0)), entities);
+
+    SeedPartitioningCache<GridViewType> cache;
+    const auto& cached = cache.partitioning(gv, 7);
+    EXPECT_TRUE(cached.up_to_date(gv));
+    EXPECT_EQ(&cached, &cache.partitioning(gv, 7));
+    EXPECT_NE(&cached, &cache.partitioning(gv, 3));
+    VolumeFunctor<GridViewType> from_cache;
+    walker.add(from_cache).walk(cache);
+    EXPECT_DOUBLE_EQ(serial.volume(), from_cache.volume());
+
+    for (auto ordering : {EntityOrdering::morton, EntityOrdering::hilbert}) {
+      VolumeFunctor<GridViewType> ordered;
+      walker.add(ordered).walk(cache, ordering);
+      EXPECT_DOUBLE_EQ(serial.volume(), ordered.volume());
+    }
+  }
+
+  void check_adaptation()
+  {
+    DSG::Providers::Cube<GridType> provider(0.f, 1.f, 2);
+    auto& grid = provider.grid();
+    SeedPartitioningCache<GridViewType> cache;
+    for (size_t refinements = 0; refinements < 3; ++refinements) {
+      if (refinements > 0)
+        grid.globalRefine(1);
+      const auto gv = grid.leafGridView();
+      const auto& partitioning = cache.partitioning(gv, 3);
+      EXPECT_TRUE(partitioning.up_to_date(gv));
+      size_t entities = 0;
+      for (size_t pp = 0; pp < partitioning.partitions(); ++pp)
+        entities += partitioning.size(pp);
+      EXPECT_EQ(size_t(gv.size(0)), entities);
+      atomic<size_t> count(0);
+      VolumeFunctor<GridViewType> volume;
+      Walker<GridViewType> walker(gv);
+      walker.add([&](const EntityType&) { count++; });
+      walker.add(volume).walk(cache);
+      EXPECT_EQ(size_t(gv.size(0)), count);
+      EXPECT_DOUBLE_EQ(1., volume.volume());
+      const auto& coloring = cache.coloring(gv, 2);
+      size_t colored = 0;
+      for (size_t cc = 0; cc < coloring.colors(); ++cc)
+        colored += coloring.color(cc).size();
+      EXPECT_EQ(size_t(gv.size(0)), colored);
+    }
+  }
+
+  void check_static()
+  {
+    const auto gv = grid_prv.grid().leafGridView();
+    size_t boundary_count = 0, static_boundary_count = 0;
+    auto counter = [&](const IntersectionType&, const EntityType&, const EntityType&) { ++boundary_count; };
+    Walker<GridViewType> walker(gv);
+    walker.add(counter, new DSG::ApplyOn::BoundaryIntersections<GridViewType>()).walk();
+    // a (dynamic) walker is a functor as well, the filter is applied by the static walker
+    Walker<GridViewType> nested(gv);
+    nested.add([&](const IntersectionType&, const EntityType&, const EntityType&) { ++static_boundary_count; });
+    VolumeFunctor<GridViewType> volume;
+    make_static_walker(gv, volume, filtered(nested, DSG::ApplyOn::BoundaryIntersections<GridViewType>())).walk();
+    EXPECT_DOUBLE_EQ(1., volume.volume());
+    EXPECT_EQ(boundary_count, static_boundary_count);
+  }
+
+  void check_inner_once()
+  {
+    const auto gv = grid_prv.grid().leafGridView();
+    size_t all_count = 0, inner_count = 0, boundary_count = 0, once_count = 0, nested_once_count = 0;
+    SeedPartitioningCache<GridViewType> cache;
+    Walker<GridViewType> walker(gv);
+    // only the functors added by add_inner_once() skip the second visit
+    walker.add([&](const IntersectionType& intersection, const EntityType&, const EntityType&) {
+      ++all_count;
+      if (intersection.neighbor())
+        ++inner_count;
+      else
+        ++boundary_count;
+    });
+    walker.add_inner_once([&](const IntersectionType&, const EntityType&, const EntityType&) { ++once_count; }, cache);
+    Walker<GridViewType> nested(gv);
+    nested.add_inner_once([&](const IntersectionType&, const EntityType&, const EntityType&) { ++nested_once_count; },
+                          cache);
+    walker.add(nested).walk();
+    EXPECT_EQ(all_count, inner_count + boundary_count);
+    EXPECT_EQ(inner_count / 2 + boundary_count, once_count);
+    EXPECT_EQ(once_count, nested_once_count);
+    // the ownership is fetched anew for each walk
+    cache.clear();
+    once_count = 0;
+    walker.add_inner_once([&](const IntersectionType&, const EntityType&, const EntityType&) { ++once_count; }, cache);
+    cache.clear();
+    walker.walk();
+    EXPECT_EQ(inner_count / 2 + boundary_count, once_count);
+  }
+
+  void check_coloring()
+  {
+    const auto gv = grid_prv.grid().leafGridView();
+    const auto& index_set = gv.indexSet();
+    Walker<GridViewType> walker(gv);
+    // unsynchronized writes to the inside and outside entity, each entity is touched once per own intersection and
+    // once per neighbor
+    std::vector<size_t> counts(gv.size(0), 0);
+    walker.add([&](const IntersectionType&, const EntityType& inside, const EntityType& outside) {
+      ++counts[index_set.index(inside)];
+      if (index_set.index(outside) != index_set.index(inside))
+        ++counts[index_set.index(outside)];
+    });
+    SeedPartitioningCache<GridViewType> cache;
+    walker.walk_colored(cache);
+    const auto& coloring = cache.coloring(gv, Walker<GridViewType>::default_num_partitions());
+    EXPECT_LT(size_t(1), coloring.colors());
+    // the partitions of one color are processed concurrently, so they must not share a vertex
+    for (size_t cc = 0; cc < coloring.colors(); ++cc) {
+      const auto color = coloring.color(cc);
+      std::map<size_t, size_t> vertex_partitions;
+      for (size_t pp = 0; pp < color.partitions(); ++pp)
+        for (const auto& entity : color.partition(pp))
+          for (int vv = 0; vv < entity.template count<griddim>(); ++vv) {
+            const auto partition = vertex_partitions.emplace(index_set.subIndex(entity, vv, griddim), pp).first;
+            EXPECT_EQ(pp, partition->second);
+          }
+    }
+    for (const auto& entity : DSC::entityRange(gv)) {
+      size_t expected = 0;
+      for (const auto& intersection : DSC::intersectionRange(gv, entity))
+        expected += intersection.neighbor() ? 2 : 1;
+      EXPECT_EQ(expected, counts[index_set.index(entity)]);
+    }
+  }
+
+  void check_pattern()
+  {
+    const auto gv = grid_prv.grid().leafGridView();
+    const auto& index_set = gv.indexSet();
+    // couples each entity with itself and its neighbors
+    LA::SparsityPatternDefault expected(gv.size(0));
+    for (const auto& entity : DSC::entityRange(gv)) {
+      const size_t ii = index_set.index(entity);
+      expected.insert(ii, ii);
+      for (const auto& intersection : DSC::intersectionRange(gv, entity))
+        if (intersection.neighbor())
+          expected.insert(ii, index_set.index(intersection.outside()));
+    }
+    expected.sort();
+    typedef Functor::SparsityPattern<GridViewType> PatternFunctorType;
+    PatternFunctorType pattern(
+        gv.size(0),
+        [&](const EntityType& entity, typename PatternFunctorType::BuilderType& builder) {
+          builder.insert(index_set.index(entity), index_set.index(entity));
+        },
+        [&](const IntersectionType&, const EntityType& inside, const EntityType& outside,
+            typename PatternFunctorType::BuilderType& builder) {
+          builder.insert(index_set.index(inside), index_set.index(outside));
+        });
+    Walker<GridViewType> walker(gv);
+    walker.add(pattern, new DSG::ApplyOn::InnerIntersections<GridViewType>()).walk(true);
+    EXPECT_EQ(LA::SparsityPatternCSR(expected), pattern.pattern());
+  }
 };
 
+TEST(SpaceFillingCurve, Hilbert)
+{
+  // the hilbert curve through a 4x4 grid visits neighboring points only
+  std::vector<std::array<std::uint64_t, 2>> points(16);
+  for (std::uint64_t xx = 0; xx < 4; ++xx)
+    for (std::uint64_t yy = 0; yy < 4; ++yy) {
+      const auto index = Dune::Stuff::Grid::internal::space_filling_curve_index<2>({{xx, yy}}, 2, true);
+      ASSERT_LT(index, std::uint64_t(16));
+      points[index] = {{xx, yy}};
+    }
+  for (size_t ii = 1; ii < points.size(); ++ii) {
+    const auto dx = std::abs(long(points[ii][0]) - long(points[ii - 1][0]));
+    const auto dy = std::abs(long(points[ii][1]) - long(points[ii - 1][1]));
+    EXPECT_EQ(1, dx + dy);
+  }
+}
+
 TYPED_TEST_CASE(GridWalkerTest, GridDims);
 TYPED_TEST(GridWalkerTest, Misc)
 {
   this->check_count();
   this->check_apply_on();
+  this->check_reduction();
+  this->check_adaptation();
+  this->check_coloring();
+  this->check_static();
+  this->check_inner_once();
+  this->check_pattern();
 }
 
 #else // HAVE_DUNE_GRID
@@ -0,0 +1,64 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+// measure each functor, see internal::ProfiledCodim0Object
+#define DUNE_STUFF_WALKER_DO_PROFILE 1
+
+#include "main.hxx"
+
+#if HAVE_DUNE_GRID
+
+#include <functional>
+#include <string>
+
+#include <dune/stuff/grid/walker.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/common/profiler.hh>
+#include <dune/stuff/common/type_utils.hh>
+
+using namespace Dune::Stuff;
+using namespace Dune::Stuff::Common;
+using namespace Dune::Stuff::Grid;
+
+typedef Dune::YaspGrid<2, Dune::EquidistantOffsetCoordinates<double, 2>> GridType;
+typedef GridType::LeafGridView GridViewType;
+typedef DSG::Entity<GridViewType>::Type EntityType;
+typedef DSG::Intersection<GridViewType>::Type IntersectionType;
+
+TEST(ProfiledWalkerTest, counts_each_functor)
+{
+  const DSG::Providers::Cube<GridType> grid_prv(0.f, 1.f, 4);
+  const auto gv = grid_prv.grid().leafGridView();
+  size_t intersections = 0;
+  for (const auto& entity : entityRange(gv))
+    for (auto intersection_it = gv.ibegin(entity); intersection_it != gv.iend(entity); ++intersection_it)
+      ++intersections;
+  // lambdas of the same signature have the same type, so each gets its own section by its position in the walker
+  std::function<void(const EntityType&)> first  = [](const EntityType&) {};
+  std::function<void(const EntityType&)> second = [](const EntityType&) {};
+  std::function<void(const IntersectionType&, const EntityType&, const EntityType&)> third =
+      [](const IntersectionType&, const EntityType&, const EntityType&) {};
+  const std::string codim0_name = "Walker::" + demangledTypeId(first);
+  const std::string codim1_name = "Walker::" + demangledTypeId(third);
+  Walker<GridViewType> walker(gv);
+  walker.add(first).add(second).add(third).walk(false);
+  EXPECT_EQ(size_t(gv.size(0)), DSC_PROFILER.getItems(codim0_name + " #0 (codim 0)"));
+  EXPECT_EQ(size_t(gv.size(0)), DSC_PROFILER.getItems(codim0_name + " #1 (codim 0)"));
+  EXPECT_EQ(intersections, DSC_PROFILER.getItems(codim1_name + " #0 (codim 1)"));
+  // the copies of a parallel walk share their statistics
+  walker.add(first).add(third).walk(true);
+  EXPECT_EQ(2 * size_t(gv.size(0)), DSC_PROFILER.getItems(codim0_name + " #0 (codim 0)"));
+  EXPECT_EQ(2 * intersections, DSC_PROFILER.getItems(codim1_name + " #0 (codim 1)"));
+}
+
+#else // HAVE_DUNE_GRID
+
+TEST(DISABLED_ProfiledWalkerTest, counts_each_functor)
+{
+}
+
+#endif // HAVE_DUNE_GRID
@@ -0,0 +1,135 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#include "main.hxx"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <dune/stuff/la/container/istl-kernels.hh>
+#include <dune/stuff/la/container/istl.hh>
+#include <dune/stuff/la/container/pattern.hh>
+
+using namespace Dune::Stuff;
+
+typedef LA::internal::IstlKernels<double> Kernels;
+
+// large enough to be split into several blocks
+static const size_t size = 10 * LA::internal::RowBlocks::min_block_size + 17;
+
+static std::vector<double> some_vector(const double offset)
+{
+  std::vector<double> ret(size);
+  for (size_t ii = 0; ii < size; ++ii)
+    ret[ii] = std::sin(offset + double(ii));
+  return ret;
+}
+
+TEST(RowBlocks, cover_all_rows)
+{
+  for (const size_t ss : {size_t(0), size_t(1), size, 3 * size}) {
+    const LA::internal::RowBlocks blocks(ss);
+    EXPECT_EQ(size_t(0), blocks.begin(0));
+    EXPECT_EQ(ss, blocks.end(blocks.size() - 1));
+    std::vector<size_t> hits(ss, 0);
+    blocks.apply([&](const size_t first, const size_t last) {
+      for (size_t ii = first; ii < last; ++ii)
+        ++hits[ii];
+    });
+    EXPECT_EQ(std::vector<size_t>(ss, 1), hits);
+  }
+}
+
+TEST(IstlKernels, match_serial_loops)
+{
+  const auto xx = some_vector(0.);
+  const auto yy = some_vector(1.);
+  double dot = 0, l1_norm = 0, l2_norm = 0, sup_norm = 0;
+  for (size_t ii = 0; ii < size; ++ii) {
+    dot += xx[ii] * yy[ii];
+    l1_norm += std::abs(xx[ii]);
+    l2_norm += xx[ii] * xx[ii];
+    sup_norm = std::max(sup_norm, std::abs(xx[ii]));
+  }
+  // the blocks sum up in a different order
+  EXPECT_NEAR(dot, Kernels::dot(size, xx.data(), yy.data()), 1e-10 * std::abs(dot));
+  EXPECT_NEAR(l1_norm, Kernels::l1_norm(size, xx.data()), 1e-10 * l1_norm);
+  EXPECT_NEAR(std::sqrt(l2_norm), Kernels::l2_norm(size, xx.data()), 1e-10 * std::sqrt(l2_norm));
+  EXPECT_EQ(sup_norm, Kernels::sup_norm(size, xx.data()));
+
+  auto result = yy;
+  Kernels::axpy(size, 2., xx.data(), result.data());
+  for (size_t ii = 0; ii < size; ++ii)
+    EXPECT_EQ(yy[ii] + 2. * xx[ii], result[ii]);
+  Kernels::add(size, xx.data(), -1., yy.data(), result.data());
+  for (size_t ii = 0; ii < size; ++ii)
+    EXPECT_EQ(xx[ii] - yy[ii], result[ii]);
+  Kernels::scal(size, 3., result.data());
+  for (size_t ii = 0; ii < size; ++ii)
+    EXPECT_EQ(3. * (xx[ii] - yy[ii]), result[ii]);
+  Kernels::fill(size, 1., result.data());
+  EXPECT_EQ(std::vector<double>(size, 1.), result);
+}
+
+TEST(IstlKernels, handle_empty_vectors)
+{
+  EXPECT_EQ(0., Kernels::dot(0, nullptr, nullptr));
+  EXPECT_EQ(0., Kernels::l2_norm(0, nullptr));
+  EXPECT_EQ(0., Kernels::sup_norm(0, nullptr));
+  Kernels::axpy(0, 1., nullptr, nullptr);
+}
+
+TEST(IstlKernels, sup_norm_propagates_nan)
+{
+  auto xx = some_vector(0.);
+  xx[size / 2] = std::numeric_limits<double>::quiet_NaN();
+  EXPECT_TRUE(std::isnan(Kernels::sup_norm(size, xx.data())));
+  std::vector<double> small(3, std::numeric_limits<double>::quiet_NaN());
+  EXPECT_TRUE(std::isnan(Kernels::sup_norm(small.size(), small.data())));
+  small[0] = 1.;
+  EXPECT_TRUE(std::isnan(Kernels::sup_norm(small.size(), small.data())));
+}
+
+#if HAVE_DUNE_ISTL
+
+TEST(IstlKernels, mv_matches_backend)
+{
+  // the 1d laplacian
+  LA::SparsityPatternBuilder builder(size);
+  for (size_t ii = 0; ii < size; ++ii)
+    builder.count(ii, 3);
+  builder.allocate();
+  for (size_t ii = 0; ii < size; ++ii) {
+    builder.insert(ii, ii);
+    if (ii > 0)
+      builder.insert(ii, ii - 1);
+    if (ii + 1 < size)
+      builder.insert(ii, ii + 1);
+  }
+  LA::IstlRowMajorSparseMatrix<double> matrix(size, size, builder.finalize());
+  for (size_t ii = 0; ii < size; ++ii) {
+    matrix.set_entry(ii, ii, 2.);
+    if (ii > 0)
+      matrix.set_entry(ii, ii - 1, -1.);
+    if (ii + 1 < size)
+      matrix.set_entry(ii, ii + 1, -1.);
+  }
+  LA::IstlDenseVector<double> xx(some_vector(0.));
+  LA::IstlDenseVector<double> actual(size), expected(size);
+  matrix.mv(xx, actual);
+  matrix.backend().mv(xx.backend(), expected.backend());
+  EXPECT_TRUE(expected == actual);
+}
+
+#else // HAVE_DUNE_ISTL
+
+TEST(DISABLED_IstlKernels, mv_matches_backend)
+{
+}
+
+#endif // HAVE_DUNE_ISTL
@@ -52,6 +52,24 @@ struct MatrixTest : public ::testing::Test
         pattern.inner(ii).push_back(jj);
     }
     MatrixImp d_by_size_and_pattern(dim, dim, pattern);
+    Stuff::LA::SparsityPatternBuilder builder(dim);
+    for (size_t ii = 0; ii < dim; ++ii)
+      builder.count(ii, dim);
+    builder.allocate();
+    for (size_t ii = 0; ii < dim; ++ii)
+      for (size_t jj = dim; jj > 0; --jj)
+        builder.insert(ii, jj - 1);
+    MatrixImp d_by_size_and_csr_pattern(dim, dim, builder.finalize());
+    EXPECT_EQ(d_by_size_and_pattern.pattern(), d_by_size_and_csr_pattern.pattern());
+    Stuff::LA::MatrixPatternCache<MatrixImp> cache;
+    auto d_from_cache = cache.create(dim, dim, pattern);
+    auto d_from_cache_again = cache.create(dim, dim, pattern);
+    EXPECT_EQ(size_t(1), cache.size());
+    EXPECT_EQ(d_by_size_and_pattern.pattern(), d_from_cache_again.pattern());
+    // the copies do not share their values
+    d_from_cache.set_entry(0, 1, D_ScalarType(1));
+    EXPECT_DOUBLE_OR_COMPLEX_EQ(D_RealType(0), d_from_cache_again.get_entry(0, 1));
+    EXPECT_DOUBLE_OR_COMPLEX_EQ(D_RealType(0), cache.create(dim, dim, pattern).get_entry(0, 1));
     size_t d_rows = d_by_size.rows();
     EXPECT_EQ(dim, d_rows);
     size_t d_cols = d_by_size.cols();
@@ -0,0 +1,98 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#include "main.hxx"
+
+#include <vector>
+
+#if HAVE_TBB
+#include <tbb/parallel_for.h>
+#endif
+
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/la/container/pattern.hh>
+
+using namespace Dune::Stuff;
+
+TEST(SparsityPatternBuilder, matches_default_pattern)
+{
+  // a 1d stencil with duplicate insertions, as in assembling over entities and intersections
+  const size_t size = 10;
+  LA::SparsityPatternDefault expected(size);
+  LA::SparsityPatternBuilder builder(size);
+  for (size_t ii = 0; ii < size; ++ii)
+    builder.count(ii, 5);
+  builder.allocate();
+  for (size_t ii = 0; ii < size; ++ii) {
+    const std::vector<size_t> columns = {ii, ii, (ii + 1) % size, (ii + size - 1) % size, ii};
+    for (const auto& jj : columns)
+      expected.insert(ii, jj);
+    builder.insert(ii, columns.begin(), columns.end());
+  }
+  expected.sort();
+  const auto pattern = builder.finalize();
+  EXPECT_EQ(size, pattern.size());
+  EXPECT_EQ(3 * size, pattern.nonzeros());
+  EXPECT_EQ(LA::SparsityPatternCSR(expected), pattern);
+  for (size_t ii = 0; ii < size; ++ii)
+    EXPECT_EQ(expected.inner(ii), std::vector<size_t>(pattern.begin(ii), pattern.end(ii)));
+}
+
+TEST(SparsityPatternBuilder, handles_empty_rows)
+{
+  LA::SparsityPatternBuilder builder(3);
+  builder.count(1, 2);
+  builder.allocate();
+  builder.insert(1, 2);
+  const auto pattern = builder.finalize();
+  EXPECT_EQ(std::vector<size_t>({0, 0, 1, 1}), pattern.row_ptr());
+  EXPECT_EQ(std::vector<size_t>({2}), pattern.col_idx());
+}
+
+TEST(SparsityPatternBuilder, throws_on_too_many_entries)
+{
+  LA::SparsityPatternBuilder builder(2);
+  builder.count(0);
+  builder.allocate();
+  builder.insert(0, 1);
+  EXPECT_THROW(builder.insert(0, 0), Exceptions::index_out_of_range);
+}
+
+TEST(ParallelSparsityPatternBuilder, matches_serial_builder)
+{
+  const size_t size = 1000;
+  const auto columns = [&](const size_t ii) {
+    return std::vector<size_t>({(ii + size - 1) % size, ii, (ii + 1) % size, (7 * ii) % size});
+  };
+  LA::SparsityPatternBuilder serial(size);
+  for (size_t ii = 0; ii < size; ++ii)
+    serial.count(ii, 4);
+  serial.allocate();
+  LA::ParallelSparsityPatternBuilder parallel(size);
+  for (size_t ii = 0; ii < size; ++ii) {
+    const auto row = columns(ii);
+    serial.insert(ii, row.begin(), row.end());
+  }
+  // each row is inserted from two different iterations
+  const auto insert_twice = [&](const size_t ii) {
+    const auto row = columns(ii);
+    parallel.insert(ii, row.begin(), row.end());
+    const auto mirrored_row = columns(size - 1 - ii);
+    for (const auto& jj : mirrored_row)
+      parallel.insert(size - 1 - ii, jj);
+  };
+#if HAVE_TBB
+  tbb::parallel_for(size_t(0), size, insert_twice);
+#else
+  for (size_t ii = 0; ii < size; ++ii)
+    insert_twice(ii);
+#endif
+  const auto expected = serial.finalize();
+  EXPECT_EQ(expected, parallel.finalize());
+  // finalize() empties the builder
+  EXPECT_EQ(LA::SparsityPatternCSR(size), parallel.finalize());
+}
@@ -0,0 +1,124 @@
+// This file is part of the dune-stuff project:
+//   https://github.com/wwu-numerik/dune-stuff
+// The copyright lies with the authors of this file (see below).
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+// Authors:
+//   Rene Milk       (2015)
+
+#include "main.hxx"
+
+#include <dune/stuff/la/container/operator-interface.hh>
+#include <dune/stuff/la/solver.hh>
+
+using namespace Dune::Stuff;
+using namespace Dune::Stuff::LA;
+
+//! the 1d finite difference laplacian with homogeneous dirichlet boundary values, applied without assembling it
+template <class VectorImp>
+class Laplace1d : public LinearOperatorInterface<VectorImp>
+{
+public:
+  typedef VectorImp VectorType;
+
+  explicit Laplace1d(const size_t size)
+    : size_(size)
+  {
+  }
+
+  virtual size_t rows() const override final
+  {
+    return size_;
+  }
+
+  virtual size_t cols() const override final
+  {
+    return size_;
+  }
+
+  virtual void apply(const VectorType& xx, VectorType& yy) const override final
+  {
+    for (size_t ii = 0; ii < size_; ++ii)
+      yy[ii] = 2. * xx[ii] - (ii > 0 ? xx[ii - 1] : 0.) - (ii + 1 < size_ ? xx[ii + 1] : 0.);
+  }
+
+private:
+  const size_t size_;
+}; // class Laplace1d
+
+template <class VectorImp>
+struct OperatorSolverTest : public ::testing::Test
+{
+  typedef VectorImp VectorType;
+  typedef Solver<LinearOperatorInterface<VectorType>> SolverType;
+
+  static void solves_stencil_system()
+  {
+    const size_t size = 50;
+    const Laplace1d<VectorType> laplace(size);
+    VectorType expected(size);
+    for (size_t ii = 0; ii < size; ++ii)
+      expected[ii] = double(ii % 7) - 3.;
+    VectorType rhs(size);
+    laplace.apply(expected, rhs);
+    const SolverType solver(laplace);
+    for (auto type : SolverType::types()) {
+      VectorType solution(size, 0.);
+      solver.apply(rhs, solution, type);
+      for (size_t ii = 0; ii < size; ++ii)
+        EXPECT_NEAR(expected[ii], solution[ii], 1e-6) << type;
+    }
+  }
+
+  static void throws_if_not_converged()
+  {
+    const size_t size = 50;
+    const Laplace1d<VectorType> laplace(size);
+    const VectorType rhs(size, 1.);
+    VectorType solution(size, 0.);
+    auto opts = SolverType::options("cg");
+    opts.set("max_iter", 2, true);
+    EXPECT_THROW(SolverType(laplace).apply(rhs, solution, opts), Exceptions::linear_solver_failed);
+  }
+}; // struct OperatorSolverTest
+
+// the matrix-free eigen solvers need Eigen >= 3.3
+#if HAVE_EIGEN
+#if EIGEN_VERSION_AT_LEAST(3, 3, 0)
+#define DUNE_STUFF_TEST_EIGEN_OPERATORS 1
+#endif
+#endif
+#ifndef DUNE_STUFF_TEST_EIGEN_OPERATORS
+#define DUNE_STUFF_TEST_EIGEN_OPERATORS 0
+#endif
+
+typedef testing::Types<
+#if DUNE_STUFF_TEST_EIGEN_OPERATORS
+    EigenDenseVector<double>
+#if HAVE_DUNE_ISTL
+    ,
+#endif
+#endif
+#if HAVE_DUNE_ISTL
+    IstlDenseVector<double>
+#endif
+    > OperatorVectorTypes;
+
+#if DUNE_STUFF_TEST_EIGEN_OPERATORS || HAVE_DUNE_ISTL
+
+TYPED_TEST_CASE(OperatorSolverTest, OperatorVectorTypes);
+TYPED_TEST(OperatorSolverTest, solves_stencil_system)
+{
+  this->solves_stencil_system();
+}
+TYPED_TEST(OperatorSolverTest, throws_if_not_converged)
+{
+  this->throws_if_not_converged();
+}
+
+#else // DUNE_STUFF_TEST_EIGEN_OPERATORS || HAVE_DUNE_ISTL
+
+TEST(DISABLED_OperatorSolverTest, solves_stencil_system)
+{
+}
+
+#endif // DUNE_STUFF_TEST_EIGEN_OPERATORS || HAVE_DUNE_ISTL